@@ -55,10 +55,15 @@
 #define MEM4_BUTTON             23
 #define MEM5_BUTTON             23
 
-#define send_midi_start() {}
-#define send_midi_stop()  {}
-#define send_midi_tick() {}
  
+// drum parts: sample numbers inside a drum kit, a kit is a group of DRUMKIT_SIZE consecutive samples
+#define KICK_NOTE               0
+#define SNARE_NOTE              1
+#define CLOSED_HAT_NOTE         2
+#define OPEN_HAT_NOTE           3
+#define PERCUSSION_NOTE         4
+#define CRASH_NOTE              5
+#define DRUMKIT_SIZE            12
 
 #define NUM_RAMPS 6           // simultaneous knob rotatings
 #ifndef NO_PSRAM
@@ -119,6 +124,19 @@ enum {
   NormalMidiVol = 70,
 };
 
+enum drum_kinds {
+  DrumBreak,
+  DrumStraight,
+  DrumHang,
+  DrumNone,
+  DrumAny,
+};
+
+enum { KickFourFloor, KickElectro, KickBigbeat, KickNone };
+enum { SnareBackbeat, SnareFill, SnareStraight, SnareBreak, SnareSkip, SnareNone };
+enum { HatsOffbeats, HatsClosed, HatsPop, HatsPat1, HatsNone };
+enum { PercFiller, PercXor1, PercXor2, PercEcho, PercRolls, PercNone };
+
 enum {
   NumMemories = 5,
   MaxNoteSet = 16,
@@ -156,6 +174,7 @@ struct Instrument {
 };
 
 static Instrument instruments[NumInstruments];
+static byte current_drumkit = 0; // number of the first sample of the selected kit
 
 static uint32_t bar_current = 0; // it counts bars
 
@@ -189,7 +208,6 @@ static byte cur_memory;
 static struct Button buttons[ButLast];
 static byte button_divider;
 static unsigned long now;
-static unsigned long last_midi_tick;
 
 static const byte button_pins[ButLast] = {
   GEN_SYNTH1_BUTTON_PIN,
@@ -203,12 +221,39 @@ static const byte button_pins[ButLast] = {
 };
 
 
+static void send_midi_start() {
+#ifdef MIDI_VIA_SERIAL  
+  MIDI.sendRealTime(MIDI_NAMESPACE::Start);
+#endif
+#ifdef MIDI_VIA_SERIAL2  
+  MidiOut.sendRealTime(0xFA);
+#endif
+}
+
+static void send_midi_stop() {
+#ifdef MIDI_VIA_SERIAL  
+  MIDI.sendRealTime(MIDI_NAMESPACE::Stop);
+#endif
+#ifdef MIDI_VIA_SERIAL2  
+  MidiOut.sendRealTime(0xFC);
+#endif
+}
+
+static void send_midi_tick() {
+#ifdef MIDI_VIA_SERIAL  
+  MIDI.sendRealTime(MIDI_NAMESPACE::Clock);
+#endif
+#ifdef MIDI_VIA_SERIAL2  
+  MidiOut.sendRealTime(0xF8);
+#endif
+}
+
 static void send_midi_noteon(byte chan, byte note, byte vol) {
 #ifdef MIDI_VIA_SERIAL  
   MIDI.sendNoteOn(note, vol, chan);
 #endif
 #ifdef MIDI_VIA_SERIAL2  
-  MIDI2.sendNoteOn(note, vol, chan);
+  MidiOut.sendNoteOn(chan, note, vol);
 #endif
   handleNoteOn( chan, note, vol) ;
 }
@@ -218,7 +263,7 @@ static void send_midi_noteoff(byte chan, byte note) {
   MIDI.sendNoteOn(note, 0, chan);
 #endif
 #ifdef MIDI_VIA_SERIAL2  
-  MIDI2.sendNoteOn(note, 0, chan);
+  MidiOut.sendNoteOff(chan, note);
 #endif
   handleNoteOff( chan, note, 0) ;
 }
@@ -349,7 +394,7 @@ static void instr_noteon(byte instr, byte value, byte do_glide, byte do_accent)
 #endif
   if (ins->is_drum) {
     // For drums: value is volume, accent and glide are ignored
-  //  instr_noteon_raw(instr, current_drumkit + ins->drum_note, value, 0);
+    instr_noteon_raw(instr, current_drumkit + ins->drum_note, value, 0);
   } else {
     // For non-drums: value is note, volume is accent, glide is used
     instr_noteon_raw(instr, value, do_accent ? AccentedMidiVol : NormalMidiVol, do_glide);
@@ -384,11 +429,12 @@ void sequencer_step(byte step) {
     //    instr_noteon_raw(NumInstruments-1, CRASH_NOTE, 127, 0);
     if (flip(30)) {
       //change drumkit
-//      current_drumkit = myRandom(((Drums.GetSamplesCount()-1)/12)) * 12 ;
-      
-//#ifdef DEBUG_JUKEBOX
-//      DEBF("Selected drumkit: %d\r\n" , current_drumkit);
-//#endif
+      // only the kits that the MIDI notes (0...127) can reach:
+      int num_samples = Drums.getNumSamples() < 128 ? Drums.getNumSamples() : 128;
+      current_drumkit = myRandom(num_samples / DRUMKIT_SIZE) * DRUMKIT_SIZE;
+#ifdef DEBUG_JUKEBOX
+      DEBF("Selected drumkit: %d\r\n" , current_drumkit);
+#endif
     }
 #ifdef DEBUG_JUKEBOX
     DEBUG("CRASH!!!!!!!!!!!!!!!!!!!!!");
@@ -492,10 +538,7 @@ static void generate_melody(uint8_t *note_set, byte note_set_len,
   }
 }
 
-/*
-static void generate_drums(byte *kick, byte *snare, byte *oh, byte *ch, byte *perc, byte *crash, drum_kinds drum_kind );
-
-static void generate_drums(byte *kick, byte *snare, byte *oh, byte *ch, byte *perc, byte *crash, drum_kinds drum_kind ) {
+static void generate_drums(byte *kick, byte *snare, byte *oh, byte *ch, byte *perc, byte *crash, byte drum_kind ) {
   memset(kick,  0, PatternLength); // zero patterns
   memset(snare, 0, PatternLength);
   memset(oh,    0, PatternLength);
@@ -725,7 +768,6 @@ static void generate_drums(byte *kick, byte *snare, byte *oh, byte *ch, byte *pe
     }
   }
 }
-*/
 
 /*
    Generator-to-pattern binding
@@ -761,9 +803,7 @@ void mem_generate_note_set(byte mem) {
   for (int i = 0; i < 2; i++)
     mem_generate_melody(mem, i);
 }
-/*
-void mem_generate_drums(byte mem, enum drum_kinds drum_kind);
-void mem_generate_drums(byte mem, enum drum_kinds drum_kind) {
+void mem_generate_drums(byte mem, byte drum_kind) {
   Memory *m = &memories[mem];
   generate_drums(
     m->patterns[2].notes,
@@ -774,10 +814,10 @@ void mem_generate_drums(byte mem, enum drum_kinds drum_kind) {
     m->patterns[7].notes,
     drum_kind);
 }
-*/
+
 void mem_generate_all(byte mem) {
   mem_generate_note_set(mem);
-  //mem_generate_drums(mem, DrumStraight);
+  mem_generate_drums(mem, DrumStraight);
   for (int i = 0; i < 2; i++)
     mem_generate_melody_and_seed(mem, i);
 }
@@ -814,18 +854,16 @@ void init_patterns() {
 }
 
 /*
-   MIDI clock
+   MIDI clock, the ticks come from the sample clock (SampleClock) which is advanced by the audio task
 */
 
-#define MIDI_TICKS_PER_16TH 1
+#define MIDI_TICKS_PER_16TH 6 // 24 ppqn
 
 static byte midi_playing, midi_tick, midi_step;
-const float tick_coef = 1000ul * 15 / MIDI_TICKS_PER_16TH;
-static unsigned long midi_tick_ms = tick_coef / bpm;
 
 inline void set_bpm(float newBpm) {
   bpm = newBpm;
-  midi_tick_ms = tick_coef / newBpm;
+  SampleClock.setTempo(newBpm);
 }
 
 static void decide_on_break() {
@@ -895,12 +933,12 @@ static void decide_on_break() {
         Break.after = Break.start + Break.length;
       }
     }
-//    if (Break.start == bar_current ) mem_generate_drums(cur_memory, DrumBreak);
+    if (Break.start == bar_current ) mem_generate_drums(cur_memory, DrumBreak);
   } else { // Break.status != sIdle
     if (Break.after == bar_current) {
       Break.status = sIdle;
-//      mem_generate_drums(cur_memory, DrumStraight);
-  //    if (flip(10)) mem_generate_drums(cur_memory, DrumHang);
+      mem_generate_drums(cur_memory, DrumStraight);
+      if (flip(10)) mem_generate_drums(cur_memory, DrumHang);
       if (flip(80)) mem_generate_melody_and_seed(cur_memory, 0);
       if (flip(60)) mem_generate_melody_and_seed(cur_memory, 1);
       if (flip(15)) mem_generate_note_set(cur_memory);
@@ -912,6 +950,7 @@ static void decide_on_break() {
 }
 
 static void do_midi_start() {
+  SampleClock.start(); // the first tick is due right away
   midi_playing = 1;
   midi_tick = MIDI_TICKS_PER_16TH - 1;
   midi_step = -1;
@@ -1018,6 +1057,7 @@ static void do_midi_tick() {
 static void do_midi_stop() {
   instr_allnotesoff();
   send_midi_stop();
+  SampleClock.stop();
   midi_playing = 0;
 }
 
@@ -1025,7 +1065,7 @@ static void do_midi_stop() {
    Instrument definition
 */
 
-// static const byte drum_notes[6] = { KICK_NOTE, SNARE_NOTE, CLOSED_HAT_NOTE, OPEN_HAT_NOTE, PERCUSSION_NOTE, CRASH_NOTE };
+static const byte drum_notes[6] = { KICK_NOTE, SNARE_NOTE, CLOSED_HAT_NOTE, OPEN_HAT_NOTE, PERCUSSION_NOTE, CRASH_NOTE };
 static const byte synth_midi_channels[1] = { SYNTH1_MIDI_CHAN};
 
 static void init_instruments() {
@@ -1039,6 +1079,16 @@ static void init_instruments() {
     ins->noteoff = send_midi_noteoff;
     ins++;
   }
+
+  // Make drum instruments
+  for (int i = 0; i < 6; i++) {
+    ins->midi_channel = DRUM_MIDI_CHAN;
+    ins->is_drum = 1;
+    ins->drum_note = drum_notes[i];
+    ins->noteon = send_midi_noteon;
+    ins->noteoff = NULL;
+    ins++;
+  }
 }
 
 /*
@@ -1090,7 +1140,7 @@ void run_ui() {
     print_memory(cur_memory);
   }
   if (just_pressed(ButDrums)) {
-//    mem_generate_drums(cur_memory, DrumStraight);
+    mem_generate_drums(cur_memory, DrumStraight);
     print_memory(cur_memory);
   }
 
@@ -1103,11 +1153,9 @@ void run_ui() {
       do_midi_stop();
     } else {
 #ifdef DEBUG_JUKEBOX
-      DEBF("starting midi clock, dt=%lu", midi_tick_ms);
+      DEBF("starting midi clock, bpm=%f\r\n", bpm);
 #endif
-      last_midi_tick = now;
       do_midi_start();
-      do_midi_tick();
     }
   }
 }
@@ -1125,14 +1173,10 @@ void run_tick() {
     
   }
 
-  /* If MIDI is playing, then check for tick */
-  if (midi_playing && (now - last_midi_tick) >= midi_tick_ms) {
+  /* If MIDI is playing, run all ticks that the sample clock has passed - they don't drift, but
+     they take effect now, up to one loop() period after they were due */
+  while (midi_playing && SampleClock.pollTick()) {
     do_midi_tick();
-    last_midi_tick += midi_tick_ms;
-    if (last_midi_tick < now) {
-      /* we are at least one tick late, give up */
-      last_midi_tick = now;
-    }
   }
 }
 
@@ -8,10 +8,38 @@ rosic namespace to facilitate their global use. */
 
 #ifdef _MSC_VER
 #define INLINE __forceinline
+#elif defined(ARDUINO_ARCH_ESP32)
+#define INLINE inline __attribute__((always_inline)) // -Os would leave out-of-line copies in flash
 #else
 #define INLINE inline  // something better to do here ?
 #endif
 
+//-------------------------------------------------------------------------------------------------
+// memory placement:
+
+// On the ESP32, static data lives in internal DRAM, but constant tables are left in flash where 
+// they are read through the cache that they share with the code, and heap buffers go to internal 
+// RAM or PSRAM depending on their size. HOT_DATA pins tables that are read per sample into DRAM, 
+// large buffers that are only touched when something is (re)computed are taken from PSRAM by 
+// bulkMalloc (see GlobalFunctions.h). With NO_PSRAM (no PSRAM on the board, or its pins are in use)
+// everything stays internal and the wavetables are rendered in place to save their scratch buffers.
+//
+// Code is executed from flash through the same cache, so a cache miss stalls the audio task for as 
+// long as the flash read takes. HOT_CODE puts the functions of the render path (everything that
+// runs per block, including the handling of sequencer events) into IRAM. The INLINE functions are
+// forced inline on the ESP32 such that they end up in their callers. What the render path still 
+// calls in flash (libm, the I2S driver) is listed by host/iram_report.sh, the stalls can be 
+// measured with PROFILE_STALLS (see Open303.ino).
+#if defined(ARDUINO_ARCH_ESP32)
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#define HOT_DATA DRAM_ATTR
+#define HOT_CODE IRAM_ATTR
+#else
+#define HOT_DATA
+#define HOT_CODE
+#endif
+
 const float MIDI_NORM = 1.0f/127.0f;
 const float MIDI_NORM_100 = 100.0f/127.0f;
 
@@ -30,11 +58,17 @@ const float MIDI_NORM_100 = 100.0f/127.0f;
 #define CC_303_DECAY        72
 #define CC_303_ENVMOD_LVL   75
 #define CC_303_ACCENT_LVL   76
+#define CC_303_INPUT_LVL    77    // level of the external audio input (AUDIO_INPUT), 0 = off
+#define CC_303_USER_WAVE    78    // replaces the saw by waveform value-1 of the wave bank (WAVES_PARTITION), 0 = saw
 #define CC_303_REVERB_SEND  91
 #define CC_303_DELAY_SEND   92
 #define CC_303_DISTORTION   94
 #define CC_303_OVERDRIVE    95
 #define CC_303_SATURATOR    128
+#define CC_303_WIDTH        89    // stereo width of the voice on the channel (synth or drums)
+#define CC_303_MORPH        1     // mod wheel: morph from the current program (0) to the morph target (127)
+#define CC_303_MORPH_TARGET 16    // value = program number of the morph target
+#define CC_303_STORE_PRESET 17    // value = program number to store the current sound to
 
 #define CC_ANY_COMPRESSOR   93
 #define CC_ANY_DELAY_TIME   84
@@ -42,6 +76,7 @@ const float MIDI_NORM_100 = 100.0f/127.0f;
 #define CC_ANY_DELAY_LVL    86
 #define CC_ANY_REVERB_TIME  87
 #define CC_ANY_REVERB_LVL   88
+#define CC_ANY_RECORD       119   // >= 64 starts a recording to the SD card (RECORDER), < 64 stops it
 #define CC_ANY_RESET_CCS    121
 #define CC_ANY_NOTES_OFF    123
 #define CC_ANY_SOUND_OFF    120
@@ -57,6 +92,8 @@ const float MIDI_NORM_100 = 100.0f/127.0f;
 
 const float DIV_SAMPLE_RATE   = 1.0f / (float)SAMPLE_RATE;
 const float TWO_DIV_16383     = 2.0f / 16383.0f ;
+const float DB_PER_OCTAVE     = 6.0205999132796239f;  // 20*log10(2), converts log2-amplitudes into dB
+const float OCTAVES_PER_DB    = 0.1660964047443681f;  // reciprocal of the above
 //_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON)
 
 //-------------------------------------------------------------------------------------------------
@@ -77,18 +114,39 @@ const float TWO_DIV_16383     = 2.0f / 16383.0f ;
 #define PI_DIV_180 0.01745329251994329576923690768489f
 #define ONE_EIGHTY_DIV_PI 57.295779513082320876798154814105f
 
-static const float sin_tbl[TABLE_SIZE+1] = {
+static const float sin_tbl[TABLE_SIZE+1] HOT_DATA = {
   0.000000000f, 0.195090322f, 0.382683432f, 0.555570233f, 0.707106781f, 0.831469612f, 0.923879533f, 0.980785280f,
   1.000000000f, 0.980785280f, 0.923879533f, 0.831469612f, 0.707106781f, 0.555570233f, 0.382683432f, 0.195090322f, 
   0.000000000f, -0.195090322f, -0.382683432f, -0.555570233f, -0.707106781f, -0.831469612f, -0.923879533f, -0.980785280f, 
   -1.000000000f, -0.980785280f, -0.923879533f, -0.831469612f, -0.707106781f, -0.555570233f, -0.382683432f, -0.195090322f, 0.000000000f };
 
-static const float shaper_tbl[TABLE_SIZE+1] {
+static const float shaper_tbl[TABLE_SIZE+1] HOT_DATA = {
   0.000000000f, 0.154990730f, 0.302709729f, 0.437188785f, 0.554599722f, 0.653423588f, 0.734071520f, 0.798242755f, 
   0.848283640f, 0.886695149f, 0.915824544f, 0.937712339f, 0.954045260f, 0.966170173f, 0.975136698f, 0.981748725f, 
   0.986614298f, 0.990189189f, 0.992812795f, 0.994736652f, 0.996146531f, 0.997179283f, 0.997935538f, 0.998489189f, 
   0.998894443f, 0.999191037f, 0.999408086f, 0.999566912f, 0.999683128f, 0.999768161f, 0.999830378f, 0.999875899f , 0.999909204f };
 
+static const float log2_tbl[TABLE_SIZE+1] HOT_DATA = { // log2(x) for 1 <= x <= 2, mantissa lookup for fast_log2()
+  0.000000000f, 0.044394119f, 0.087462841f, 0.129283017f, 0.169925001f, 0.209453366f, 0.247927513f, 0.285402219f,
+  0.321928095f, 0.357552005f, 0.392317423f, 0.426264755f, 0.459431619f, 0.491853096f, 0.523561956f, 0.554588852f,
+  0.584962501f, 0.614709844f, 0.643856190f, 0.672425342f, 0.700439718f, 0.727920455f, 0.754887502f, 0.781359714f,
+  0.807354922f, 0.832890014f, 0.857980995f, 0.882643049f, 0.906890596f, 0.930737338f, 0.954196310f, 0.977279923f,
+  1.000000000f };
+
+static const float exp2_tbl[TABLE_SIZE+1] HOT_DATA = { // 2^x for 0 <= x <= 1, fractional part lookup for fast_exp2()
+  1.000000000f, 1.021897149f, 1.044273782f, 1.067140401f, 1.090507733f, 1.114386743f, 1.138788635f, 1.163724859f,
+  1.189207115f, 1.215247360f, 1.241857812f, 1.269050957f, 1.296839555f, 1.325236643f, 1.354255547f, 1.383909882f,
+  1.414213562f, 1.445180807f, 1.476826146f, 1.509164428f, 1.542210825f, 1.575980845f, 1.610490332f, 1.645755478f,
+  1.681792831f, 1.718619298f, 1.756252160f, 1.794709075f, 1.834008086f, 1.874167634f, 1.915206561f, 1.957144124f,
+  2.000000000f };
+
+static const float pan_tbl[TABLE_SIZE+1] HOT_DATA = { // sqrt(2)*cos(x*pi/2) for 0 <= x <= 1, equal-power pan law with unity gain at the center
+  1.414213562f, 1.412510080f, 1.407403738f, 1.398906836f, 1.387039845f, 1.371831354f, 1.353318001f, 1.331544387f,
+  1.306562965f, 1.278433919f, 1.247225013f, 1.213011433f, 1.175875602f, 1.135906984f, 1.093201867f, 1.047863131f,
+  1.000000000f, 0.949727782f, 0.897167586f, 0.842446036f, 0.785694958f, 0.727051073f, 0.666655658f, 0.604654212f,
+  0.541196100f, 0.476434200f, 0.410524528f, 0.343625866f, 0.275899379f, 0.207508227f, 0.138617169f, 0.069392171f,
+  0.000000000f };
+
 //-------------------------------------------------------------------------------------------------
 // type definitions:
 
@@ -29,6 +29,14 @@ INLINE int arrayMinIndex(T* theArray, int numValues);
 minute (bpm). */
 INLINE float beatsToSeconds(float beat, float bpm);
 
+/** Allocates memory for a large buffer that is rarely touched by the audio code (render scratch 
+and the like). It is taken from PSRAM when there is one (unless NO_PSRAM is defined) and from the 
+internal heap otherwise. Returns NULL when there is no memory left. */
+INLINE void* bulkMalloc(size_t size);
+
+/** Frees a buffer that was allocated with bulkMalloc. */
+INLINE void bulkFree(void *buffer);
+
 /** Converts a value in decibels to a raw amplitude value/factor. */
 INLINE float dB2amp(float x);
 
@@ -204,6 +212,21 @@ INLINE float beatsToSeconds(float beat, float bpm)
   return (60.0/bpm)*beat;
 }
 
+INLINE void* bulkMalloc(size_t size)
+{
+#if defined(ARDUINO_ARCH_ESP32) && !defined(NO_PSRAM)
+  void *buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if( buffer != NULL )
+    return buffer;
+#endif
+  return malloc(size);
+}
+
+INLINE void bulkFree(void *buffer)
+{
+  free(buffer); // works for both heaps
+}
+
 INLINE float dB2amp(float dB)
 {
   return exp((float)dB * 0.11512925464970228420089957273422f);
@@ -8,13 +8,19 @@
 
 
 #define SYNTH1_MIDI_CHAN        1
+#define DRUM_MIDI_CHAN          10
+//#define MIDI_CLOCK_SYNC                // Open303's pattern sequencer follows the incoming MIDI clock (start/stop/clock), notes on SYNTH1_MIDI_CHAN transpose it
+#define DRUM_SAMPLES_PARTITION  "drums" // label of the data partition with the drum sample bank, see partitions.csv and rosic_SampleBank.h
+//#define WAVES_PARTITION       "waves" // label of the data partition with user waveforms for CC_303_USER_WAVE, see partitions.csv and rosic_WaveBank.h
 #define DEBUG_ON
+//#define PROFILE_STALLS                 // count the cache stall cycles of the audio render per buffer and report them every 2 seconds (needs DEBUG_ON)
 //#define MIDI_VIA_SERIAL
 #define MIDI_VIA_SERIAL2
 #define MIDIRX_PIN      4       // this pin is used for input when MIDI_VIA_SERIAL2 defined (note that default pin 17 won't work with PSRAM)
-#define MIDITX_PIN      0      // this pin will be used for output (not implemented yet) when MIDI_VIA_SERIAL2 defined
+#define MIDITX_PIN      0      // this pin is used for output when MIDI_VIA_SERIAL2 defined
+//#define MIDI_THRU             // forward the MIDI_VIA_SERIAL2 input to its output (SysEx is not forwarded)
 
-//#define NO_PSRAM
+//#define NO_PSRAM              // no PSRAM on the board (or pins 16/17 needed): bulk buffers go to internal RAM, wavetables render in place
 //#define USE_INTERNAL_DAC
 
 #define SAMPLE_RATE     44100   // 44100 seems to be the right value, 48000 is also OK. Other values are not tested.
@@ -25,6 +31,14 @@
 #define I2S_BCLK_PIN    5
 #define I2S_DOUT_PIN    6
 #define I2S_WCLK_PIN    7
+//#define AUDIO_INPUT           // full duplex I2S: an ADC on I2S_DIN_PIN (same clocks) is fed through the synth's filter, like the Devil Fish external input
+#define I2S_DIN_PIN     15      // this pin is used for input when AUDIO_INPUT defined
+
+//#define RECORDER              // record the master output as WAV files to an SD card (SPI), started and stopped by CC_ANY_RECORD, see recorder.ino
+#define SD_CS_PIN       10      // SD card pins when RECORDER defined
+#define SD_SCK_PIN      12
+#define SD_MISO_PIN     13
+#define SD_MOSI_PIN     11
 
 
 #ifndef MIDI_VIA_SERIAL
@@ -52,7 +66,7 @@
       #define DEBUG(...)
 #endif
 
-#if defined MIDI_VIA_SERIAL2 || defined MIDI_VIA_SERIAL
+#ifdef MIDI_VIA_SERIAL
 #include <MIDI.h>
 #endif
 
@@ -65,20 +79,26 @@ MIDI_NAMESPACE::SerialMIDI<HardwareSerial, CustomBaudRateSettings> serialMIDI(Se
 MIDI_NAMESPACE::MidiInterface<MIDI_NAMESPACE::SerialMIDI<HardwareSerial, CustomBaudRateSettings>> MIDI((MIDI_NAMESPACE::SerialMIDI<HardwareSerial, CustomBaudRateSettings>&)serialMIDI);
 #endif
 
-#ifdef MIDI_VIA_SERIAL2
-// MIDI port on UART2,   pins 16 (RX) and 17 (TX) prohibited, as they are used for PSRAM
-struct Serial2MIDISettings : public midi::DefaultSettings {
-  static const long BaudRate = 31250;
-  static const int8_t RxPin  = MIDIRX_PIN;
-  static const int8_t TxPin  = MIDITX_PIN;
-};
-MIDI_NAMESPACE::SerialMIDI<HardwareSerial> Serial2MIDI2(Serial2);
-MIDI_NAMESPACE::MidiInterface<MIDI_NAMESPACE::SerialMIDI<HardwareSerial, Serial2MIDISettings>> MIDI2((MIDI_NAMESPACE::SerialMIDI<HardwareSerial, Serial2MIDISettings>&)Serial2MIDI2);
-#endif
+// MIDI port on UART2 (MIDI_VIA_SERIAL2), pins 16 (RX) and 17 (TX) prohibited, as they are used for PSRAM:
+// the input is parsed as the bytes arrive, the output is queued, see midi_handler.ino
 
 
 #include "driver/i2s.h"
+#include <Preferences.h>
 #include "rosic_Open303.h"
+#include "rosic_Compressor.h"
+#include "rosic_WaveShaper.h"
+#include "rosic_DrumSampler.h"
+#include "rosic_DrumSynth.h"
+#include "rosic_ClockTracker.h"
+#include "rosic_Transport.h"
+#include "rosic_MidiParser.h"
+#include "rosic_MidiOutput.h"
+#include "rosic_StereoPanner.h"
+#include "rosic_PresetBank.h"
+#include "rosic_PresetMorpher.h"
+#include "rosic_AudioRecorder.h"
+#include "rosic_WaveBank.h"
 
 
 // tasks for Core0 and Core1
@@ -89,17 +109,38 @@ float bpm = 130.0f;
 
 rosic::Open303 Synth;
 rosic::AcidSequencer Sequencer;
+rosic::WaveShaper Overdrive, Distortion; // anti-aliased post-voice shapers
+rosic::StereoPanner SynthPan, DrumPan; // place the synth and the drums in the stereo mix
+rosic::Compressor Comp; // master bus look-ahead compressor/limiter
+rosic::SampleBank DrumBank; // drum samples, mapped from flash
+#ifdef WAVES_PARTITION
+rosic::WaveBank Waves; // precomputed mip-maps of user waveforms, mapped from flash
+#endif
+rosic::DrumSampler Drums;
+rosic::DrumSynth SynthDrums; // sample-free drums, used when there is no sample bank
+rosic::ClockTracker MidiClock; // tempo and phase of the incoming MIDI clock
+rosic::Transport SampleClock; // sample counter advanced by the audio task, the master clock of the jukebox and the MIDI clock output
+rosic::PresetBank Presets; // 128 programs for the synth, stored in the NVS
+rosic::PresetMorpher Morph; // applies program changes and the morph between two programs from the audio task
+rosic::MidiOutput MidiOut; // queue of the MIDI_VIA_SERIAL2 output, sending never waits for the UART
+#ifdef RECORDER
+rosic::AudioRecorder Recorder; // ring buffer between the audio task and the SD card writer
+#endif
 
-size_t bytes_written; // i2s
+size_t bytes_written, bytes_read; // i2s
 volatile uint32_t s1t, s2t, drt, fxt, s1T, s2T, drT, fxT, art, arT; // debug timing: if we use less vars, compiler optimizes them
 
-// Audio buffers of all kinds
-static float mix_buf_l[DMA_BUF_LEN];    // mix L channel
-static float mix_buf_r[DMA_BUF_LEN];    // mix R channel
+// Audio buffers of all kinds, touched every sample, so they are pinned to internal DRAM
+static float synth_buf[DMA_BUF_LEN] HOT_DATA;    // synth voice (mono)
+static float drum_buf[DMA_BUF_LEN] HOT_DATA;     // drums (mono)
+static float mix_buf[DMA_BUF_LEN * 2] HOT_DATA;  // stereo mix, interleaved L+R like the i2s frames
 static union { // a dirty trick, instead of true converting
   int16_t _signed[DMA_BUF_LEN * 2];
   uint16_t _unsigned[DMA_BUF_LEN * 2];
-} out_buf; // i2s L+R output buffer
+} out_buf HOT_DATA; // i2s L+R output buffer
+#ifdef AUDIO_INPUT
+static int16_t in_buf[DMA_BUF_LEN * 2] HOT_DATA; // i2s L+R input frames, read by the synth in place
+#endif
 /*
 hw_timer_t * timer1 = NULL;            // Timer variables
 portMUX_TYPE timer1Mux = portMUX_INITIALIZER_UNLOCKED; 
@@ -140,10 +181,48 @@ void setup() {
   MidiInit();
   DEBUG("MIDI Started");
 
+  SampleClock.setTempo(bpm);
+
+  Overdrive.setMode(rosic::WaveShaper::TANH);
+  Overdrive.setBypass(true);
+  Distortion.setMode(rosic::WaveShaper::HARDCLIP);
+  Distortion.setBypass(true);
+
+#ifdef AUDIO_INPUT
+  Synth.setInputLevel(0.0f); // CC_303_INPUT_LVL
+#endif
+
+#ifdef MIDI_CLOCK_SYNC
+  Synth.sequencer.setMode(rosic::AcidSequencer::HOST_SYNC);
+#endif
+
+  if (DrumBank.open(DRUM_SAMPLES_PARTITION)) {
+    Drums.setSampleBank(&DrumBank);
+    DEBF("Drum samples: %d\r\n", DrumBank.getNumSamples());
+  } else {
+    DEBUG("No drum samples found, using synthesized drums");
+  }
+
+#ifdef WAVES_PARTITION
+  if (Waves.open(WAVES_PARTITION)) {
+    DEBF("User waveforms: %d\r\n", Waves.getNumWaves());
+  } else {
+    DEBUG("No user waveforms found");
+  }
+#endif
+
 #ifdef JUKEBOX
   init_midi(); // AcidBanger function
 #endif
 
+  presetsInit();
+
+#ifdef RECORDER
+  recorderInit();
+#endif
+
+  memoryMapReport();
+
 	// xTaskCreatePinnedToCore( audio_task1, "SynthTask1", 8000, NULL, (1 | portPRIVILEGE_BIT), &SynthTask1, 0 );
 	// xTaskCreatePinnedToCore( audio_task2, "SynthTask2", 8000, NULL, (1 | portPRIVILEGE_BIT), &SynthTask2, 1 );
   xTaskCreatePinnedToCore( audio_task1, "SynthTask1", 8000, NULL, 1, &SynthTask1, 0 );
@@ -171,9 +250,7 @@ void loop() {
 
   taskYIELD(); // this can wait
 
-#ifdef MIDI_VIA_SERIAL2
-  MIDI2.read();
-#endif
+  // MIDI_VIA_SERIAL2 input is parsed in the UART event task and handled by the audio task, see midiUartReceive()
 /*
   if(timer1_fired) {
     timer1_fired = false;
@@ -191,22 +268,74 @@ void loop() {
   myRandomAddEntropy((uint16_t)(micros() & 0x0000FFFF));
 #endif
 
+#ifdef MIDI_VIA_SERIAL2
+  midiOutService();
+#endif
+
+  presetsService();
+
+#ifdef WAVES_PARTITION
+  userWaveService();
+#endif
+
+#ifdef PROFILE_STALLS
+  stallProfileReport();
+#endif
+
 }
 
 
-// Core0 task
-static void audio_task1(void *userData) {
+// current time in samples, the timestamps of the incoming MIDI clock are taken from here
+inline double sample_time_now() {
+  return (double)SampleClock.getSampleTime();
+}
+
+// Core0 task, the whole render path is in IRAM (see HOT_CODE in GlobalDefinitions.h)
+static void HOT_CODE audio_task1(void *userData) {
   DEBUG ("TASK 1 Started");
   while (true) {
     if (ulTaskNotifyTake(pdTRUE, portMAX_DELAY)) {
+#ifdef AUDIO_INPUT
+      i2s_input(); // the frames that came in while the last buffer went out, so the input is one buffer late
+#endif
       s1t = micros();
-      for (int i = 0 ; i < DMA_BUF_LEN; i++) {
-        mix_buf_l[i] = mix_buf_r[i] = Synth.getSample();   
-      }
+#ifdef PROFILE_STALLS
+      stallProfileStart();
+#endif
+#ifdef MIDI_VIA_SERIAL2
+      midiInService(); // the MIDI input that arrived during the last block
+#endif
+#ifdef MIDI_CLOCK_SYNC
+      double ticks_per_sample;
+      double tick_position = MidiClock.getTickPosition(sample_time_now(), ticks_per_sample); // one consistent estimate
+      Synth.sequencer.setHostClock(tick_position, ticks_per_sample);
+#endif
+      Morph.update(); // a bounded number of parameter changes per block
+#ifdef AUDIO_INPUT
+      Synth.processBlock(synth_buf, DMA_BUF_LEN, in_buf);
+#else
+      Synth.processBlock(synth_buf, DMA_BUF_LEN);
+#endif
+      Overdrive.processBlock(synth_buf, DMA_BUF_LEN);
+      Distortion.processBlock(synth_buf, DMA_BUF_LEN);
+      memset(drum_buf, 0, sizeof(drum_buf));
+      Drums.processBlock(drum_buf, DMA_BUF_LEN);
+      SynthDrums.processBlock(drum_buf, DMA_BUF_LEN);
+      memset(mix_buf, 0, sizeof(mix_buf));
+      SynthPan.processBlock(synth_buf, mix_buf, DMA_BUF_LEN);
+      DrumPan.processBlock(drum_buf, mix_buf, DMA_BUF_LEN);
+      Comp.processBlock(mix_buf, out_buf._signed); // writes the i2s frames
+#ifdef RECORDER
+      Recorder.write(out_buf._signed, DMA_BUF_LEN); // a copy into the ring buffer, never waits
+#endif
+#ifdef PROFILE_STALLS
+      stallProfileStop();
+#endif
       s1T = micros() - s1t;
     }
  // DEBF("time=%dus , sample=%e\r\n" , s1T, mix_buf_l[0]);
     i2s_output();
+    SampleClock.advance(DMA_BUF_LEN);
     
     taskYIELD();
     
@@ -1,7 +1,11 @@
 
 void i2sInit() {
   i2s_config_t i2s_config = {
+#ifdef AUDIO_INPUT
+    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_RX ), // RX runs on the same clocks and DMA buffer size
+#else
     .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX ),
+#endif
     .sample_rate = SAMPLE_RATE,
     .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
     .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
@@ -15,7 +19,12 @@ void i2sInit() {
   i2s_pin_config_t i2s_pin_config = {
     .bck_io_num = I2S_BCLK_PIN,
     .ws_io_num =  I2S_WCLK_PIN,
-    .data_out_num = I2S_DOUT_PIN
+    .data_out_num = I2S_DOUT_PIN,
+#ifdef AUDIO_INPUT
+    .data_in_num = I2S_DIN_PIN
+#else
+    .data_in_num = I2S_PIN_NO_CHANGE
+#endif
   };
 
   i2s_driver_install(i2s_num, &i2s_config, 0, NULL);
@@ -31,15 +40,17 @@ void i2sDeinit() {
 }
 
 
-inline void i2s_output () {
-  // now out_buf is ready, output
+#ifdef AUDIO_INPUT
+void HOT_CODE i2s_input () {
+  // one DMA buffer of input frames, straight into in_buf which the synth reads as it is - this waits 
+  // for the buffer that was recorded while the last output buffer was played
+  i2s_read(i2s_num, in_buf, sizeof(in_buf), &bytes_read, portMAX_DELAY);
+}
+#endif
+
 
-    for (int i=0; i < DMA_BUF_LEN; i++) {      
-    //  out_buf._signed[i*2] = 0x7fff * (float)(fast_tanh( mix_buf_l[i])) ; 
-    //  out_buf._signed[i*2+1] = 0x7fff * (float)(fast_tanh( mix_buf_r[i])) ;
-      out_buf._signed[i*2] = 0x7fff * (float)(( mix_buf_l[i])) ; 
-      out_buf._signed[i*2+1] = 0x7fff * (float)(( mix_buf_r[i])) ;
-    }
+void HOT_CODE i2s_output () {
+  // now out_buf is ready (the compressor writes it in the i2s frame format), output
     i2s_write(i2s_num, out_buf._signed, sizeof(out_buf._signed), &bytes_written, portMAX_DELAY);
 
   xTaskNotifyGive(SynthTask1);
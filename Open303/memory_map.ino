@@ -0,0 +1,60 @@
+// Boot-time memory map: reports where the audio objects, buffers and tables ended up and how much
+// of each heap is left. Per-sample state and hot tables should all say DRAM - the bulk buffers 
+// (wavetable prototypes, FFT scratch) don't appear by address, they show up as used PSRAM.
+// See HOT_DATA in GlobalDefinitions.h and bulkMalloc in GlobalFunctions.h.
+
+#include "soc/soc.h"
+
+struct sMemoryBlock {
+  const char *name;
+  const void *address;
+  size_t size;
+};
+
+static const char* memory_region(const void *address) {
+  uintptr_t a = (uintptr_t)address;
+  if (a >= SOC_EXTRAM_DATA_LOW && a < SOC_EXTRAM_DATA_HIGH) return "PSRAM";
+  if (a >= SOC_DRAM_LOW && a < SOC_DRAM_HIGH) return "DRAM";
+  if (a >= SOC_DROM_LOW && a < SOC_DROM_HIGH) return "flash";
+  return "?";
+}
+
+void memoryMapReport() {
+  const sMemoryBlock blocks[] = {
+    {"Synth",       &Synth,       sizeof(Synth)},
+    {"Sequencer",   &Sequencer,   sizeof(Sequencer)},
+    {"Drums",       &Drums,       sizeof(Drums)},
+    {"SynthDrums",  &SynthDrums,  sizeof(SynthDrums)},
+    {"Comp",        &Comp,        sizeof(Comp)},
+    {"Overdrive",   &Overdrive,   sizeof(Overdrive)},
+    {"Distortion",  &Distortion,  sizeof(Distortion)},
+    {"SynthPan",    &SynthPan,    sizeof(SynthPan)},
+    {"DrumPan",     &DrumPan,     sizeof(DrumPan)},
+#ifdef RECORDER
+    {"Recorder",    &Recorder,    sizeof(Recorder)},
+#endif
+    {"synth_buf",   synth_buf,    sizeof(synth_buf)},
+    {"drum_buf",    drum_buf,     sizeof(drum_buf)},
+    {"mix_buf",     mix_buf,      sizeof(mix_buf)},
+    {"out_buf",     &out_buf,     sizeof(out_buf)},
+#ifdef AUDIO_INPUT
+    {"in_buf",      in_buf,       sizeof(in_buf)},
+#endif
+    {"sin_tbl",     sin_tbl,      sizeof(sin_tbl)},
+    {"exp2_tbl",    exp2_tbl,     sizeof(exp2_tbl)},
+  };
+  DEBUG("Memory map:");
+  for (int i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++) {
+    DEBF("  %-12s %6u bytes @ %p %s\r\n", blocks[i].name, (unsigned)blocks[i].size, blocks[i].address, memory_region(blocks[i].address));
+  }
+  DEBF("  internal heap: %u bytes free, largest block %u\r\n", (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL), (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+#ifdef NO_PSRAM
+  DEBUG("  PSRAM: not used (NO_PSRAM), wavetables are rendered in place");
+#else
+  if (psramFound()) {
+    DEBF("  PSRAM: %u of %u bytes used\r\n", (unsigned)(ESP.getPsramSize() - ESP.getFreePsram()), (unsigned)ESP.getPsramSize());
+  } else {
+    DEBUG("  PSRAM: not found, bulk buffers are in the internal heap");
+  }
+#endif
+}
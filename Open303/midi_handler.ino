@@ -1,5 +1,55 @@
 
 
+#ifdef MIDI_VIA_SERIAL2
+#include "soc/soc_caps.h"
+
+#define MIDI_TX_AHEAD   4   // bytes kept in the UART TX FIFO (0.32 ms each), a realtime byte never waits for more
+
+rosic::MidiParser MidiIn;
+rosic::MidiMessageQueue MidiInQueue; // from the UART event task to the audio task
+
+// runs in the UART event task as soon as bytes have arrived (the RX FIFO threshold is one byte), so
+// the messages are parsed and stamped independent of what loop() is doing - they are handled by
+// the audio task, see midiInService()
+static void midiUartReceive() {
+  double now = sample_time_now();
+  rosic::MidiMessage message;
+  while (Serial2.available() > 0) {
+    if (MidiIn.parse((uint8_t)Serial2.read(), now, message)) {
+#ifdef MIDI_THRU
+      MidiOut.send(message.status, message.data1, message.data2, rosic::MidiOutput::THRU); // SysEx is refused
+#endif
+      if (message.status != 0xF0) { // SysEx isn't handled
+        MidiInQueue.write(message);
+      }
+    }
+  }
+}
+
+// called by the audio task before it renders a block: the messages that arrived while the
+// previous block was rendered and sent take effect now, between two blocks of the voices, so a
+// note on is late by at most one audio buffer and never lands in the middle of a block kernel
+void HOT_CODE midiInService() {
+  rosic::MidiMessage message;
+  while (MidiInQueue.read(message)) {
+    handleMidiMessage(message);
+  }
+}
+
+// feeds the UART from the output queue, never waits: Serial2 has no TX ring buffer, so
+// availableForWrite() is the free space in the hardware FIFO, which is topped up to MIDI_TX_AHEAD bytes
+void midiOutService() {
+  uint8_t bytes[MIDI_TX_AHEAD];
+  int room = MIDI_TX_AHEAD - (SOC_UART_FIFO_LEN - Serial2.availableForWrite());
+  if (room > 0) {
+    int n = MidiOut.read(bytes, room);
+    if (n > 0) {
+      Serial2.write(bytes, n);
+    }
+  }
+}
+#endif
+
 inline void MidiInit() {
   
 #ifdef MIDI_VIA_SERIAL
@@ -17,15 +67,15 @@ inline void MidiInit() {
   MIDI.setHandleControlChange(handleCC);
   MIDI.setHandlePitchBend(handlePitchBend);
   MIDI.setHandleProgramChange(handleProgramChange);
+  MIDI.setHandleClock(handleClock);
+  MIDI.setHandleStart(handleStart);
+  MIDI.setHandleContinue(handleContinue);
+  MIDI.setHandleStop(handleStop);
   MIDI.begin(MIDI_CHANNEL_OMNI);
 #endif
 #ifdef MIDI_VIA_SERIAL2
-  MIDI2.setHandleNoteOn(handleNoteOn);
-  MIDI2.setHandleNoteOff(handleNoteOff);
-  MIDI2.setHandleControlChange(handleCC);
-  MIDI2.setHandlePitchBend(handlePitchBend);
-  MIDI2.setHandleProgramChange(handleProgramChange);
-  MIDI2.begin(MIDI_CHANNEL_OMNI);
+  Serial2.onReceive(midiUartReceive);
+  Serial2.setRxFIFOFull(1);
 #endif
 
 }
@@ -36,13 +86,61 @@ inline void handleNoteOn(uint8_t inChannel, uint8_t inNote, uint8_t inVelocity)
   DEB("MIDI note on ");
   DEBUG(inNote);
 #endif 
+  if (inChannel == DRUM_MIDI_CHAN) {
+    if (DrumBank.isOpen()) {
+      Drums.noteOn(inNote, inVelocity); // note number is the sample number in the bank
+    } else {
+      SynthDrums.noteOn(inNote % DRUMKIT_SIZE, inVelocity); // kit-relative note is the drum part
+    }
+    return;
+  }
   Synth.noteOn(inNote, inVelocity, 0.0f);
 }
 
 inline void handleNoteOff(uint8_t inChannel, uint8_t inNote, uint8_t inVelocity) {
+  if (inChannel == DRUM_MIDI_CHAN) {
+    return; // drum samples are one-shots
+  }
   Synth.noteOff(inNote, 0.0f);
 }
 
+#ifdef WAVES_PARTITION
+// CC_303_USER_WAVE: the oscillator switches between Synth.waveTable1 and a spare - the waveform is
+// copied into the one that isn't playing and the audio task takes it up at its next block (the
+// spare takes 27 KB of internal RAM, so it only exists with WAVES_PARTITION). The copy (or the
+// rendering of the saw) takes too long for the audio task, which handles the MIDI input, so the CC
+// only requests it and loop() does it, see userWaveService()
+static rosic::MipMappedWaveTable UserWaveTable;
+static rosic::MipMappedWaveTable *user_wave_table = &Synth.waveTable1; // playing or requested
+static volatile int user_wave_request = -1; // the number of the waveform, -1: none
+
+static void selectUserWave(uint8_t number) {
+  if (number > Waves.getNumWaves()) {
+    return;
+  }
+  // a request that the audio task hasn't taken up yet is withdrawn, its table isn't playing:
+  rosic::MipMappedWaveTable *table = Synth.cancelWaveTable1Request();
+  if (table == NULL) {
+    table = user_wave_table == &Synth.waveTable1 ? &UserWaveTable : &Synth.waveTable1;
+  }
+  if (number == 0) {
+    table->setWaveform(rosic::MipMappedWaveTable::SAW303);
+  } else {
+    table->setMipMap(Waves.getMipMap(number - 1), Waves.getScale(number - 1)); // no rendering
+  }
+  Synth.requestWaveTable1(table);
+  user_wave_table = table;
+}
+
+// called from loop(): selects the waveform that was requested last
+void userWaveService() {
+  int number = __atomic_exchange_n(&user_wave_request, -1, __ATOMIC_ACQ_REL);
+  if (number >= 0) {
+    selectUserWave((uint8_t)number);
+  }
+}
+#endif
+
 inline void handleCC(uint8_t inChannel, uint8_t cc_number, uint8_t cc_value) {
   float norm_val ;
   switch (cc_number) { // global parameters yet set via ANY channel CCs
@@ -64,16 +162,67 @@ inline void handleCC(uint8_t inChannel, uint8_t cc_number, uint8_t cc_value) {
     case CC_303_ACCENT_LVL:
       Synth.setAccent(MIDI_NORM_100 * cc_value);
       break;
+    case CC_303_INPUT_LVL: // -48...+12 dB
+      Synth.setInputLevel(cc_value == 0 ? -100.0f : MIDI_NORM * 60.0f * cc_value - 48.0f);
+      break;
     case CC_303_VOLUME:
       //Synth.setVolume(amp2dBWithCheck((int)127-(int)cc_value, 0.000001f));
       break;
     case CC_303_DISTORTION:
+      Distortion.setBypass(cc_value == 0);
+      Distortion.setDrive(MIDI_NORM * 24.0f * cc_value);
+      Distortion.setOutputLevel(MIDI_NORM * -12.0f * cc_value);
+      break;
+    case CC_303_OVERDRIVE:
+      Overdrive.setBypass(cc_value == 0);
+      Overdrive.setDrive(MIDI_NORM * 36.0f * cc_value);
+      Overdrive.setOutputLevel(MIDI_NORM * -18.0f * cc_value);
       break;
     case CC_303_WAVEFORM:
       Synth.setWaveform(MIDI_NORM * cc_value);
       break;
+#ifdef WAVES_PARTITION
+    case CC_303_USER_WAVE:
+      user_wave_request = cc_value;
+      break;
+#endif
+    case CC_303_PAN: // 64 is the center
+      if (inChannel == DRUM_MIDI_CHAN) {
+        DrumPan.setPan(((int)cc_value - 64) * (1.0f / 63.0f));
+      } else {
+        SynthPan.setPan(((int)cc_value - 64) * (1.0f / 63.0f));
+      }
+      break;
+    case CC_303_WIDTH:
+      if (inChannel == DRUM_MIDI_CHAN) {
+        DrumPan.setWidth(MIDI_NORM * cc_value);
+      } else {
+        SynthPan.setWidth(MIDI_NORM * cc_value);
+      }
+      break;
     case  CC_303_PORTAMENTO:
       break;
+    case CC_ANY_COMPRESSOR:
+      Comp.setRatio(1.0f + 0.15f * cc_value); // 1:1 ... 20:1
+      break;
+    case CC_303_MORPH:
+      Morph.setMorph(MIDI_NORM * cc_value);
+      break;
+    case CC_303_MORPH_TARGET:
+      setMorphTarget(cc_value);
+      break;
+    case CC_303_STORE_PRESET:
+      storePreset(cc_value);
+      break;
+#ifdef RECORDER
+    case CC_ANY_RECORD:
+      if (cc_value >= 64) {
+        recorderStart();
+      } else {
+        recorderStop();
+      }
+      break;
+#endif
     /*
 #define CC_303_PORTATIME    5
 #define CC_303_VOLUME       7
@@ -102,9 +251,74 @@ inline void handleCC(uint8_t inChannel, uint8_t cc_number, uint8_t cc_value) {
 }
 
 void handleProgramChange(uint8_t inChannel, uint8_t number) {
+  if (inChannel == SYNTH1_MIDI_CHAN) {
+    selectProgram(number);
+  }
 }
 
 inline void handlePitchBend(uint8_t inChannel, int number) {
   float semitones = ((((float)number + 8191.5f) * (float)TWO_DIV_16383 ) - 1.0f ) * 2.0f;
   Synth.setPitchBend(semitones);
 }
+
+inline void handleClockAt(double time) {
+  MidiClock.clockTick(time);
+}
+
+inline void handleClock() {
+  handleClockAt(sample_time_now());
+}
+
+inline void handleStart() {
+  MidiClock.start();
+  if (Synth.sequencer.getSequencerMode() == rosic::AcidSequencer::HOST_SYNC) {
+    Synth.sequencer.start();
+  }
+}
+
+inline void handleContinue() {
+  MidiClock.proceed();
+  if (Synth.sequencer.getSequencerMode() == rosic::AcidSequencer::HOST_SYNC) {
+    Synth.sequencer.start(); // the step is taken from the clock position
+  }
+}
+
+inline void handleStop() {
+  if (Synth.sequencer.getSequencerMode() == rosic::AcidSequencer::HOST_SYNC) {
+    Synth.sequencer.stop();
+  }
+}
+
+// calls the handlers for a parsed message, like the MIDI library does (a note on with zero velocity is a note off)
+void handleMidiMessage(const rosic::MidiMessage &message) {
+  uint8_t chan = message.getChannel();
+  switch (message.getType()) {
+    case 0x80:
+      handleNoteOff(chan, message.data1, message.data2);
+      break;
+    case 0x90:
+      if (message.data2 == 0) {
+        handleNoteOff(chan, message.data1, 0);
+      } else {
+        handleNoteOn(chan, message.data1, message.data2);
+      }
+      break;
+    case 0xB0:
+      handleCC(chan, message.data1, message.data2);
+      break;
+    case 0xC0:
+      handleProgramChange(chan, message.data1);
+      break;
+    case 0xE0:
+      handlePitchBend(chan, (int)((message.data2 << 7) | message.data1) - 8192);
+      break;
+    case 0xF0:
+      switch (message.status) {
+        case 0xF8: handleClockAt(message.time); break;
+        case 0xFA: handleStart();               break;
+        case 0xFB: handleContinue();            break;
+        case 0xFC: handleStop();                break;
+      }
+      break;
+  }
+}
@@ -0,0 +1,86 @@
+// Programs of the synth: the preset bank (see rosic_PresetBank.h) is kept as one blob in the NVS,
+// program changes and the morph are applied by the audio task (see rosic_PresetMorpher.h)
+
+#define PRESETS_NAMESPACE "open303"
+#define PRESETS_KEY       "bank"
+
+static volatile bool presets_save_request = false;
+
+// loads the bank from the NVS, keeps the factory presets if there is none (or an incompatible one)
+void presetsInit() {
+  Morph.setSynth(&Synth);
+  if (!Presets.isValid()) {
+    DEBUG("No memory for the preset bank");
+    return;
+  }
+  Preferences prefs;
+  if (!prefs.begin(PRESETS_NAMESPACE, true)) {
+    DEBUG("Factory presets");
+    return;
+  }
+  size_t size = prefs.getBytesLength(PRESETS_KEY);
+  void *data = size > 0 ? bulkMalloc(size) : NULL;
+  if (data != NULL) {
+    prefs.getBytes(PRESETS_KEY, data, size);
+    if (Presets.setData(data, size)) {
+      DEBUG("Presets loaded");
+    } else {
+      DEBUG("Stored presets don't match, factory presets");
+    }
+    bulkFree(data);
+  } else {
+    DEBUG("Factory presets");
+  }
+  prefs.end();
+}
+
+// writes the whole bank to the NVS - called by presetsService() in loop(), not from the MIDI handlers
+// (the UART event task) or the audio task
+void savePresets() {
+  Preferences prefs;
+  if (!Presets.isValid() || !prefs.begin(PRESETS_NAMESPACE, false)) {
+    return;
+  }
+  if (prefs.putBytes(PRESETS_KEY, Presets.getData(), Presets.getDataSize()) != (size_t)Presets.getDataSize()) {
+    DEBUG("Saving the presets failed");
+  }
+  prefs.end();
+}
+
+// called from loop(): writes the bank when a preset was stored since the last call - a store while
+// the bank is being written requests another write
+void presetsService() {
+  if (presets_save_request) {
+    presets_save_request = false;
+    savePresets();
+  }
+}
+
+// program change: the morph starts from the new program
+void selectProgram(uint8_t number) {
+  const rosic::Open303Preset *preset = Presets.getPreset(number);
+  if (preset != NULL) {
+    Morph.setPresetA(*preset);
+    DEBF("Program %d: %s\r\n", number, preset->getName());
+  }
+}
+
+void setMorphTarget(uint8_t number) {
+  const rosic::Open303Preset *preset = Presets.getPreset(number);
+  if (preset != NULL) {
+    Morph.setPresetB(*preset);
+  }
+}
+
+// stores the sound as it is now (morph and CCs included) - the bank goes to the flash in loop(),
+// writing it takes a while and may cause a dropout
+void storePreset(uint8_t number) {
+  rosic::Open303Preset preset;
+  preset.readFrom(Synth);
+  char name[rosic::Open303Preset::maxNameLength + 1];
+  snprintf(name, sizeof(name), "User %d", number);
+  preset.setName(name);
+  Presets.setPreset(number, preset);
+  presets_save_request = true;
+  DEBF("Stored program %d\r\n", number);
+}
@@ -0,0 +1,88 @@
+// Jam recorder (RECORDER): the audio task puts the master output, as it goes to I2S, into the ring
+// buffer of Recorder, the writer task below puts it on the SD card as WAV files jam_000.wav,
+// jam_001.wav, ... (see rosic_AudioRecorder.h). Started and stopped by CC_ANY_RECORD. Storage
+// never holds up the audio: when the card falls behind by more than the ring buffer, blocks are
+// dropped and counted, the report shows how close it came.
+
+#ifdef RECORDER
+#include <SPI.h>
+#include <SD.h>
+
+#define RECORDER_MOUNT      "/sd"
+#define RECORDER_MAX_FILES  1000
+#define RECORDER_REPORT_MS  5000
+
+TaskHandle_t RecorderTask;
+static volatile bool recorder_start_request = false;
+
+static void recorderReport() {
+  DEBF("Recorder: %u frames, %u overflows (%u frames dropped), max fill %u of %u bytes\r\n",
+       (unsigned)Recorder.getNumFramesRecorded(), (unsigned)Recorder.getNumOverflows(),
+       (unsigned)Recorder.getNumDroppedFrames(), (unsigned)Recorder.getMaxFill(), (unsigned)Recorder.getBufferSize());
+}
+
+// the first unused file name, as a path for stdio
+static bool recorderNextPath(char *path, size_t size) {
+  char name[16];
+  for (int i = 0; i < RECORDER_MAX_FILES; i++) {
+    snprintf(name, sizeof(name), "/jam_%03d.wav", i);
+    if (!SD.exists(name)) {
+      snprintf(path, size, "%s%s", RECORDER_MOUNT, name);
+      return true;
+    }
+  }
+  return false;
+}
+
+// the writer: on core 1 next to loop(), the audio task on core 0 only sees the ring buffer
+static void recorder_task(void *userData) {
+  uint32_t last_report = millis();
+  while (true) {
+    if (recorder_start_request) {
+      recorder_start_request = false;
+      char path[32];
+      if (recorderNextPath(path, sizeof(path)) && Recorder.start(path)) {
+        DEBF("Recording to %s\r\n", path);
+        last_report = millis();
+      } else {
+        DEBUG("Can't start recording");
+      }
+    }
+    bool was_recording = Recorder.isRecording();
+    Recorder.service(); // whole blocks of 8 KB, the ring buffer covers 1.5 s
+    if (was_recording && !Recorder.isRecording()) {
+      DEBUG(Recorder.hasError() ? "Recording stopped by a write error" : "Recording stopped");
+      recorderReport();
+    } else if (Recorder.isRecording() && millis() - last_report >= RECORDER_REPORT_MS) {
+      last_report = millis();
+      recorderReport();
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+}
+
+void recorderInit() {
+  SPI.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN, SD_CS_PIN);
+  if (!SD.begin(SD_CS_PIN, SPI, 20000000, RECORDER_MOUNT)) {
+    DEBUG("No SD card, no recording");
+    return;
+  }
+  Recorder.setSampleRate(SAMPLE_RATE);
+#ifdef NO_PSRAM
+  Recorder.setBufferSize(4 * rosic::AudioRecorder::writeBlockSize); // 32 KB of internal RAM, 0.19 s
+#endif
+  xTaskCreatePinnedToCore(recorder_task, "Recorder", 4096, NULL, 1, &RecorderTask, 1);
+}
+
+// called from the MIDI handlers, the file is created by the writer task
+void recorderStart() {
+  if (!Recorder.isRecording()) {
+    recorder_start_request = true;
+  }
+}
+
+void recorderStop() {
+  Recorder.stop();
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 // rosic-indcludes:
 #include "rosic_AcidPattern.h"
+#include <limits.h>
 
 namespace rosic
 {
@@ -11,8 +12,6 @@ namespace rosic
 
   This is a sequencer for typical acid-lines involving slides and accents.
 
-  \todo: make the permissibility-thing work correctly
-
   */
 
   class AcidSequencer
@@ -62,6 +61,12 @@ namespace rosic
     /** Selects one of the modes for the sequencer @see sequencerModes. */
     void setMode(int newMode);
 
+    /** In HOST_SYNC mode, this informs the sequencer about the position of the host's clock (in
+    24 ppqn ticks since the host's start) at the current sample and about the clock's speed (in
+    ticks per sample). It should be called once per block - the steps are then locked to the
+    16th notes of the host clock and the tempo is taken from the clock. */
+    void setHostClock(double tickPosition, double ticksPerSample);
+
     /** Sets the length of one step (the time while gate is open) in units of one step (which 
     is one 16th note). */
     void setStepLength(float newStepLength) 
@@ -117,6 +122,29 @@ namespace rosic
     /** Returns a pointer to the note that occurs at this sample if any, NULL otherwise. */
     INLINE AcidNote* getNote();
 
+    /** Returns the number of samples that will pass before the next step occurs, i.e. the number
+    of upcoming calls to getNote() that will return NULL (INT_MAX when the sequencer is not
+    running). The caller may render that many samples as one uninterrupted block and call
+    advance() instead of polling getNote() for each of them. */
+    INLINE int getSamplesToNextStep() const
+    {
+      if( running == false )
+        return INT_MAX;
+      return countDown > 0 ? countDown : 0;
+    }
+
+    /** Advances the sequencer by the given number of event-free samples - this is equivalent to
+    that many calls to getNote() which return NULL, so numSamples must not exceed the value
+    returned by getSamplesToNextStep(). */
+    INLINE void advance(int numSamples)
+    {
+      if( running )
+      {
+        countDown       -= numSamples;
+        hostSampleCount += numSamples;
+      }
+    }
+
     /** Returns the next note that will be scheduled - after getNote() has returned a non-NULL 
     pointer, this will be the next non-NULL note that will be returned. So, if an event has 
     occurred at some time instant, you may investigate the next upcoming event beforehand by 
@@ -149,6 +177,14 @@ namespace rosic
 
   protected:
 
+    /** Rebuilds the closestPermissibleKey table - called whenever the permissibilities change. */
+    void updateClosestPermissibleKeys();
+
+    /** Called in HOST_SYNC mode when the countdown has expired - returns the note of the 16th at
+    the current host clock position (or NULL when the first step after a start is not yet
+    reached) and sets up the countdown to the next 16th. */
+    AcidNote* getHostSyncedNote();
+
     static const int numPatterns = 16;
     AcidPattern patterns[numPatterns];
 
@@ -162,6 +198,10 @@ namespace rosic
     int    sequencerMode;      // the selected mode for the sequencer
     float driftError;         // to keep track and compensate for accumulating timing error
     bool   keyPermissible[13]; // array of flags to indicate if a particular key is permissible
+    int    closestPermissibleKey[13]; // the permissible key to be played for each key, -1 if none
+    double hostTickPosition;   // host clock position (in ticks) at the last call to setHostClock
+    double hostTicksPerSample; // host clock speed, 0 when unknown
+    int    hostSampleCount;    // samples since the last call to setHostClock
 
   };
 
@@ -177,8 +217,11 @@ namespace rosic
     if( countDown > 0 )
     {
       countDown--;
+      hostSampleCount++;
       return NULL;
     }
+    else if( sequencerMode == HOST_SYNC )
+      return getHostSyncedNote();
     else
     {
       float secondsToNextStep = beatsToSeconds(0.25, bpm);
@@ -209,39 +252,7 @@ namespace rosic
   INLINE int AcidSequencer::getClosestPermissibleKey(int key)
   {
     if( key >= 0 && key <= 12 )
-    {
-      if( keyPermissible[key] )
-        return key;
-      else
-      {
-        // find the closest lower permissible key:
-        int kLo = key-1;
-        while( kLo >= 0 )
-        {
-          if( keyPermissible[kLo] )
-            break;
-          kLo--;
-        }
-
-        // find the closest higher permissible key:
-        int kHi = key+1;
-        while( kHi < 12 )
-        {
-          if( keyPermissible[kHi] )
-            break;
-          kHi++;
-        }
-
-        // select the closest (subject to the constraint that it must be between 0 and 12):
-        if(      (kHi-key) <  (kLo-key) && kHi <= 12 )
-          return kHi;
-        else if( (kLo-key) <  (kHi-key) && kLo >= 0  )
-          return kLo;
-        else if( (kHi-key) == (kLo-key) && kLo >= 0  )
-          return kLo;
-        else return -1; // none of the keys is permissible
-      }
-    }
+      return closestPermissibleKey[key];
     else
       return 0;
   }
@@ -16,8 +16,13 @@ AcidSequencer::AcidSequencer()
   driftError    = 0.0;
   modeChanged   = false;
 
+  hostTickPosition   = 0.0;
+  hostTicksPerSample = 0.0;
+  hostSampleCount    = 0;
+
   for(int k=0; k<=12; k++)
     keyPermissible[k] = true;
+  updateClosestPermissibleKeys();
 
   patterns[activePattern].randomize();
 }
@@ -40,16 +45,31 @@ void AcidSequencer::setMode(int newMode)
   }
 }
 
+void HOT_CODE AcidSequencer::setHostClock(double tickPosition, double ticksPerSample)
+{
+  hostTickPosition   = tickPosition;
+  hostTicksPerSample = ticksPerSample;
+  hostSampleCount    = 0;
+  if( ticksPerSample > 0.0 )
+    bpm = (float) (2.5 * ticksPerSample * sampleRate); // 60 s/min / 24 ticks/beat
+}
+
 void AcidSequencer::setKeyPermissible(int key, bool shouldBePermissible)
 {
-  if( key >= 0 && key <= 12 )
+  if( key >= 0 && key <= 12 && keyPermissible[key] != shouldBePermissible )
+  {
     keyPermissible[key] = shouldBePermissible;
+    updateClosestPermissibleKeys();
+  }
 }
 
 void AcidSequencer::toggleKeyPermissibility(int key)
 {
   if( key >= 0 && key <= 12 )
+  {
     keyPermissible[key] = !keyPermissible[key];
+    updateClosestPermissibleKeys();
+  }
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -99,3 +119,58 @@ void AcidSequencer::stop()
 
 //-------------------------------------------------------------------------------------------------
 // others:
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+AcidNote* HOT_CODE AcidSequencer::getHostSyncedNote()
+{
+  const int ticksPerStep = 6; // a 16th note at 24 ppqn
+
+  double position = hostTickPosition + hostSampleCount * hostTicksPerSample;
+  hostSampleCount++;
+  if( hostTicksPerSample <= 0.0 || position < -0.5 )
+  {
+    // no tempo yet or waiting for the first tick after a start - look again soon:
+    countDown = 32;
+    if( hostTicksPerSample > 0.0 )
+      countDown = clip(roundToInt(-position / hostTicksPerSample) - 1, 0, 32);
+    return NULL;
+  }
+
+  // lock the step to the closest 16th of the host clock and schedule the next one:
+  long hostStep = (long) floor(position / ticksPerStep + 0.5);
+  double samplesToNextStep = ((hostStep+1) * ticksPerStep - position) / hostTicksPerSample;
+  countDown = roundToInt(samplesToNextStep) - 1;
+  if( countDown < 0 )
+    countDown = 0;
+
+  int numSteps   = patterns[activePattern].getNumSteps();
+  step           = (int) (hostStep % numSteps);
+  AcidNote* note = patterns[activePattern].getNote(step);
+  note->key      = getClosestPermissibleKey(note->key);
+  step           = (step+1) % numSteps;
+  return note;
+}
+
+void AcidSequencer::updateClosestPermissibleKeys()
+{
+  for(int key=0; key<=12; key++)
+  {
+    // search outward from the key, the lower one wins when two keys are at equal distance:
+    closestPermissibleKey[key] = -1;
+    for(int d=0; d<=12; d++)
+    {
+      if( key-d >= 0 && keyPermissible[key-d] )
+      {
+        closestPermissibleKey[key] = key-d;
+        break;
+      }
+      if( key+d <= 12 && keyPermissible[key+d] )
+      {
+        closestPermissibleKey[key] = key+d;
+        break;
+      }
+    }
+  }
+}
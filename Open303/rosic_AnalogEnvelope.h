@@ -19,6 +19,12 @@ namespace rosic
   the filter reaches 63.2% of the end value (for an incoming step-function). This time constant can 
   be scaled to re-define the ramp time to other values than 63.2%.
 
+  The envelope runs as a state machine over the segments attack (including hold), decay, sustain
+  and release. The segment boundaries are converted to integer sample counts, such that within a
+  segment each sample is just one recursion of the RC unit without any time comparisons: the
+  distance to the segment's target level is reduced by a constant fraction. This allows to render
+  whole blocks with processBlock().
+
   */
 
   class AnalogEnvelope
@@ -51,7 +57,7 @@ namespace rosic
     void setStartInSemitones(float newStart) { setStartLevel(pitchOffsetToFreqFactor(newStart)); }  
 
     /** Sets the highest point of the envelope (as raw value). */
-    void setPeakLevel(float newPeak) { peakLevel = newPeak; }
+    void setPeakLevel(float newPeak) { peakLevel = newPeak; updateSegment(); }
 
     /** Sets the highest point of the envelope (in dB). */
     void setPeakInDecibels(float newPeak) { setPeakLevel(dB2amp(newPeak)); }
@@ -74,7 +80,7 @@ namespace rosic
     { setPeakLevelByVel(pitchOffsetToFreqFactor(newPeakByVel)); }
 
     /** Sets the sustain level (as raw value). */
-    void setSustainLevel(float newSustain) { sustainLevel = newSustain; }
+    void setSustainLevel(float newSustain) { sustainLevel = newSustain; updateSegment(); }
 
     /** Sets the sustain level (in dB). */
     void setSustainInDecibels(float newSustain) { setSustainLevel(dB2amp(newSustain)); }
@@ -84,7 +90,7 @@ namespace rosic
     { setSustainLevel(pitchOffsetToFreqFactor(newSustain)); }
 
     /** Sets the end point of the envelope (as raw value). */
-    void setEndLevel(float newEnd) { endLevel = newEnd; }
+    void setEndLevel(float newEnd) { endLevel = newEnd; updateSegment(); }
 
     /** Sets the end point of the envelope (in dB). */
     void setEndInDecibels(float newEnd) { setEndLevel(dB2amp(newEnd)); }
@@ -117,7 +123,7 @@ namespace rosic
     void setPeakScale(float newPeakScale); 
 
     /** Sets the internal state of the RC-filter. */
-    void setInternalState(float newState) { previousOutput = newState; }
+    void setInternalState(float newState) { offset = newState - target; }
 
     //---------------------------------------------------------------------------------------------
     // inquiry:
@@ -146,6 +152,9 @@ namespace rosic
     /** Calculates one output sample at a time. */
     INLINE float getSample();    
 
+    /** Calculates a block of output samples - equivalent to calling getSample() length times. */
+    void processBlock(float *buffer, int length);
+
     //---------------------------------------------------------------------------------------------
     // others:
 
@@ -162,9 +171,32 @@ namespace rosic
 
   protected:
 
-    /** Calculates our members that represent accumulated time values from attack, hold, etc. */
+    /** The segments of the envelope. */
+    enum segments
+    {
+      ATTACK = 0,  // attack and hold
+      DECAY,
+      SUSTAIN,
+      RELEASE
+    };
+
+    /** Calculates our members that represent accumulated time values from attack, hold, etc. and
+    the segment boundaries in samples. */
     void calculateAccumulatedTimes();
 
+    /** Returns the number of samples from the trigger that lie within the given time (in
+    milliseconds), i.e. the index of the first sample after it. */
+    int timeToSamples(float time);
+
+    /** Moves on to the next segment that is not empty (called when samplesLeft has run out). */
+    void nextSegment();
+
+    /** Updates target, coeff and samplesLeft for the current segment after parameter changes. */
+    void updateSegment();
+
+    /** Moves the end of the current (finite) segment to the given sample index. */
+    void moveSegmentEnd(int newEnd);
+
     // level and time parameters:
     float startLevel, peakLevel, sustainLevel, endLevel;  
     float attackTime, holdTime, decayTime, releaseTime;    // in seconds
@@ -173,18 +205,28 @@ namespace rosic
     // accumulated time values:
     float attPlusHld, attPlusHldPlusDec, attPlusHldPlusDecPlusRel;
 
-    float time;       // time since the last call to to trigger() 
     float timeScale;  // scale the time constants in the filters according to
     float increment;  // increment for the time variable per sample 
     float tauScale;   // scale factor for the time constants of the filters
     float peakScale;  // scale factor for the peak-value
 
     float attackCoeff,  decayCoeff, releaseCoeff;   // filter coefficients
-    float previousOutput;                           // previous output sample
     float sampleRate;                               // sample-rate
     bool   outputIsZero;                             // indicates if envelope has reached its end
     bool   noteIsOn;                                 // indicates if note is being held
 
+    // segment state:
+    int   segment;      // the current segment
+    int   samplesLeft;  // number of samples until the next segment starts
+    int   segmentEnd;   // sample index (since the trigger) at which the current segment ends
+    int   attackEnd;    // sample index at which the attack (and hold) ends
+    int   decayEnd;     // sample index at which the decay ends
+    float target;       // the level the current segment approaches
+    float coeff;        // the filter coefficient of the current segment
+    float offset;       // distance of the output from the target (the state of the RC unit)
+
+    static const int endless = 0x40000000; // length of sustain and release (about 6 hours)
+
   };
 
   //-----------------------------------------------------------------------------------------------
@@ -192,41 +234,12 @@ namespace rosic
 
   INLINE float AnalogEnvelope::getSample()
   {
-    float out;
-
-    // attack or hold phase:
-    if(time <= attPlusHld)   // noteIsOn has not to be checked, because, time is advanced to the 
-                             // beginning of the release phase in noteOff()
-    {
-      out   = previousOutput + attackCoeff * (peakScale*peakLevel - previousOutput);
-      time += increment;
-    }
-
-    // decay phase:
-    else if(time <= (attPlusHldPlusDec)) // noteIsOn has not to be checked
-    {
-      out   = previousOutput + decayCoeff * (sustainLevel - previousOutput);
-      time += increment;
-    }
-
-    // sustain phase:
-    else if(noteIsOn)
-    {
-      out = previousOutput + decayCoeff * (sustainLevel - previousOutput);
-      // time is not incremented in sustain
-    }
-
-    // release phase:
-    else
-    {
-      out   = previousOutput + releaseCoeff * (endLevel - previousOutput);
-      time += increment;
-    }
-
-    // store output sample for next call:
-    previousOutput = out; // + TINY;  // TINY is to avoid denorm problems
+    if( samplesLeft == 0 )
+      nextSegment();
+    samplesLeft--;
 
-    return out;
+    offset -= coeff * offset;
+    return target + offset;
   }
 
 } // end namespace rosic
@@ -15,7 +15,6 @@ AnalogEnvelope::AnalogEnvelope()
   sustainLevel   = 0.5;
   releaseTime    = 0.01;
   endLevel       = 0.0;
-  time           = 0.0;
   timeScale      = 1.0;
   peakByVel      = 1.0;
   peakByKey      = 1.0;
@@ -27,7 +26,16 @@ AnalogEnvelope::AnalogEnvelope()
   noteIsOn       = false;
   outputIsZero   = true;
 
-  previousOutput = 0.0;
+  target         = 0.0;
+  offset         = 0.0;
+  attackCoeff    = 1.0;
+  decayCoeff     = 1.0;
+  releaseCoeff   = 1.0;
+
+  // start with the attack segment (as if a note was triggered without noteOn):
+  segment        = ATTACK;
+  segmentEnd     = 0;
+  samplesLeft    = 0;
 
   // call these functions to trigger the coefficient calculations:
   setAttack(attackTime);
@@ -80,7 +88,7 @@ void AnalogEnvelope::setHold(float newHoldTime)
   calculateAccumulatedTimes();
 }
 
-void AnalogEnvelope::setDecay(float newDecayTime)
+void HOT_CODE AnalogEnvelope::setDecay(float newDecayTime)
 {
   if( newDecayTime > 0.0 )
   {
@@ -96,7 +104,7 @@ void AnalogEnvelope::setDecay(float newDecayTime)
   calculateAccumulatedTimes();
 }
 
-void AnalogEnvelope::setRelease(float newReleaseTime)
+void HOT_CODE AnalogEnvelope::setRelease(float newReleaseTime)
 {
   if( newReleaseTime > 0.0 )
   {
@@ -139,44 +147,77 @@ void AnalogEnvelope::setPeakScale(float newPeakScale)
 {
   if( newPeakScale > 0 )
     peakScale = newPeakScale;
+  updateSegment();
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE AnalogEnvelope::processBlock(float *buffer, int length)
+{
+  while( length > 0 )
+  {
+    if( samplesLeft == 0 )
+      nextSegment();
+    int n = samplesLeft < length ? samplesLeft : length;
+
+    // within a segment, the offset from the target just decays exponentially:
+    float d = offset;
+    float c = coeff;
+    float t = target;
+    for(int i=0; i<n; i++)
+    {
+      d        -= c * d;
+      buffer[i] = t + d;
+    }
+    offset = d;
+
+    samplesLeft -= n;
+    buffer      += n;
+    length      -= n;
+  }
 }
 
 //-------------------------------------------------------------------------------------------------
 // others:
 
-void AnalogEnvelope::reset()
+void HOT_CODE AnalogEnvelope::reset()
 {
-  time = 0.0f;
+  segment     = ATTACK;
+  segmentEnd  = 0;
+  samplesLeft = 0;
+  updateSegment();
 }
 
-void AnalogEnvelope::noteOn(bool startFromCurrentLevel, int newKey, int newVel)
+void HOT_CODE AnalogEnvelope::noteOn(bool startFromCurrentLevel, int newKey, int newVel)
 {
   if( !startFromCurrentLevel )
-    previousOutput = startLevel;  // may lead to clicks
+    offset = startLevel - target;  // may lead to clicks
 
 
   // \todo: calculate key and velocity scale factors for duration and peak-value...
 
 
   // reset time for the new note:
-  time         = 0.0f;
   noteIsOn     = true;
   outputIsZero = false;
+  reset();
 }
 
-void AnalogEnvelope::noteOff()
+void HOT_CODE AnalogEnvelope::noteOff()
 {
   noteIsOn = false;
 
-  // advance time to the beginnig of the release phase:
-  time = (attackTime + holdTime + decayTime + increment);
+  // advance to the release phase:
+  segment = RELEASE;
+  updateSegment();
 }
 
-bool AnalogEnvelope::endIsReached()
+bool HOT_CODE AnalogEnvelope::endIsReached()
 {
   //return false; // test
 
-  if( noteIsOn == false && previousOutput < 0.000001 )
+  if( noteIsOn == false && target + offset < 0.000001 )
     return true;
   else
     return false;
@@ -185,9 +226,87 @@ bool AnalogEnvelope::endIsReached()
 //-------------------------------------------------------------------------------------------------
 // internal functions:
 
-void AnalogEnvelope::calculateAccumulatedTimes()
+void HOT_CODE AnalogEnvelope::calculateAccumulatedTimes()
 {
   attPlusHld               = attackTime + holdTime;
   attPlusHldPlusDec        = attPlusHld + decayTime;
   attPlusHldPlusDecPlusRel = attPlusHldPlusDec + releaseTime;
+
+  attackEnd = timeToSamples(attPlusHld);
+  decayEnd  = timeToSamples(attPlusHldPlusDec);
+  updateSegment();
+}
+
+int HOT_CODE AnalogEnvelope::timeToSamples(float time)
+{
+  // sample n is at time n*increment, the segment lasts while the time is <= its end:
+  double n = floor((double) time / (double) increment) + 1.0;
+  if( n > endless )
+    return endless;
+  return (int) n;
+}
+
+void HOT_CODE AnalogEnvelope::nextSegment()
+{
+  // empty segments (like a decay of zero length) are skipped, sustain and release go on until 
+  // they are left by noteOff() and noteOn():
+  while( samplesLeft == 0 )
+  {
+    if( segment == ATTACK )
+      segment = DECAY;
+    else if( segment == DECAY )
+      segment = noteIsOn ? SUSTAIN : RELEASE;
+    updateSegment();
+  }
+}
+
+void HOT_CODE AnalogEnvelope::updateSegment()
+{
+  float currentOutput = target + offset;
+
+  switch( segment )
+  {
+  case ATTACK:
+    {
+      target = peakScale*peakLevel;
+      coeff  = attackCoeff;
+      moveSegmentEnd(attackEnd);
+    }
+    break;
+  case DECAY:
+    {
+      target = sustainLevel;
+      coeff  = decayCoeff;
+      moveSegmentEnd(decayEnd);
+    }
+    break;
+  case SUSTAIN:
+    {
+      // the sustain uses the decay's time constant:
+      target      = sustainLevel;
+      coeff       = decayCoeff;
+      segmentEnd  = endless;
+      samplesLeft = endless;
+    }
+    break;
+  default: // RELEASE
+    {
+      target      = endLevel;
+      coeff       = releaseCoeff;
+      segmentEnd  = endless;
+      samplesLeft = endless;
+    }
+    break;
+  }
+  offset = currentOutput - target;
+}
+
+void HOT_CODE AnalogEnvelope::moveSegmentEnd(int newEnd)
+{
+  // the sample index we are at - when the end has been moved to before it, the segment is over:
+  int position = segmentEnd - samplesLeft;
+  if( newEnd < position )
+    newEnd = position;
+  segmentEnd  = newEnd;
+  samplesLeft = newEnd - position;
 }
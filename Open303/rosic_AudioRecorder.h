@@ -0,0 +1,160 @@
+#ifndef rosic_AudioRecorder_h
+#define rosic_AudioRecorder_h
+
+#include <stdio.h>
+#include <stdint.h>
+
+// rosic-indcludes:
+#include "rosic_FunctionTemplates.h"
+
+namespace rosic
+{
+
+  /**
+
+  This records the stereo output (16 bit frames, as they go to I2S) into a WAV file. It is split
+  into two sides that run in different tasks and never wait for each other:
+
+  - the audio task (producer) only copies each block of frames into a ring buffer (in bulk memory,
+    see bulkMalloc) with write(). When the ring buffer is full, the block is dropped and counted -
+    storage never holds up the audio.
+  - a low priority writer task (consumer) calls service() which writes the ring buffer to the file
+    in large blocks. The data chunk of the file starts at a sector boundary (the header is padded
+    with a JUNK chunk to headerSize bytes) and the ring buffer is a multiple of the write block
+    size, so each write is one contiguous, sector aligned piece of writeBlockSize bytes, straight
+    from the ring buffer and without stdio buffering - which is what SD cards (FATFS) like best.
+
+  The file is a plain stdio file, a path on a mounted SD card on the device (e.g. "/sd/jam.wav")
+  and a regular file on the host.
+
+  The ring buffer is lock-free for one producer and one consumer: each side only advances its own
+  index. Stopping is a handshake - stop() only asks for it, the producer confirms by not writing
+  anymore, then the writer finishes the file. So the writer can close the file without knowing
+  whether the producer is in the middle of a block.
+
+  */
+
+  class AudioRecorder
+  {
+
+  public:
+
+    /** The size of the WAV header (a multiple of the sector size). */
+    static const int headerSize = 512;
+
+    /** The size of the blocks that are written to the file (a multiple of the sector size). */
+    static const int writeBlockSize = 8192;
+
+    /** The default size of the ring buffer, 1.5 seconds at 44.1 kHz. */
+    static const int defaultBufferSize = 32*writeBlockSize;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. The ring buffer is allocated by the first start(). */
+    AudioRecorder();
+
+    /** Destructor. Finishes a recording that is still open. */
+    ~AudioRecorder();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample rate that goes into the header of the next file. */
+    void setSampleRate(int newSampleRate) { sampleRate = newSampleRate; }
+
+    /** Sets the size of the ring buffer (in bytes, it is rounded up to writeBlockSize) for the next
+    recording - the time it covers is what the storage may lag behind. */
+    void setBufferSize(int newBufferSize);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns true from start() until the file is finished. */
+    bool isRecording() const { return state != IDLE; }
+
+    /** Returns true when the last recording was ended by a write error (e.g. a full card). */
+    bool hasError() const { return error; }
+
+    /** Returns the number of frames that went into the ring buffer in this recording. */
+    uint32_t getNumFramesRecorded() const { return writeIndex / bytesPerFrame; }
+
+    /** Returns the number of blocks that were dropped because the ring buffer was full. */
+    uint32_t getNumOverflows() const { return numOverflows; }
+
+    /** Returns the number of frames that were dropped because the ring buffer was full. */
+    uint32_t getNumDroppedFrames() const { return numDroppedFrames; }
+
+    /** Returns the highest fill level of the ring buffer in this recording (in bytes), compare it
+    to getBufferSize(). */
+    uint32_t getMaxFill() const { return maxFill; }
+
+    /** Returns the size of the ring buffer in bytes. */
+    int getBufferSize() const { return bufferSize; }
+
+    //---------------------------------------------------------------------------------------------
+    // recording (producer side):
+
+    /** Puts stereo frames (interleaved, 16 bit) into the ring buffer - or drops them when they
+    don't fit. Does nothing when not recording. */
+    void write(const int16_t *frames, int numFrames);
+
+    //---------------------------------------------------------------------------------------------
+    // writing (consumer side):
+
+    /** Creates the file and starts the recording. Returns false when a recording is still open or
+    the file can't be created. */
+    bool start(const char *path);
+
+    /** Asks to end the recording - the writer finishes the file as soon as the producer has
+    confirmed it (with its next write()). May be called from any task. */
+    void stop();
+
+    /** Writes what has come in to the file, in whole blocks, and finishes the file when the
+    recording has stopped. To be called regularly by the writer task, returns the number of bytes
+    written. */
+    int service();
+
+    /** Ends the recording and finishes the file at once - only when the producer doesn't run
+    anymore (e.g. from the same thread, after the last write()). */
+    void close();
+
+    //=============================================================================================
+
+  protected:
+
+    /** The recording states, see the handshake above. */
+    enum states
+    {
+      IDLE = 0,   // no file
+      RECORDING,  // the producer writes into the ring buffer
+      STOPPING,   // stop was asked for, the producer hasn't seen it yet
+      DRAINING    // the producer has stopped, the rest of the ring buffer goes to the file
+    };
+
+    /** Writes the WAV header for the given size of the data chunk. */
+    bool writeHeader(uint32_t dataSize);
+
+    /** Writes the rest of the ring buffer, completes the header and closes the file. */
+    void finish();
+
+    static const int bytesPerFrame = 4;                   // 2 channels, 16 bit
+    static const uint32_t maxDataSize = 0xFFFFFFFFUL - 2*headerSize; // the limit of WAV (and FAT)
+
+    uint8_t *buffer;             // the ring buffer
+    int      bufferSize;         // its size in bytes, a multiple of writeBlockSize
+    int      newBufferSize;      // the size for the next recording
+    FILE    *file;
+    int      sampleRate;
+    uint32_t dataSize;           // bytes written to the data chunk
+
+    volatile int      state;
+    volatile uint32_t writeIndex, readIndex;  // in bytes, running (not wrapped)
+    volatile uint32_t numOverflows, numDroppedFrames, maxFill;
+    volatile bool     error;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_AudioRecorder_h
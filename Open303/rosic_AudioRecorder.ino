@@ -0,0 +1,221 @@
+#include "rosic_AudioRecorder.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+AudioRecorder::AudioRecorder()
+{
+  buffer           = NULL;
+  bufferSize       = 0;
+  newBufferSize    = defaultBufferSize;
+  file             = NULL;
+  sampleRate       = SAMPLE_RATE;
+  dataSize         = 0;
+  state            = IDLE;
+  writeIndex       = 0;
+  readIndex        = 0;
+  numOverflows     = 0;
+  numDroppedFrames = 0;
+  maxFill          = 0;
+  error            = false;
+}
+
+AudioRecorder::~AudioRecorder()
+{
+  close();
+  bulkFree(buffer);
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void AudioRecorder::setBufferSize(int newSize)
+{
+  // a power of 2, such that the running indices wrap around with the buffer:
+  int size = writeBlockSize;
+  while( size < newSize && size < (1<<30) )
+    size *= 2;
+  newBufferSize = size;
+}
+
+//-------------------------------------------------------------------------------------------------
+// recording (producer side):
+
+void HOT_CODE AudioRecorder::write(const int16_t *frames, int numFrames)
+{
+  int s = state;
+  if( s != RECORDING )
+  {
+    if( s == STOPPING )
+      state = DRAINING; // confirms the stop, nothing goes into the buffer from here on
+    return;
+  }
+
+  uint32_t numBytes = (uint32_t) numFrames * bytesPerFrame;
+  uint32_t w        = writeIndex;
+  uint32_t fill     = w - readIndex;
+  if( fill + numBytes > (uint32_t) bufferSize )
+  {
+    numOverflows++;
+    numDroppedFrames += numFrames;
+    return;
+  }
+
+  uint32_t pos   = w & (bufferSize-1);
+  uint32_t part1 = rmin(numBytes, (uint32_t) bufferSize - pos);
+  memcpy(&buffer[pos], frames, part1);
+  memcpy(buffer, (const uint8_t*) frames + part1, numBytes - part1);
+  writeIndex = w + numBytes;    // publishes the frames
+
+  if( fill + numBytes > maxFill )
+    maxFill = fill + numBytes;
+}
+
+//-------------------------------------------------------------------------------------------------
+// writing (consumer side):
+
+bool AudioRecorder::start(const char *path)
+{
+  if( state != IDLE )
+    return false;
+
+  if( buffer == NULL || bufferSize != newBufferSize )
+  {
+    bulkFree(buffer);
+    buffer     = (uint8_t*) bulkMalloc(newBufferSize);
+    bufferSize = buffer != NULL ? newBufferSize : 0;
+    if( buffer == NULL )
+      return false;
+  }
+
+  file = fopen(path, "wb");
+  if( file == NULL )
+    return false;
+  setvbuf(file, NULL, _IONBF, 0); // the blocks go to the file system as they are
+
+  // the producer doesn't touch the indices while idle:
+  writeIndex       = 0;
+  readIndex        = 0;
+  dataSize         = 0;
+  numOverflows     = 0;
+  numDroppedFrames = 0;
+  maxFill          = 0;
+  error            = false;
+  if( !writeHeader(0) )
+  {
+    fclose(file);
+    file  = NULL;
+    error = true;
+    return false;
+  }
+  state = RECORDING;
+  return true;
+}
+
+void AudioRecorder::stop()
+{
+  if( state == RECORDING )
+    state = STOPPING;
+}
+
+int AudioRecorder::service()
+{
+  int s = state;
+  if( s == IDLE )
+    return 0;
+
+  int written = 0;
+  while( !error && writeIndex - readIndex >= (uint32_t) writeBlockSize )
+  {
+    if( dataSize + writeBlockSize > maxDataSize )
+    {
+      stop(); // the file is full
+      break;
+    }
+    uint32_t r = readIndex;
+    if( fwrite(&buffer[r & (bufferSize-1)], 1, writeBlockSize, file) != (size_t) writeBlockSize )
+    {
+      error = true;
+      stop();
+      break;
+    }
+    dataSize  += writeBlockSize;
+    readIndex  = r + writeBlockSize; // frees the block for the producer
+    written   += writeBlockSize;
+  }
+
+  if( s == DRAINING )
+  {
+    written += writeIndex - readIndex;
+    finish();
+  }
+  return written;
+}
+
+void AudioRecorder::close()
+{
+  if( state == IDLE )
+    return;
+  state = DRAINING;
+  service();
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+static void putLittleEndian(uint8_t *p, uint32_t value, int numBytes)
+{
+  for(int i=0; i<numBytes; i++)
+    p[i] = (uint8_t) (value >> (8*i));
+}
+
+bool AudioRecorder::writeHeader(uint32_t dataSize)
+{
+  uint8_t h[headerSize];
+  memset(h, 0, headerSize);
+  memcpy(&h[0], "RIFF", 4);
+  putLittleEndian(&h[4], headerSize - 8 + dataSize, 4);
+  memcpy(&h[8], "WAVEfmt ", 8);
+  putLittleEndian(&h[16], 16, 4);
+  putLittleEndian(&h[20], 1, 2);                           // PCM
+  putLittleEndian(&h[22], 2, 2);                           // stereo
+  putLittleEndian(&h[24], sampleRate, 4);
+  putLittleEndian(&h[28], sampleRate * bytesPerFrame, 4);  // bytes per second
+  putLittleEndian(&h[32], bytesPerFrame, 2);
+  putLittleEndian(&h[34], 16, 2);
+  memcpy(&h[36], "JUNK", 4);                               // pads the header to a sector
+  putLittleEndian(&h[40], headerSize - 52, 4);
+  memcpy(&h[headerSize-8], "data", 4);
+  putLittleEndian(&h[headerSize-4], dataSize, 4);
+  return fwrite(h, 1, headerSize, file) == (size_t) headerSize;
+}
+
+void AudioRecorder::finish()
+{
+  // the rest of the ring buffer (less than a block) - it may wrap around:
+  while( !error && readIndex != writeIndex )
+  {
+    uint32_t r   = readIndex;
+    uint32_t pos = r & (bufferSize-1);
+    uint32_t n   = rmin(writeIndex - r, (uint32_t) bufferSize - pos);
+    n = rmin(n, maxDataSize - dataSize);
+    if( n == 0 )
+      break;
+    if( fwrite(&buffer[pos], 1, n, file) != n )
+      error = true;
+    else
+    {
+      dataSize  += n;
+      readIndex  = r + n;
+    }
+  }
+
+  // the sizes in the header, also after an error - the file stays readable up to there:
+  if( fseek(file, 0, SEEK_SET) != 0 || !writeHeader(dataSize) )
+    error = true;
+  if( fclose(file) != 0 )
+    error = true;
+  file  = NULL;
+  state = IDLE;
+}
@@ -0,0 +1,88 @@
+#ifndef rosic_BiquadCascade_h
+#define rosic_BiquadCascade_h
+
+// rosic-indcludes:
+#include "rosic_RealFunctions.h"
+#include "rosic_Complex.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a cascade of second order sections (biquads) in transposed direct form II with a fixed
+  maximum number of stages. It is meant to collapse a chain of time-invariant filters into one
+  object: the stages are set up from the coefficients of the individual filters (a first order
+  filter is a stage with b2 = a2 = 0) and a block is then run through all stages with their 
+  coefficients and states in registers.
+
+  The coefficients follow the convention of BiquadFilter:
+  y[n] = b0*x[n] + b1*x[n-1] + b2*x[n-2] + a1*y[n-1] + a2*y[n-2].
+
+  */
+
+  class BiquadCascade
+  {
+
+  public:
+
+    /** The maximum number of stages. */
+    static const int maxNumStages = 4;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. Creates a cascade without stages (which passes the signal unchanged). */
+    BiquadCascade();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the number of stages (0...maxNumStages) - new stages are set to identity. */
+    void setNumStages(int newNumStages);
+
+    /** Sets the coefficients of one stage. */
+    void setStage(int index, float newB0, float newB1, float newB2, float newA1, float newA2);
+
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the number of stages. */
+    int getNumStages() const { return numStages; }
+
+    /** Returns the complex transfer function of the whole cascade at the normalized radian
+    frequency omega = 2*PI*frequency/sampleRate. */
+    Complex getTransferFunctionAt(float omega) const;
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Filters a block of samples in place. */
+    void processBlock(float *buffer, int length);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Resets the states of all stages to zero. */
+    void reset();
+
+    //=============================================================================================
+
+  protected:
+
+    /** Filters a block through the first N stages. */
+    template<int N>
+    void processStages(float *buffer, int length);
+
+    // the coefficients and states of the stages, one array per variable:
+    float b0[maxNumStages], b1[maxNumStages], b2[maxNumStages];
+    float a1[maxNumStages], a2[maxNumStages];
+    float s1[maxNumStages], s2[maxNumStages];
+    int   numStages;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_BiquadCascade_h
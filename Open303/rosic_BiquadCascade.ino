@@ -0,0 +1,127 @@
+#include "rosic_BiquadCascade.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+BiquadCascade::BiquadCascade()
+{
+  numStages = 0;
+  for(int i=0; i<maxNumStages; i++)
+    setStage(i, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void HOT_CODE BiquadCascade::setNumStages(int newNumStages)
+{
+  newNumStages = clip(newNumStages, 0, maxNumStages);
+  for(int i=numStages; i<newNumStages; i++)
+  {
+    setStage(i, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+    s1[i] = s2[i] = 0.0f;
+  }
+  numStages = newNumStages;
+}
+
+void HOT_CODE BiquadCascade::setStage(int index, float newB0, float newB1, float newB2, float newA1,
+                             float newA2)
+{
+  if( index < 0 || index >= maxNumStages )
+    return;
+  b0[index] = newB0;
+  b1[index] = newB1;
+  b2[index] = newB2;
+  a1[index] = newA1;
+  a2[index] = newA2;
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+Complex BiquadCascade::getTransferFunctionAt(float omega) const
+{
+  // evaluated in double precision - the poles of typical DC blockers are close to z = 1 where the
+  // denominators suffer from cancellation:
+  double w  = omega;
+  double c1 = cos(w),   s1 = -sin(w);     // z^-1
+  double c2 = cos(2*w), s2 = -sin(2*w);   // z^-2
+  double re = 1.0, im = 0.0;
+  for(int i=0; i<numStages; i++)
+  {
+    double nr = b0[i] + b1[i]*c1 + b2[i]*c2;
+    double ni =         b1[i]*s1 + b2[i]*s2;
+    double dr = 1.0 - a1[i]*c1 - a2[i]*c2;
+    double di =     - a1[i]*s1 - a2[i]*s2;
+    double d  = dr*dr + di*di;
+    double hr = (nr*dr + ni*di) / d;
+    double hi = (ni*dr - nr*di) / d;
+    double tr = re*hr - im*hi;
+    im        = re*hi + im*hr;
+    re        = tr;
+  }
+  return Complex((float) re, (float) im);
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE BiquadCascade::processBlock(float *buffer, int length)
+{
+  switch( numStages )
+  {
+  case 1: processStages<1>(buffer, length); break;
+  case 2: processStages<2>(buffer, length); break;
+  case 3: processStages<3>(buffer, length); break;
+  case 4: processStages<4>(buffer, length); break;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+template<int N>
+void HOT_CODE BiquadCascade::processStages(float *buffer, int length)
+{
+  // local copies of the coefficients and states which the compiler can keep in registers - the
+  // stages are computed per sample such that the recursions of successive stages can overlap:
+  float c0[N], c1[N], c2[N], d1[N], d2[N], z1[N], z2[N];
+  #pragma GCC unroll 4
+  for(int i=0; i<N; i++)
+  {
+    c0[i] = b0[i]; c1[i] = b1[i]; c2[i] = b2[i]; d1[i] = a1[i]; d2[i] = a2[i];
+    z1[i] = s1[i]; z2[i] = s2[i];
+  }
+
+  for(int n=0; n<length; n++)
+  {
+    float x = buffer[n];
+    #pragma GCC unroll 4
+    for(int i=0; i<N; i++)
+    {
+      float y = c0[i]*x + z1[i];
+      z1[i]   = c1[i]*x + d1[i]*y + z2[i];
+      z2[i]   = c2[i]*x + d2[i]*y;
+      x       = y;
+    }
+    buffer[n] = x;
+  }
+
+  #pragma GCC unroll 4
+  for(int i=0; i<N; i++)
+  {
+    s1[i] = z1[i];
+    s2[i] = z2[i];
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void HOT_CODE BiquadCascade::reset()
+{
+  for(int i=0; i<maxNumStages; i++)
+    s1[i] = s2[i] = 0.0f;
+}
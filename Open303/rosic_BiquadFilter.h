@@ -75,6 +75,10 @@ namespace rosic
     /** Returns the bandwidth in octaves. */
     float getBandwidth() const { return bandwidth; }
 
+    /** Retrieves the filter coefficients. */
+    void getCoefficients(float *b0Out, float *b1Out, float *b2Out, float *a1Out, float *a2Out) const
+    { *b0Out = b0; *b1Out = b1; *b2Out = b2; *a1Out = a1; *a2Out = a2; }
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
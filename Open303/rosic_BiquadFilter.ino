@@ -180,7 +180,7 @@ void BiquadFilter::calcCoeffs()
   }
 }
 
-void BiquadFilter::reset()
+void HOT_CODE BiquadFilter::reset()
 {
   x1 = 0.0f;
   x2 = 0.0f;
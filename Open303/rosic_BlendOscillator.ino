@@ -74,12 +74,12 @@ void BlendOscillator::setStartPhase(float StartPhase)
 //-------------------------------------------------------------------------------------------------
 // event processing:
 
-void BlendOscillator::resetPhase()
+void HOT_CODE BlendOscillator::resetPhase()
 {
   phaseIndex = startIndex;
 }
 
-void BlendOscillator::setPhase(float PhaseIndex)
+void HOT_CODE BlendOscillator::setPhase(float PhaseIndex)
 {
   phaseIndex = startIndex+PhaseIndex;
 }
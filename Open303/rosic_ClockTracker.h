@@ -0,0 +1,136 @@
+#ifndef rosic_ClockTracker_h
+#define rosic_ClockTracker_h
+
+// rosic-indcludes:
+#include "rosic_RealFunctions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This class follows an incoming MIDI clock (24 ticks per quarter note). The ticks are passed in
+  with a timestamp (in samples) and the period and phase of the clock are estimated by an
+  alpha-beta tracker, which is the steady state form of a Kalman filter for a constant tempo
+  model. The gain is scheduled down from 1 to the loop gain after a (re)start, such that the
+  tracker locks quickly and then smoothes out the jitter of the timestamps (which is typically
+  dominated by the polling of the UART). Ticks that deviate by more than half a period from the
+  prediction (tempo jumps, a paused clock) make the tracker re-acquire.
+
+  From the estimates, the position (in ticks) can be extrapolated to any point in time, which
+  allows to schedule events phase-locked to the clock in sample time.
+
+  The ticks come in on one task (the MIDI input) and the estimates are read on another (the audio
+  task). The estimates are 64 bit doubles which are not written atomically, so they are published
+  with a sequence counter like the sample count of Transport: the inquiry functions always see a
+  consistent set of estimates from one tick, never a torn or half updated one.
+
+  */
+
+  class ClockTracker
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    ClockTracker();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample-rate (needed only for the tempo in BPM). */
+    void setSampleRate(float newSampleRate);
+
+    /** Sets the gain with which the phase error is fed back (0...1) - smaller values smooth out
+    more jitter, larger values follow tempo changes faster. */
+    void setLoopGain(float newGain);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns true when the period has been estimated from at least two ticks. */
+    bool isLocked() const;
+
+    /** Returns true between a start() and the first tick thereafter. */
+    bool isWaitingForStart() const;
+
+    /** Returns the estimated period of the clock in samples per tick (0 if not locked). */
+    double getSamplesPerTick() const;
+
+    /** Returns the estimated speed of the clock in ticks per sample (0 if not locked). */
+    double getTicksPerSample() const;
+
+    /** Returns the estimated tempo in BPM (0 if not locked). */
+    float getTempo() const;
+
+    /** Returns the estimated clock position (in ticks since the last start) at the given time (in
+    samples). Before the first tick after a start, -1 is returned. */
+    double getTickPosition(double time) const;
+
+    /** Like getTickPosition(double), and also returns the speed of the clock (see
+    getTicksPerSample) - both from the same estimates. */
+    double getTickPosition(double time, double &ticksPerSample) const;
+
+    //---------------------------------------------------------------------------------------------
+    // event handling:
+
+    /** Accepts a clock tick that was received at the given time (in samples). */
+    void clockTick(double time);
+
+    /** Accepts a MIDI start - the next tick will be position 0. */
+    void start();
+
+    /** Accepts a MIDI continue - the tick counting goes on from where it was stopped. */
+    void proceed();
+
+    /** Forgets the tempo and the position. */
+    void reset();
+
+    //=============================================================================================
+
+  protected:
+
+    /** The estimates as the readers see them. */
+    struct Estimate
+    {
+      double tickTime;
+      double period;
+      long   tickIndex;
+      bool   locked;
+      bool   startPending;
+    };
+
+    /** Publishes the estimates - called by the writer after each change. */
+    void publish();
+
+    /** Reads a consistent copy of the published estimates. */
+    void read(Estimate &estimate) const;
+
+    /** The position at the given time from a copy of the estimates. */
+    static double tickPosition(const Estimate &estimate, double time);
+
+    // the tracker, used by the writer only:
+    double tickTime;          // the estimated time of the last tick (in samples)
+    double period;            // the estimated samples per tick
+    double lastTime;          // the raw timestamp of the last tick
+    long   tickIndex;         // the position of the last tick since the last start
+    int    numTicks;          // number of ticks received since reset
+    int    numTicksSinceLock; // number of tracked ticks since the last (re)acquisition
+    bool   startPending;      // a start was received, but no tick since
+    float  loopGain;          // alpha of the tracker
+    float  sampleRate;
+
+    // the published estimates, see publish() and read():
+    volatile double   pubTickTime, pubPeriod;
+    volatile long     pubTickIndex;
+    volatile bool     pubLocked, pubStartPending;
+    volatile uint32_t sequence;  // odd while the writer updates the estimates
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_ClockTracker_h
@@ -0,0 +1,207 @@
+#include "rosic_ClockTracker.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+ClockTracker::ClockTracker()
+{
+  sampleRate = SAMPLE_RATE;
+  loopGain   = 0.1f;
+  sequence   = 0;
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void ClockTracker::setSampleRate(float newSampleRate)
+{
+  if( newSampleRate > 0.0f )
+    sampleRate = newSampleRate;
+}
+
+void ClockTracker::setLoopGain(float newGain)
+{
+  loopGain = clip(newGain, 0.001f, 1.0f);
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+bool ClockTracker::isLocked() const
+{
+  Estimate e;
+  read(e);
+  return e.locked;
+}
+
+bool ClockTracker::isWaitingForStart() const
+{
+  Estimate e;
+  read(e);
+  return e.startPending;
+}
+
+double ClockTracker::getSamplesPerTick() const
+{
+  Estimate e;
+  read(e);
+  return e.locked ? e.period : 0.0;
+}
+
+double ClockTracker::getTicksPerSample() const
+{
+  Estimate e;
+  read(e);
+  return e.locked ? 1.0 / e.period : 0.0;
+}
+
+float ClockTracker::getTempo() const
+{
+  Estimate e;
+  read(e);
+  return e.locked ? (float)(2.5 * sampleRate / e.period) : 0.0f;
+}
+
+double ClockTracker::getTickPosition(double time) const
+{
+  Estimate e;
+  read(e);
+  return tickPosition(e, time);
+}
+
+double HOT_CODE ClockTracker::getTickPosition(double time, double &ticksPerSample) const
+{
+  Estimate e;
+  read(e);
+  ticksPerSample = e.locked ? 1.0 / e.period : 0.0;
+  return tickPosition(e, time);
+}
+
+//-------------------------------------------------------------------------------------------------
+// event handling:
+
+void ClockTracker::clockTick(double time)
+{
+  if( startPending )
+  {
+    startPending = false;
+    tickIndex    = 0;
+  }
+  else
+    tickIndex++;
+
+  double interval = time - lastTime;
+  lastTime        = time;
+  numTicks++;
+  if( numTicks == 1 )
+  {
+    tickTime = time;
+    publish();
+    return;
+  }
+
+  if( numTicksSinceLock == 0 )
+  {
+    // acquisition - the first interval is the first estimate of the period:
+    if( interval > 0.0 )
+    {
+      period            = interval;
+      tickTime          = time;
+      numTicksSinceLock = 1;
+    }
+    publish();
+    return;
+  }
+
+  double predicted = tickTime + period;
+  double error     = time - predicted;
+  if( fabs(error) > 0.5 * period )
+  {
+    // tempo jump or paused clock - re-acquire the phase, take the new period only if the
+    // interval is plausible:
+    if( interval > 0.0 && interval < 2.0 * period )
+      period = interval;
+    tickTime          = time;
+    numTicksSinceLock = 1;
+    publish();
+    return;
+  }
+
+  // the gains of a least squares fit over all ticks since the acquisition, until they fall below
+  // the steady state gains:
+  numTicksSinceLock++;
+  double n     = (double) numTicksSinceLock;
+  double alpha = 2.0 * (2.0*n - 1.0) / (n * (n + 1.0));
+  double beta  = 6.0 / (n * (n + 1.0));
+  if( alpha < loopGain )
+  {
+    alpha = loopGain;
+    beta  = alpha * alpha / (2.0 - alpha);
+  }
+  tickTime = predicted + alpha * error;
+  period  += beta * error;
+  publish();
+}
+
+void ClockTracker::start()
+{
+  startPending = true;
+  publish();
+}
+
+void ClockTracker::proceed()
+{
+  startPending = false;
+  publish();
+}
+
+void ClockTracker::reset()
+{
+  tickTime          = 0.0;
+  period            = 0.0;
+  lastTime          = 0.0;
+  tickIndex         = 0;
+  numTicks          = 0;
+  numTicksSinceLock = 0;
+  startPending      = false;
+  publish();
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+void ClockTracker::publish()
+{
+  sequence++;
+  pubTickTime     = tickTime;
+  pubPeriod       = period;
+  pubTickIndex    = tickIndex;
+  pubLocked       = numTicksSinceLock >= 1;
+  pubStartPending = startPending;
+  sequence++;
+}
+
+void HOT_CODE ClockTracker::read(Estimate &estimate) const
+{
+  uint32_t seq;
+  do
+  {
+    seq                   = sequence;
+    estimate.tickTime     = pubTickTime;
+    estimate.period       = pubPeriod;
+    estimate.tickIndex    = pubTickIndex;
+    estimate.locked       = pubLocked;
+    estimate.startPending = pubStartPending;
+  } while( (seq & 1) != 0 || seq != sequence );
+}
+
+double HOT_CODE ClockTracker::tickPosition(const Estimate &estimate, double time)
+{
+  if( estimate.startPending )
+    return -1.0;
+  if( !estimate.locked )
+    return (double) estimate.tickIndex;
+  return (double) estimate.tickIndex + (time - estimate.tickTime) / estimate.period;
+}
@@ -0,0 +1,134 @@
+#ifndef rosic_Compressor_h
+#define rosic_Compressor_h
+
+// rosic-indcludes:
+#include "rosic_RealFunctions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a block-based stereo-linked compressor/limiter for the master bus. The signal is delayed
+  by one block, such that the gain for each block is already known when the block is output
+  (look-ahead). The gain computer works in the log domain (octaves of amplitude) with table-based
+  log2/exp2 approximations and runs only once per block, the gain is linearly interpolated across
+  the samples of the block. So the per-sample cost is fixed: a peak detection, a delay line
+  read/write and a multiplication.
+
+  With zero attack time, the output never exceeds the ceiling - the compressor acts as a brickwall
+  limiter on top of the ratio-based gain reduction above the threshold.
+
+  */
+
+  class Compressor
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    Compressor();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample-rate. */
+    void setSampleRate(float newSampleRate);
+
+    /** Sets the number of samples per processed block - this is also the look-ahead time. Must not
+    exceed maxBlockSize. */
+    void setBlockSize(int newBlockSize);
+
+    /** Sets the threshold above which the gain reduction starts (in dB). */
+    void setThreshold(float newThreshold) { threshold = newThreshold; }
+
+    /** Sets the compression ratio (1 means no compression, values >= 20 approach limiting). */
+    void setRatio(float newRatio);
+
+    /** Sets the attack time (in milliseconds). Zero means instantaneous gain reduction. */
+    void setAttack(float newAttack);
+
+    /** Sets the release time (in milliseconds). */
+    void setRelease(float newRelease);
+
+    /** Sets the gain applied after the compression (in dB). */
+    void setMakeUpGain(float newMakeUpGain);
+
+    /** Sets the maximum output level (in dB) that will never be exceeded when attack is zero. */
+    void setCeiling(float newCeiling) { ceiling = newCeiling; }
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the threshold (in dB). */
+    float getThreshold() const { return threshold; }
+
+    /** Returns the compression ratio. */
+    float getRatio() const { return ratio; }
+
+    /** Returns the attack time (in milliseconds). */
+    float getAttack() const { return attackTime; }
+
+    /** Returns the release time (in milliseconds). */
+    float getRelease() const { return releaseTime; }
+
+    /** Returns the make-up gain (in dB). */
+    float getMakeUpGain() const { return makeUpGain; }
+
+    /** Returns the ceiling (in dB). */
+    float getCeiling() const { return ceiling; }
+
+    /** Returns the current gain reduction (in dB, a positive value means reduction). */
+    float getGainReduction() const { return -DB_PER_OCTAVE * fast_log2(gain + TINY); }
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Processes one block of blockSize interleaved stereo frames (left, right, left, ...) in
+    place. The output is delayed by blockSize frames. */
+    void processBlock(float *frames);
+
+    /** Like processBlock(float*), but the output is written as 16 bit frames (the I2S format),
+    clipped to the 16 bit range - this saves the conversion pass over the block. */
+    void processBlock(const float *frames, int16_t *pcm);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Clears the look-ahead buffers and resets the gain. */
+    void reset();
+
+    static const int maxBlockSize = 128;
+
+    //=============================================================================================
+
+  protected:
+
+    /** Re-calculates the per-block smoothing coefficients. */
+    void calculateCoefficients();
+
+    /** Runs the gain computer on an incoming block and returns the gain ramp (including the
+    make-up gain) for the delayed block: the gain before its first frame and the increment per
+    frame. */
+    void calculateGainRamp(const float *frames, float *start, float *increment);
+
+    float threshold, ratio, attackTime, releaseTime, makeUpGain, ceiling; // user parameters
+    float slope;           // 1 - 1/ratio: gain reduction per dB above threshold
+    float makeUpFactor;    // make-up gain as raw factor
+    float attackCoeff;     // per-block smoothing coefficients
+    float releaseCoeff;
+    float gain;            // gain at the end of the previous block
+    float prevRequired;    // required gain of the block that is currently in the delay line
+    float sampleRate;
+    int   blockSize;
+
+    float delay[2*maxBlockSize]; // look-ahead buffer, interleaved like the frames
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_Compressor_h
@@ -0,0 +1,168 @@
+#include "rosic_Compressor.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+Compressor::Compressor()
+{
+  sampleRate   = SAMPLE_RATE;
+  blockSize    = DMA_BUF_LEN;
+  threshold    = -12.0f;
+  ceiling      =  -0.3f;
+  attackTime   =   0.0f;
+  releaseTime  = 120.0f;
+  setRatio(4.0f);
+  setMakeUpGain(0.0f);
+  calculateCoefficients();
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void Compressor::setSampleRate(float newSampleRate)
+{
+  if( newSampleRate > 0.0f )
+  {
+    sampleRate = newSampleRate;
+    calculateCoefficients();
+  }
+}
+
+void Compressor::setBlockSize(int newBlockSize)
+{
+  if( newBlockSize > 0 && newBlockSize <= maxBlockSize )
+  {
+    blockSize = newBlockSize;
+    calculateCoefficients();
+    reset();
+  }
+}
+
+void Compressor::setRatio(float newRatio)
+{
+  if( newRatio >= 1.0f )
+  {
+    ratio = newRatio;
+    slope = 1.0f - 1.0f/ratio;
+  }
+}
+
+void Compressor::setAttack(float newAttack)
+{
+  if( newAttack >= 0.0f )
+  {
+    attackTime = newAttack;
+    calculateCoefficients();
+  }
+}
+
+void Compressor::setRelease(float newRelease)
+{
+  if( newRelease >= 0.0f )
+  {
+    releaseTime = newRelease;
+    calculateCoefficients();
+  }
+}
+
+void Compressor::setMakeUpGain(float newMakeUpGain)
+{
+  makeUpGain   = newMakeUpGain;
+  makeUpFactor = dB2amp(makeUpGain);
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE Compressor::processBlock(float *frames)
+{
+  float g, inc, tmp;
+  calculateGainRamp(frames, &g, &inc);
+  for(int i=0; i<2*blockSize; i+=2)
+  {
+    g           += inc;
+    tmp          = frames[i];
+    frames[i]    = g * delay[i];
+    delay[i]     = tmp;
+    tmp          = frames[i+1];
+    frames[i+1]  = g * delay[i+1];
+    delay[i+1]   = tmp;
+  }
+}
+
+void HOT_CODE Compressor::processBlock(const float *frames, int16_t *pcm)
+{
+  float g, inc;
+  calculateGainRamp(frames, &g, &inc);
+  for(int i=0; i<2*blockSize; i+=2)
+  {
+    g          += inc;
+    pcm[i]      = (int16_t) (32767.0f * clip(g * delay[i],   -1.0f, 1.0f));
+    pcm[i+1]    = (int16_t) (32767.0f * clip(g * delay[i+1], -1.0f, 1.0f));
+    delay[i]    = frames[i];
+    delay[i+1]  = frames[i+1];
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void Compressor::reset()
+{
+  for(int i=0; i<2*maxBlockSize; i++)
+    delay[i] = 0.0f;
+  gain         = 1.0f;
+  prevRequired = 1.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+void Compressor::calculateCoefficients()
+{
+  // coefficients of one-pole smoothers that are updated once per block:
+  if( attackTime > 0.0f )
+    attackCoeff = 1.0f - expf( -1000.0f * (float)blockSize / (attackTime*sampleRate) );
+  else
+    attackCoeff = 1.0f;
+
+  if( releaseTime > 0.0f )
+    releaseCoeff = 1.0f - expf( -1000.0f * (float)blockSize / (releaseTime*sampleRate) );
+  else
+    releaseCoeff = 1.0f;
+}
+
+void HOT_CODE Compressor::calculateGainRamp(const float *frames, float *start, float *increment)
+{
+  // peak of the incoming block (the one that will be output with the next call):
+  float peak = 0.0f;
+  for(int i=0; i<2*blockSize; i++)
+    peak = fmaxf(peak, fabsf(frames[i]));
+
+  // gain computer in the log domain - once per block:
+  float levelDb   = DB_PER_OCTAVE * fast_log2(peak + TINY);
+  float reduction = 0.0f;
+  if( levelDb > threshold )
+    reduction = slope * (levelDb - threshold);
+  float overCeiling = levelDb - reduction + makeUpGain - ceiling;
+  if( overCeiling > 0.0f )
+    reduction += overCeiling;
+  float required = fast_exp2(-OCTAVES_PER_DB * reduction);
+
+  // the delayed block must satisfy its own requirement and must already ramp towards the
+  // requirement of the upcoming one:
+  float target = fminf(prevRequired, required);
+  prevRequired = required;
+  float newGain;
+  if( target < gain )
+    newGain = gain + attackCoeff  * (target - gain);
+  else
+    newGain = gain + releaseCoeff * (target - gain);
+
+  // the ramp for the delayed block (the caller pushes the incoming block into the delay line):
+  *start     = gain * makeUpFactor;
+  *increment = (newGain - gain) / (float)blockSize * makeUpFactor;
+  gain       = newGain;
+}
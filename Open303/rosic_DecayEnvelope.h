@@ -43,12 +43,21 @@ namespace rosic
     integrator's impulse response. */
     void setNormalizeSum(bool shouldNormalizeSum);
 
+    /** Sets the internal state (the previous output). */
+    void setState(float newState) { y = newState; }
+
     //---------------------------------------------------------------------------------------------
     // inquiry:
 
     /** Returns the length of the decay phase (in milliseconds). */
     float getDecayTimeConstant() const { return tau; }
 
+    /** Returns the coefficient for the multiplicative accumulation. */
+    float getCoefficient() const { return c; }
+
+    /** Returns the internal state (the previous output). */
+    float getState() const { return y; }
+
     /** True, if output is below some threshold. */
     bool endIsReached(float threshold);  
 
@@ -32,7 +32,7 @@ void DecayEnvelope::setSampleRate(float newSampleRate)
   }
 }
 
-void DecayEnvelope::setDecayTimeConstant(float newTimeConstant)
+void HOT_CODE DecayEnvelope::setDecayTimeConstant(float newTimeConstant)
 {
   if( newTimeConstant > 0.001 ) // at least 0.001 ms decay
   {
@@ -50,7 +50,7 @@ void DecayEnvelope::setNormalizeSum(bool shouldNormalizeSum)
 //-------------------------------------------------------------------------------------------------
 // others:
 
-void DecayEnvelope::trigger()
+void HOT_CODE DecayEnvelope::trigger()
 {
   y = yInit;
 }
@@ -66,7 +66,7 @@ bool DecayEnvelope::endIsReached(float threshold)
 //-------------------------------------------------------------------------------------------------
 // internal functions:
 
-void DecayEnvelope::calculateCoefficient()
+void HOT_CODE DecayEnvelope::calculateCoefficient()
 {
   c     = exp( -1.0 / (0.001*tau*fs) );
   if( normalizeSum == true )
@@ -0,0 +1,114 @@
+#ifndef rosic_DrumSampler_h
+#define rosic_DrumSampler_h
+
+// rosic-indcludes:
+#include "rosic_SampleBank.h"
+#include "rosic_RealFunctions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a sample player for drum sounds with a fixed pool of voices. The voices read the 16 bit
+  samples directly from a (memory mapped) SampleBank - nothing is copied. Each voice has its own
+  pitch (playback rate) and gain and the voices are mixed block-wise into an output buffer.
+  Retriggering a sample that is still playing reuses its voice, when no voice is free, the oldest
+  one is stolen.
+
+  The voices belong to the audio processing: noteOn() only prepares a trigger and puts it into a
+  lock-free single-producer single-consumer queue, processBlock() starts the queued triggers at
+  the beginning of the block. So noteOn() may be called from another task than processBlock(), but
+  always from the same one (the MIDI input). When the queue is full, the trigger is dropped.
+
+  */
+
+  class DrumSampler
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    DrumSampler();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample-rate at which the sampler runs. */
+    void setSampleRate(float newSampleRate);
+
+    /** Sets the bank that the samples are played from (may be NULL). */
+    void setSampleBank(const SampleBank* newBank);
+
+    /** Sets the overall volume (in dB). */
+    void setVolume(float newVolume);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the number of samples in the bank. */
+    int getNumSamples() const { return bank != NULL ? bank->getNumSamples() : 0; }
+
+    /** Returns the overall volume (in dB). */
+    float getVolume() const { return volume; }
+
+    /** Returns the number of voices that are currently playing. */
+    int getNumActiveVoices() const;
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Starts the voices of the queued triggers and adds the output of all playing voices to the
+    buffer. */
+    void processBlock(float *buffer, int length);
+
+    //---------------------------------------------------------------------------------------------
+    // event handling:
+
+    /** Starts playback of a sample with given velocity (1...127) and pitch offset (in
+    semitones) with the next processBlock(). */
+    void noteOn(int sampleIndex, int velocity, float pitch = 0.0f);
+
+    /** Stops all voices immediately and forgets the queued triggers - not to be called while
+    processBlock() runs. */
+    void allNotesOff();
+
+    static const int numVoices = 8;
+
+    /** The number of triggers the queue can hold (a power of 2). */
+    static const int triggerQueueSize = 16;
+
+    //=============================================================================================
+
+  protected:
+
+    struct Voice
+    {
+      const int16_t* data;      // points into the memory mapped bank, NULL when the voice is free
+      uint64_t       phase;     // read position as 32.32 fixed point number
+      uint64_t       increment; // phase increment per output sample
+      uint32_t       remaining; // output samples until the last position that can be interpolated
+      float          gain;      // velocity and volume, includes the 1/32768 int16 scaling
+      int            sample;    // index of the sample in the bank
+      uint32_t       age;       // trigger counter value for voice stealing
+    };
+
+    /** Starts a voice for a trigger, called from processBlock(). */
+    void startVoice(const Voice &trigger);
+
+    Voice             voices[numVoices];
+    Voice             triggers[triggerQueueSize]; // set up by noteOn, phase and age are unused
+    uint32_t          triggerWrite, triggerRead;  // accessed atomically
+    const SampleBank  *bank;
+    float             sampleRate;
+    float             volume, volumeFactor;
+    uint32_t          triggerCounter;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_DrumSampler_h
@@ -0,0 +1,163 @@
+#include "rosic_DrumSampler.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+DrumSampler::DrumSampler()
+{
+  bank           = NULL;
+  sampleRate     = SAMPLE_RATE;
+  triggerCounter = 0;
+  triggerWrite   = 0;
+  triggerRead    = 0;
+  setVolume(0.0f);
+  allNotesOff();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void DrumSampler::setSampleRate(float newSampleRate)
+{
+  if( newSampleRate > 0.0f )
+    sampleRate = newSampleRate;
+}
+
+void DrumSampler::setSampleBank(const SampleBank* newBank)
+{
+  allNotesOff();
+  bank = newBank;
+}
+
+void DrumSampler::setVolume(float newVolume)
+{
+  volume       = newVolume;
+  volumeFactor = dB2amp(volume);
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+int DrumSampler::getNumActiveVoices() const
+{
+  int n = 0;
+  for(int v=0; v<numVoices; v++)
+    if( voices[v].data != NULL )
+      n++;
+  return n;
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE DrumSampler::processBlock(float *buffer, int length)
+{
+  // the triggers that came in since the last block - the slot is freed after the voice took it:
+  uint32_t r = triggerRead;
+  while( r != __atomic_load_n(&triggerWrite, __ATOMIC_ACQUIRE) )
+  {
+    startVoice(triggers[r & (triggerQueueSize-1)]);
+    __atomic_store_n(&triggerRead, ++r, __ATOMIC_RELEASE);
+  }
+
+  const float fracScale = 1.0f / 4294967296.0f;
+  for(int v=0; v<numVoices; v++)
+  {
+    Voice &voice = voices[v];
+    const int16_t* data = voice.data;
+    if( data == NULL )
+      continue;
+
+    // number of samples that can be rendered before the end is reached - this keeps the end check
+    // out of the inner loop:
+    int n = voice.remaining < (uint32_t)length ? (int)voice.remaining : length;
+
+    uint64_t phase = voice.phase;
+    uint64_t inc   = voice.increment;
+    float    gain  = voice.gain;
+    for(int i=0; i<n; i++)
+    {
+      uint32_t idx  = (uint32_t)(phase >> 32);
+      float    frac = (float)(uint32_t)phase * fracScale;
+      float    s0   = (float)data[idx];
+      buffer[i]    += gain * (s0 + frac * ((float)data[idx+1] - s0));
+      phase        += inc;
+    }
+    voice.phase      = phase;
+    voice.remaining -= n;
+
+    if( n < length )
+      voice.data = NULL; // sample has ended
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// event handling:
+
+void DrumSampler::noteOn(int sampleIndex, int velocity, float pitch)
+{
+  if( bank == NULL || sampleIndex < 0 || sampleIndex >= bank->getNumSamples() || velocity <= 0 )
+    return;
+  uint32_t w = triggerWrite;
+  if( w - __atomic_load_n(&triggerRead, __ATOMIC_ACQUIRE) >= (uint32_t) triggerQueueSize )
+    return; // the queue is full, the trigger is dropped
+
+  // the trigger is set up completely here, so processBlock only has to pick a voice for it - the
+  // number of samples to play is counted down there, the division stays out of the audio code:
+  Voice &trigger    = triggers[w & (triggerQueueSize-1)];
+  float rate        = pitchOffsetToFreqFactor(pitch) * bank->getSampleRate(sampleIndex) / sampleRate;
+  trigger.phase     = 0;
+  trigger.increment = (uint64_t)((double)rate * 4294967296.0);
+  if( trigger.increment == 0 )
+    trigger.increment = 1;
+  uint64_t end      = (uint64_t)(bank->getSampleLength(sampleIndex) - 1) << 32; // > 0, see SampleBank
+  uint64_t samples  = (end - 1) / trigger.increment + 1;
+  trigger.remaining = samples < 0xFFFFFFFF ? (uint32_t)samples : 0xFFFFFFFF;
+  trigger.gain      = volumeFactor * (float)velocity * MIDI_NORM * (1.0f / 32768.0f);
+  trigger.sample    = sampleIndex;
+  trigger.age       = 0;
+  trigger.data      = bank->getSampleData(sampleIndex);
+  __atomic_store_n(&triggerWrite, w + 1, __ATOMIC_RELEASE); // publishes the trigger
+}
+
+void DrumSampler::allNotesOff()
+{
+  for(int v=0; v<numVoices; v++)
+  {
+    voices[v].data      = NULL;
+    voices[v].phase     = 0;
+    voices[v].increment = 1;
+    voices[v].remaining = 0;
+    voices[v].gain      = 0.0f;
+    voices[v].sample    = -1;
+    voices[v].age       = 0;
+  }
+  triggerRead = __atomic_load_n(&triggerWrite, __ATOMIC_ACQUIRE);
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+void HOT_CODE DrumSampler::startVoice(const Voice &trigger)
+{
+  // reuse the voice that plays this sample already, otherwise take a free or the oldest voice:
+  int chosen = -1, oldest = 0;
+  for(int v=0; v<numVoices; v++)
+  {
+    if( voices[v].data != NULL && voices[v].sample == trigger.sample )
+    {
+      chosen = v;
+      break;
+    }
+    if( chosen < 0 && voices[v].data == NULL )
+      chosen = v;
+    if( voices[v].age < voices[oldest].age )
+      oldest = v;
+  }
+  if( chosen < 0 )
+    chosen = oldest;
+
+  voices[chosen]     = trigger;
+  voices[chosen].age = triggerCounter++;
+}
@@ -0,0 +1,139 @@
+#ifndef rosic_DrumSynth_h
+#define rosic_DrumSynth_h
+
+// rosic-indcludes:
+#include "rosic_DecayEnvelope.h"
+#include "rosic_BiquadFilter.h"
+#include "rosic_OnePoleFilter.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a synthesizer for the 6 drum parts of a basic groove (kick, snare, closed and open hat,
+  percussion and crash) which needs no sample memory. Kick and percussion are sines with a decaying
+  pitch sweep, the snare mixes such a tone with filtered noise and the hats and the crash are noise
+  through a one-pole filter for the colour and a resonant biquad. Each part is a single monophonic
+  voice with an exponentially decaying amplitude, the closed hat chokes the open one.
+
+  The voices are rendered block-wise and share a block of white noise that is generated only once
+  per block. Voices that have decayed are skipped.
+
+  */
+
+  class DrumSynth
+  {
+
+  public:
+
+    /** Enumeration of the drum parts - the order matches the note offsets inside an AcidBanger
+    drum kit. */
+    enum parts
+    {
+      KICK = 0,
+      SNARE,
+      CLOSED_HAT,
+      OPEN_HAT,
+      PERCUSSION,
+      CRASH,
+
+      NUM_PARTS
+    };
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    DrumSynth();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample-rate at which the drums run. */
+    void setSampleRate(float newSampleRate);
+
+    /** Sets the overall volume (in dB). */
+    void setVolume(float newVolume);
+
+    /** Sets the amplitude decay time constant of one of the parts (in milliseconds). */
+    void setDecay(int part, float newDecay);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the overall volume (in dB). */
+    float getVolume() const { return volume; }
+
+    /** Returns the amplitude decay time constant of one of the parts (in milliseconds). */
+    float getDecay(int part) const;
+
+    /** Returns the number of parts that are currently sounding. */
+    int getNumActiveVoices() const;
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Adds the output of all sounding parts to the buffer. */
+    void processBlock(float *buffer, int length);
+
+    //---------------------------------------------------------------------------------------------
+    // event handling:
+
+    /** Triggers one of the parts with given velocity (1...127). */
+    void noteOn(int part, int velocity);
+
+    /** Silences all parts immediately. */
+    void allNotesOff();
+
+    static const int maxBlockSize = 128;
+
+    //=============================================================================================
+
+  protected:
+
+    /** A sine with an exponential pitch sweep from freq+sweep down to freq. */
+    struct Tone
+    {
+      DecayEnvelope ampEnv, pitchEnv;
+      float         freq, sweep;  // end frequency and initial frequency offset in Hz
+      float         phase;        // in radians
+      float         gain;
+      bool          active;
+    };
+
+    /** Coloured and resonantly filtered noise. */
+    struct Noise
+    {
+      DecayEnvelope ampEnv;
+      OnePoleFilter colour;
+      BiquadFilter  resonator;
+      float         gain;
+      bool          active;
+    };
+
+    /** Adds a block of the tone to the buffer. */
+    void renderTone(Tone &tone, float *buffer, int length);
+
+    /** Adds a block of the filtered shared noise to the buffer. */
+    void renderNoise(Noise &voice, float *buffer, int length);
+
+    /** Triggers the envelopes and sets the gain of a tone. */
+    void triggerTone(Tone &tone, float gain);
+
+    /** Triggers the envelope and sets the gain of a noise. */
+    void triggerNoise(Noise &voice, float gain);
+
+    Tone  kick, snareTone, perc;
+    Noise snareNoise, closedHat, openHat, crash;
+
+    float    noise[maxBlockSize];   // white noise shared by all noise voices
+    uint32_t noiseState;
+    float    sampleRate;
+    float    volume, volumeFactor;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_DrumSynth_h
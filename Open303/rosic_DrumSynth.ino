@@ -0,0 +1,265 @@
+#include "rosic_DrumSynth.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+DrumSynth::DrumSynth()
+{
+  sampleRate = SAMPLE_RATE;
+  noiseState = 0x12345678;
+  setVolume(-6.0f);
+
+  kick.freq  = 48.0f;
+  kick.sweep = 160.0f;
+  kick.ampEnv.setDecayTimeConstant(280.0f);
+  kick.pitchEnv.setDecayTimeConstant(28.0f);
+
+  snareTone.freq  = 180.0f;
+  snareTone.sweep = 70.0f;
+  snareTone.ampEnv.setDecayTimeConstant(55.0f);
+  snareTone.pitchEnv.setDecayTimeConstant(12.0f);
+
+  perc.freq  = 190.0f;
+  perc.sweep = 110.0f;
+  perc.ampEnv.setDecayTimeConstant(130.0f);
+  perc.pitchEnv.setDecayTimeConstant(45.0f);
+
+  snareNoise.ampEnv.setDecayTimeConstant(90.0f);
+  snareNoise.colour.setMode(OnePoleFilter::LOWPASS);
+  snareNoise.colour.setCutoff(9000.0f);
+  snareNoise.resonator.setMode(BiquadFilter::HIGHPASS12);
+  snareNoise.resonator.setFrequency(1400.0f);
+  snareNoise.resonator.setGain(3.0f);
+
+  closedHat.ampEnv.setDecayTimeConstant(22.0f);
+  closedHat.colour.setMode(OnePoleFilter::HIGHPASS);
+  closedHat.colour.setCutoff(4000.0f);
+  closedHat.resonator.setMode(BiquadFilter::HIGHPASS12);
+  closedHat.resonator.setFrequency(8000.0f);
+  closedHat.resonator.setGain(9.0f);
+
+  openHat.ampEnv.setDecayTimeConstant(200.0f);
+  openHat.colour.setMode(OnePoleFilter::HIGHPASS);
+  openHat.colour.setCutoff(4000.0f);
+  openHat.resonator.setMode(BiquadFilter::HIGHPASS12);
+  openHat.resonator.setFrequency(7500.0f);
+  openHat.resonator.setGain(9.0f);
+
+  crash.ampEnv.setDecayTimeConstant(800.0f);
+  crash.colour.setMode(OnePoleFilter::LOWPASS);
+  crash.colour.setCutoff(12000.0f);
+  crash.resonator.setMode(BiquadFilter::HIGHPASS12);
+  crash.resonator.setFrequency(4500.0f);
+  crash.resonator.setGain(4.0f);
+
+  allNotesOff();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void DrumSynth::setSampleRate(float newSampleRate)
+{
+  if( newSampleRate <= 0.0f )
+    return;
+  sampleRate = newSampleRate;
+
+  Tone* tones[3] = { &kick, &snareTone, &perc };
+  for(int i=0; i<3; i++)
+  {
+    tones[i]->ampEnv.setSampleRate(sampleRate);
+    tones[i]->pitchEnv.setSampleRate(sampleRate);
+  }
+  Noise* noises[4] = { &snareNoise, &closedHat, &openHat, &crash };
+  for(int i=0; i<4; i++)
+  {
+    noises[i]->ampEnv.setSampleRate(sampleRate);
+    noises[i]->colour.setSampleRate(sampleRate);
+    noises[i]->resonator.setSampleRate(sampleRate);
+  }
+}
+
+void DrumSynth::setVolume(float newVolume)
+{
+  volume       = newVolume;
+  volumeFactor = dB2amp(volume);
+}
+
+void DrumSynth::setDecay(int part, float newDecay)
+{
+  switch( part )
+  {
+  case KICK:       kick.ampEnv.setDecayTimeConstant(newDecay);       break;
+  case SNARE:
+    {
+      snareTone.ampEnv.setDecayTimeConstant(0.6f * newDecay);
+      snareNoise.ampEnv.setDecayTimeConstant(newDecay);
+    }
+    break;
+  case CLOSED_HAT: closedHat.ampEnv.setDecayTimeConstant(newDecay);  break;
+  case OPEN_HAT:   openHat.ampEnv.setDecayTimeConstant(newDecay);    break;
+  case PERCUSSION: perc.ampEnv.setDecayTimeConstant(newDecay);       break;
+  case CRASH:      crash.ampEnv.setDecayTimeConstant(newDecay);      break;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+float DrumSynth::getDecay(int part) const
+{
+  switch( part )
+  {
+  case KICK:       return kick.ampEnv.getDecayTimeConstant();
+  case SNARE:      return snareNoise.ampEnv.getDecayTimeConstant();
+  case CLOSED_HAT: return closedHat.ampEnv.getDecayTimeConstant();
+  case OPEN_HAT:   return openHat.ampEnv.getDecayTimeConstant();
+  case PERCUSSION: return perc.ampEnv.getDecayTimeConstant();
+  case CRASH:      return crash.ampEnv.getDecayTimeConstant();
+  default:         return 0.0f;
+  }
+}
+
+int DrumSynth::getNumActiveVoices() const
+{
+  return (int)kick.active + (int)snareTone.active + (int)perc.active + (int)snareNoise.active
+    + (int)closedHat.active + (int)openHat.active + (int)crash.active;
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE DrumSynth::processBlock(float *buffer, int length)
+{
+  while( length > 0 )
+  {
+    int n = length < maxBlockSize ? length : maxBlockSize;
+
+    // one block of white noise for all noise voices:
+    if( snareNoise.active || closedHat.active || openHat.active || crash.active )
+    {
+      uint32_t state = noiseState;
+      for(int i=0; i<n; i++)
+      {
+        state    = 1664525*state + 1013904223;
+        noise[i] = (float)(int32_t)state * (1.0f / 2147483648.0f);
+      }
+      noiseState = state;
+    }
+
+    renderTone(kick,       buffer, n);
+    renderTone(snareTone,  buffer, n);
+    renderTone(perc,       buffer, n);
+    renderNoise(snareNoise, buffer, n);
+    renderNoise(closedHat,  buffer, n);
+    renderNoise(openHat,    buffer, n);
+    renderNoise(crash,      buffer, n);
+
+    buffer += n;
+    length -= n;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// event handling:
+
+void DrumSynth::noteOn(int part, int velocity)
+{
+  if( velocity <= 0 )
+    return;
+  float gain = volumeFactor * (float)velocity * MIDI_NORM;
+  switch( part )
+  {
+  case KICK:
+    triggerTone(kick, gain);
+    break;
+  case SNARE:
+    {
+      triggerTone(snareTone, 0.5f * gain);
+      triggerNoise(snareNoise, 0.4f * gain);
+    }
+    break;
+  case CLOSED_HAT:
+    {
+      openHat.active = false; // choke
+      triggerNoise(closedHat, 0.5f * gain);
+    }
+    break;
+  case OPEN_HAT:
+    triggerNoise(openHat, 0.4f * gain);
+    break;
+  case PERCUSSION:
+    triggerTone(perc, 0.6f * gain);
+    break;
+  case CRASH:
+    triggerNoise(crash, 0.35f * gain);
+    break;
+  }
+}
+
+void DrumSynth::allNotesOff()
+{
+  kick.active       = false;
+  snareTone.active  = false;
+  perc.active       = false;
+  snareNoise.active = false;
+  closedHat.active  = false;
+  openHat.active    = false;
+  crash.active      = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+void HOT_CODE DrumSynth::renderTone(Tone &tone, float *buffer, int length)
+{
+  if( !tone.active )
+    return;
+  float omega = TWOPI / sampleRate;
+  float phase = tone.phase;
+  for(int i=0; i<length; i++)
+  {
+    phase += omega * (tone.freq + tone.sweep * tone.pitchEnv.getSample());
+    if( phase >= TWOPI )
+      phase -= TWOPI;
+    buffer[i] += tone.gain * tone.ampEnv.getSample() * fast_sin(phase);
+  }
+  tone.phase = phase;
+  if( tone.ampEnv.endIsReached(0.001f) )
+    tone.active = false;
+}
+
+void HOT_CODE DrumSynth::renderNoise(Noise &voice, float *buffer, int length)
+{
+  if( !voice.active )
+    return;
+  for(int i=0; i<length; i++)
+  {
+    float tmp  = voice.resonator.getSample(voice.colour.getSample(noise[i]));
+    buffer[i] += voice.gain * voice.ampEnv.getSample() * tmp;
+  }
+  if( voice.ampEnv.endIsReached(0.001f) )
+    voice.active = false;
+}
+
+void DrumSynth::triggerTone(Tone &tone, float gain)
+{
+  tone.ampEnv.trigger();
+  tone.pitchEnv.trigger();
+  tone.phase  = 0.0f;
+  tone.gain   = gain;
+  tone.active = true;
+}
+
+void DrumSynth::triggerNoise(Noise &voice, float gain)
+{
+  if( !voice.active )
+  {
+    voice.colour.reset();
+    voice.resonator.reset();
+  }
+  voice.ampEnv.trigger();
+  voice.gain   = gain;
+  voice.active = true;
+}
@@ -12,7 +12,7 @@ EllipticQuarterBandFilter::EllipticQuarterBandFilter()
 //-------------------------------------------------------------------------------------------------
 // parameter settings:
 
-void EllipticQuarterBandFilter::reset()
+void HOT_CODE EllipticQuarterBandFilter::reset()
 {
   for(int i=0; i<12; i++)
     w[i] = 0.0f;
@@ -56,7 +56,8 @@ namespace rosic
     //---------------------------------------------------------------------------------------------
     // parameter settings:
 
-    /** FFT-size, has to be a power of 2 and >= 2. */
+    /** FFT-size, has to be a power of 2 and >= 2. When the buffers for it can't be allocated, the
+    previous size is kept - without any, the transforms leave their outputs alone. */
     void setBlockSize(int newBlockSize);     
 
     /** Sets the direction of the transform (@see: directions). This will affect the sign of the 
@@ -23,11 +23,11 @@ FourierTransformerRadix2::~FourierTransformerRadix2()
 {
   // free dynamically allocated memory:
   if( w != NULL )
-    delete[] w;
+    bulkFree(w);
   if( ip != NULL )
-    delete[] ip;
+    bulkFree(ip);
   if( tmpBuffer != NULL )
-    delete[] tmpBuffer;
+    bulkFree(tmpBuffer);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -42,22 +42,36 @@ void FourierTransformerRadix2::setBlockSize(int newBlockSize)
     // unnecesarry re-allocations and re-computations:
     if( newBlockSize != N )
     {
-      N    = newBlockSize;
-      logN = (int) floor( log2((float) N + 0.5 ) );
-      updateNormalizationFactor();
+      // the twiddle factors and the scratch buffer are only touched when a transform is computed,
+      // so they are bulk memory (PSRAM if available) - when we run out of it, the previous 
+      // blocksize and buffers are kept:
+      float*   newW   = (float*)   bulkMalloc(2*newBlockSize*sizeof(float));
+      int*     newIp  = (int*)     bulkMalloc(((int) ceil(4.0+sqrt((float)newBlockSize)))*sizeof(int));
+      Complex* newTmp = (Complex*) bulkMalloc(newBlockSize*sizeof(Complex));
+      if( newW == NULL || newIp == NULL || newTmp == NULL )
+      {
+        bulkFree(newW);
+        bulkFree(newIp);
+        bulkFree(newTmp);
+        return;
+      }
 
       if( w != NULL )
-        delete[] w;
-      w    = new float[2*N];
-
+        bulkFree(w);
       if( ip != NULL )
-        delete[] ip;
-      ip    = new int[(int) ceil(4.0+sqrt((float)N))];
-      ip[0] = 0; // indicate that re-initialization is necesarry
-
+        bulkFree(ip);
       if( tmpBuffer != NULL )
-        delete[] tmpBuffer;
-      tmpBuffer = new Complex[N];
+        bulkFree(tmpBuffer);
+      w         = newW;
+      ip        = newIp;
+      tmpBuffer = newTmp;
+      ip[0]     = 0; // indicate that re-initialization is necesarry
+      for(int n=0; n<newBlockSize; n++)
+        tmpBuffer[n] = Complex(0.0f, 0.0f);
+
+      N    = newBlockSize;
+      logN = (int) floor( log2((float) N + 0.5 ) );
+      updateNormalizationFactor();
     }
   }
   else if( !isPowerOfTwo(newBlockSize) || newBlockSize <= 1 )
@@ -94,7 +108,8 @@ void FourierTransformerRadix2::setNormalizationMode(int newNormalizationMode)
 
 void FourierTransformerRadix2::setRealSignalMode(bool willBeUsedForRealSignals)
 {
-  ip[0] = 0; // retriggers twiddle-factor computation
+  if( ip != NULL )
+    ip[0] = 0; // retriggers twiddle-factor computation
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -102,6 +117,9 @@ void FourierTransformerRadix2::setRealSignalMode(bool willBeUsedForRealSignals)
 
 void FourierTransformerRadix2::transformComplexBufferInPlace(Complex *buffer)
 {
+  if( N == 0 )
+    return; // no buffers (out of memory)
+
   // retrieve the adresses of the real part of the first array entries in order to treat the 
   // Complex arrays as arrays of two successive float-numbers:
   float* d_buffer = &(buffer[0].re);
@@ -124,6 +142,9 @@ void FourierTransformerRadix2::transformComplexBufferInPlace(Complex *buffer)
 
 void FourierTransformerRadix2::transformComplexBuffer(Complex *inBuffer, Complex *outBuffer)
 {
+  if( N == 0 )
+    return; // no buffers (out of memory)
+
   // retrieve the adresses of the real part of the first array entries in order to treat the 
   // Complex arrays as arrays of two successive float-numbers:
   float* d_inBuffer  = &(inBuffer[0].re);
@@ -156,6 +177,9 @@ void FourierTransformerRadix2::transformComplexBuffer(Complex *inBuffer, Complex
 
 void FourierTransformerRadix2::transformRealSignal(float *inSignal, Complex *outSpectrum)
 {
+  if( N == 0 )
+    return; // no buffers (out of memory)
+
   setDirection(FORWARD);
 
   // retrieve the adress of the real part of the first array entry of the output array in order to
@@ -194,6 +218,9 @@ void FourierTransformerRadix2::transformRealSignal(float *signal, float *reAndIm
 void FourierTransformerRadix2::getRealSignalMagnitudesAndPhases(float *signal, 
                                                                 float *magnitudes, float *phases)
 {
+  if( N == 0 )
+    return; // no buffers (out of memory)
+
   transformRealSignal(signal, tmpBuffer);
 
   // store the two purely real transform values at DC and Nyquist-frequency in the first fields of 
@@ -219,6 +246,9 @@ void FourierTransformerRadix2::getRealSignalMagnitudesAndPhases(float *signal,
 
 void FourierTransformerRadix2::getRealSignalMagnitudes(float *signal, float *magnitudes)
 {
+  if( N == 0 )
+    return; // no buffers (out of memory)
+
   transformRealSignal(signal, tmpBuffer);
   magnitudes[0] = tmpBuffer[0].re;
 
@@ -235,6 +265,9 @@ void FourierTransformerRadix2::getRealSignalMagnitudes(float *signal, float *mag
 
 void FourierTransformerRadix2::transformSymmetricSpectrum(Complex *inSpectrum, float *outSignal)
 {
+  if( N == 0 )
+    return; // no buffers (out of memory)
+
   setDirection(INVERSE);
 
   // retrieve the adress of the real part of the first array entry of the output array in order to
@@ -273,6 +306,9 @@ void FourierTransformerRadix2::getRealSignalFromMagnitudesAndPhases(float *magni
                                                                     float *phases, 
                                                                     float *signal)
 {
+  if( N == 0 )
+    return; // no buffers (out of memory)
+
   tmpBuffer[0].re = magnitudes[0];
   tmpBuffer[0].im = phases[0];
 
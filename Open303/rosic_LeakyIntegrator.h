@@ -46,6 +46,12 @@ namespace rosic
     /** Returns the time constant (tau) in milliseconds. */
     float getTimeConstant() const { return tau; }
 
+    /** Returns the filter coefficient. */
+    float getCoefficient() const { return coeff; }
+
+    /** Returns the internal state of the filter (the previous output sample). */
+    float getState() const { return y1; }
+
     /** Returns the normalizer, required to normalize the impulse response of a series connection 
     of two digital RC-type filters with time constants tau1 and tau2 (in milliseconds) to unity at 
     the given samplerate. */
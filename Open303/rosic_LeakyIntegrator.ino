@@ -30,7 +30,7 @@ void LeakyIntegrator::setSampleRate(float newSampleRate)
   }
 }
 
-void LeakyIntegrator::setTimeConstant(float newTimeConstant)
+void HOT_CODE LeakyIntegrator::setTimeConstant(float newTimeConstant)
 {
   if( newTimeConstant >= 0.0 && newTimeConstant != tau )
   {
@@ -42,7 +42,7 @@ void LeakyIntegrator::setTimeConstant(float newTimeConstant)
 //-------------------------------------------------------------------------------------------------
 // inquiry:
 
-float LeakyIntegrator::getNormalizer(float tau1, float tau2, float fs)
+float HOT_CODE LeakyIntegrator::getNormalizer(float tau1, float tau2, float fs)
 {
   float td = 0.001*tau1;
   float ta = 0.001*tau2;
@@ -94,12 +94,12 @@ float LeakyIntegrator::getNormalizer(float tau1, float tau2, float fs)
 //-------------------------------------------------------------------------------------------------
 // others:
 
-void LeakyIntegrator::reset()
+void HOT_CODE LeakyIntegrator::reset()
 {
   y1 = 0;
 }
 
-void LeakyIntegrator::calculateCoefficient()
+void HOT_CODE LeakyIntegrator::calculateCoefficient()
 {
   if( tau > 0.0 )
     coeff = exp( -1.0 / (sampleRate*0.001*tau)  );
@@ -0,0 +1,146 @@
+#ifndef rosic_MidiOutput_h
+#define rosic_MidiOutput_h
+
+#include <stdint.h>
+
+namespace rosic
+{
+
+  /**
+
+  This is the queue in front of a MIDI output port: the tasks that send MIDI only put messages
+  into it, which takes no time, and the port is fed from it in small portions by whoever services
+  the UART, so nobody waits for the 1 ms that a message takes at 31250 baud.
+
+  Each source (the local sequencer, the MIDI thru) has its own lock-free single-producer
+  single-consumer queues - one for messages and one for realtime bytes - so different tasks can
+  send at the same time. The producer writes the message first and publishes it by advancing the
+  write index, the consumer only reads up to that index.
+
+  The consumer side (read) turns the messages into the byte stream:
+  - realtime bytes (clock, start, stop, ...) have priority: they are put out before the next byte
+    of any message, even in the middle of one (which MIDI allows), so the clock has no jitter from
+    the notes
+  - running status: the status byte of a channel message is left out when it equals the previous
+    one. When the queues run empty, the running status is forgotten, so after a pause the status
+    is always sent again (receivers that missed it, e.g. after being plugged in, resync quickly)
+  - the messages of the sources are interleaved message by message, round robin
+
+  A message that doesn't fit into its queue is dropped and counted.
+
+  */
+
+  class MidiOutput
+  {
+
+  public:
+
+    /** The sources of messages, each one must send from a single task. */
+    enum sources
+    {
+      LOCAL = 0,   // the local sequencer (jukebox)
+      THRU,        // forwarded input
+
+      NUM_SOURCES
+    };
+
+    /** The number of messages a message queue can hold (a power of 2). */
+    static const int messageQueueSize = 64;
+
+    /** The number of bytes a realtime queue can hold (a power of 2). */
+    static const int realtimeQueueSize = 16;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    MidiOutput();
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the number of messages and realtime bytes that were dropped because a queue was
+    full. */
+    uint32_t getNumDropped() const { return numDropped; }
+
+    /** Returns true when there is nothing left to send. */
+    bool isEmpty() const;
+
+    //---------------------------------------------------------------------------------------------
+    // sending (producer side):
+
+    /** Queues a channel or system common message (not SysEx) - the number of data bytes follows
+    from the status. Returns false when the message was dropped. */
+    bool send(uint8_t status, uint8_t data1 = 0, uint8_t data2 = 0, int source = LOCAL);
+
+    /** Queues a realtime byte (0xF8...0xFF). */
+    bool sendRealTime(uint8_t status, int source = LOCAL);
+
+    /** Queues a note on, channel 1...16. */
+    bool sendNoteOn(int channel, int key, int velocity, int source = LOCAL)
+    { return send(channelStatus(0x90, channel), key & 0x7F, velocity & 0x7F, source); }
+
+    /** Queues a note off - as a note on with zero velocity, which continues the running status
+    of the note ons. */
+    bool sendNoteOff(int channel, int key, int source = LOCAL)
+    { return send(channelStatus(0x90, channel), key & 0x7F, 0, source); }
+
+    /** Queues a control change. */
+    bool sendControlChange(int channel, int controller, int value, int source = LOCAL)
+    { return send(channelStatus(0xB0, channel), controller & 0x7F, value & 0x7F, source); }
+
+    /** Queues a program change. */
+    bool sendProgramChange(int channel, int program, int source = LOCAL)
+    { return send(channelStatus(0xC0, channel), program & 0x7F, 0, source); }
+
+    /** Queues a pitch bend (-8192...8191). */
+    bool sendPitchBend(int channel, int value, int source = LOCAL)
+    {
+      value += 8192;
+      return send(channelStatus(0xE0, channel), value & 0x7F, (value >> 7) & 0x7F, source);
+    }
+
+    //---------------------------------------------------------------------------------------------
+    // reading (consumer side):
+
+    /** Writes up to maxBytes of the outgoing byte stream to buffer and returns the number of
+    bytes written. */
+    int read(uint8_t *buffer, int maxBytes);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Returns the number of bytes of a message with the given status (0 for SysEx and undefined
+    ones). */
+    static int getMessageLength(uint8_t status);
+
+    //=============================================================================================
+
+  protected:
+
+    /** Returns the status byte of a channel message, channel 1...16. */
+    static uint8_t channelStatus(uint8_t type, int channel)
+    { return (uint8_t) (type | ((channel - 1) & 0x0F)); }
+
+    /** Takes the next message from the sources (round robin), returns false if there is none. */
+    bool nextMessage();
+
+    // the queues, messages are packed as status | data1 << 8 | data2 << 16:
+    uint32_t          messages[NUM_SOURCES][messageQueueSize];
+    uint8_t           realtime[NUM_SOURCES][realtimeQueueSize];
+    volatile uint32_t messageWrite[NUM_SOURCES], messageRead[NUM_SOURCES];
+    volatile uint32_t realtimeWrite[NUM_SOURCES], realtimeRead[NUM_SOURCES];
+    volatile uint32_t numDropped;
+
+    // the consumer state:
+    uint32_t current;         // the message being put out
+    int      currentPos;      // the next byte of it
+    int      currentLength;
+    uint8_t  runningStatus;   // 0: none
+    int      nextSource;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_MidiOutput_h
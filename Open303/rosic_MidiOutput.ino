@@ -0,0 +1,150 @@
+#include "rosic_MidiOutput.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+MidiOutput::MidiOutput()
+{
+  for(int s=0; s<NUM_SOURCES; s++)
+  {
+    messageWrite[s]  = messageRead[s]  = 0;
+    realtimeWrite[s] = realtimeRead[s] = 0;
+  }
+  numDropped    = 0;
+  current       = 0;
+  currentPos    = 0;
+  currentLength = 0;
+  runningStatus = 0;
+  nextSource    = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+bool MidiOutput::isEmpty() const
+{
+  if( currentPos < currentLength )
+    return false;
+  for(int s=0; s<NUM_SOURCES; s++)
+  {
+    if( messageWrite[s] != messageRead[s] || realtimeWrite[s] != realtimeRead[s] )
+      return false;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// sending (producer side):
+
+bool MidiOutput::send(uint8_t status, uint8_t data1, uint8_t data2, int source)
+{
+  if( source < 0 || source >= NUM_SOURCES || getMessageLength(status) == 0 )
+    return false;
+  if( status >= 0xF8 )
+    return sendRealTime(status, source);
+  uint32_t w = messageWrite[source];
+  if( w - messageRead[source] >= (uint32_t) messageQueueSize )
+  {
+    numDropped++;
+    return false;
+  }
+  messages[source][w & (messageQueueSize-1)] = status | (data1 << 8) | (data2 << 16);
+  messageWrite[source] = w + 1;   // publishes the message
+  return true;
+}
+
+bool MidiOutput::sendRealTime(uint8_t status, int source)
+{
+  if( source < 0 || source >= NUM_SOURCES || status < 0xF8 )
+    return false;
+  uint32_t w = realtimeWrite[source];
+  if( w - realtimeRead[source] >= (uint32_t) realtimeQueueSize )
+  {
+    numDropped++;
+    return false;
+  }
+  realtime[source][w & (realtimeQueueSize-1)] = status;
+  realtimeWrite[source] = w + 1;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// reading (consumer side):
+
+int MidiOutput::read(uint8_t *buffer, int maxBytes)
+{
+  int n = 0;
+  while( n < maxBytes )
+  {
+    // realtime bytes go first, wherever the message stream is:
+    bool realtimeSent = false;
+    for(int s=0; s<NUM_SOURCES && !realtimeSent; s++)
+    {
+      uint32_t r = realtimeRead[s];
+      if( r != realtimeWrite[s] )
+      {
+        buffer[n++]     = realtime[s][r & (realtimeQueueSize-1)];
+        realtimeRead[s] = r + 1;
+        realtimeSent    = true;
+      }
+    }
+    if( realtimeSent )
+      continue;
+
+    if( currentPos >= currentLength && !nextMessage() )
+    {
+      runningStatus = 0;   // idle: the next message sends its status again
+      break;
+    }
+    buffer[n++] = (uint8_t) (current >> (8*currentPos));
+    currentPos++;
+  }
+  return n;
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+int MidiOutput::getMessageLength(uint8_t status)
+{
+  if( status < 0x80 )
+    return 0;
+  if( status < 0xF0 )
+  {
+    uint8_t type = status & 0xF0;
+    return (type == 0xC0 || type == 0xD0) ? 2 : 3;
+  }
+  switch( status )
+  {
+  case 0xF1:
+  case 0xF3: return 2;
+  case 0xF2: return 3;
+  case 0xF6: return 1;
+  default:   return status >= 0xF8 ? 1 : 0;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+bool MidiOutput::nextMessage()
+{
+  for(int k=0; k<NUM_SOURCES; k++)
+  {
+    int      s = nextSource;
+    uint32_t r = messageRead[s];
+    nextSource = (nextSource + 1) % NUM_SOURCES;
+    if( r == messageWrite[s] )
+      continue;
+    current        = messages[s][r & (messageQueueSize-1)];
+    messageRead[s] = r + 1;   // frees the slot
+
+    uint8_t status = (uint8_t) current;
+    currentLength  = getMessageLength(status);
+    currentPos     = (status < 0xF0 && status == runningStatus) ? 1 : 0;
+    runningStatus  = status < 0xF0 ? status : 0;   // system common cancels the running status
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,149 @@
+#ifndef rosic_MidiParser_h
+#define rosic_MidiParser_h
+
+#include <stdint.h>
+
+namespace rosic
+{
+
+  /** A complete MIDI message with the time at which its first byte arrived. */
+  struct MidiMessage
+  {
+    double  time;    // in samples (see Transport::getSampleTime)
+    uint8_t status;  // 0x80...0xFF, 0xF0 for a complete SysEx (see MidiParser::getSysExData)
+    uint8_t data1;
+    uint8_t data2;
+    uint8_t length;  // number of bytes including the status byte (for SysEx: 1)
+
+    /** Returns the channel (1...16) of a channel message. */
+    int getChannel() const { return (status & 0x0F) + 1; }
+
+    /** Returns the message type of a channel message (0x80, 0x90, ... 0xE0). */
+    int getType() const { return status & 0xF0; }
+  };
+
+  /**
+
+  This is a parser for a MIDI 1.0 byte stream, fed byte by byte as the bytes arrive at the UART,
+  each with its arrival time. It handles running status, realtime bytes (0xF8...0xFF) that are
+  interleaved anywhere - even between the data bytes of another message or inside a SysEx - and
+  system exclusive messages, which are collected into a buffer of fixed size (longer ones are
+  truncated). Stray data bytes without a status are ignored, a SysEx that is ended by another
+  status byte instead of 0xF7 is dropped.
+
+  A message is stamped with the arrival time of its first byte (the status byte or, under running
+  status, the first data byte), realtime messages with their own arrival time.
+
+  */
+
+  class MidiParser
+  {
+
+  public:
+
+    /** The maximum length of a SysEx (without 0xF0 and 0xF7). */
+    static const int maxSysExLength = 64;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    MidiParser();
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the data of the last complete SysEx (valid until the next call to parse). */
+    const uint8_t* getSysExData() const { return sysEx; }
+
+    /** Returns the length of the last complete SysEx. */
+    int getSysExLength() const { return sysExLength; }
+
+    /** Returns true when the last complete SysEx was longer than maxSysExLength. */
+    bool isSysExTruncated() const { return sysExTruncated; }
+
+    //---------------------------------------------------------------------------------------------
+    // event handling:
+
+    /** Parses the next byte of the stream, which arrived at the given time (in samples). Returns
+    true when the byte completes a message, which is then written to message. */
+    bool parse(uint8_t byte, double time, MidiMessage &message);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Forgets the running status and any message in progress. */
+    void reset();
+
+    //=============================================================================================
+
+  protected:
+
+    /** Returns the number of data bytes that follow a status byte (-1 for undefined ones). */
+    static int getNumDataBytes(uint8_t status);
+
+    double  messageTime;     // arrival of the first byte of the message in progress
+    uint8_t status;          // status of the message in progress, 0: none
+    uint8_t data[2];
+    int     numData;         // data bytes received so far
+    int     numExpected;     // data bytes the message needs
+    bool    started;         // the first byte of the message has arrived
+    bool    inSysEx;
+    bool    sysExTruncated;
+    int     sysExLength;
+    uint8_t sysEx[maxSysExLength];
+
+  };
+
+  /**
+
+  This is a lock-free single-producer single-consumer queue of MidiMessages, which takes the
+  messages from the task that parses the input to the audio task that handles them. The producer
+  writes the message first and publishes it by advancing the write index, the consumer only reads
+  up to that index. A message that doesn't fit into the queue is dropped and counted. The data of
+  a SysEx stays in the parser, it isn't queued.
+
+  */
+
+  class MidiMessageQueue
+  {
+
+  public:
+
+    /** The number of messages the queue can hold (a power of 2). */
+    static const int queueSize = 64;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    MidiMessageQueue();
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the number of messages that were dropped because the queue was full. */
+    uint32_t getNumDropped() const { return numDropped; }
+
+    //---------------------------------------------------------------------------------------------
+    // producer and consumer side:
+
+    /** Queues a message, returns false when it was dropped. */
+    bool write(const MidiMessage &message);
+
+    /** Takes the oldest message from the queue, returns false when there is none. */
+    bool read(MidiMessage &message);
+
+    //=============================================================================================
+
+  protected:
+
+    MidiMessage       messages[queueSize];
+    uint32_t          writeIndex, readIndex;  // accessed atomically
+    volatile uint32_t numDropped;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_MidiParser_h
@@ -0,0 +1,172 @@
+#include "rosic_MidiParser.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+MidiParser::MidiParser()
+{
+  sysExLength    = 0;
+  sysExTruncated = false;
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// event handling:
+
+bool MidiParser::parse(uint8_t byte, double time, MidiMessage &message)
+{
+  // realtime bytes are complete by themselves and leave the state alone:
+  if( byte >= 0xF8 )
+  {
+    message.time   = time;
+    message.status = byte;
+    message.data1  = message.data2 = 0;
+    message.length = 1;
+    return true;
+  }
+
+  if( byte == 0xF0 )
+  {
+    inSysEx        = true;
+    sysExLength    = 0;
+    sysExTruncated = false;
+    messageTime    = time;
+    status         = 0;      // SysEx cancels the running status
+    return false;
+  }
+
+  if( byte == 0xF7 )
+  {
+    if( !inSysEx )
+      return false;
+    inSysEx        = false;
+    message.time   = messageTime;
+    message.status = 0xF0;
+    message.data1  = message.data2 = 0;
+    message.length = 1;
+    return true;
+  }
+
+  if( byte & 0x80 )
+  {
+    // any other status byte ends an unterminated SysEx (which is dropped) and starts a message:
+    inSysEx     = false;
+    numExpected = getNumDataBytes(byte);
+    numData     = 0;
+    status      = numExpected < 0 ? 0 : byte;
+    messageTime = time;
+    started     = status != 0;
+    if( numExpected == 0 )   // tune request
+    {
+      message.time   = time;
+      message.status = byte;
+      message.data1  = message.data2 = 0;
+      message.length = 1;
+      status         = 0;    // system common messages cancel the running status
+      started        = false;
+      return true;
+    }
+    return false;
+  }
+
+  // data byte:
+  if( inSysEx )
+  {
+    if( sysExLength < maxSysExLength )
+      sysEx[sysExLength++] = byte;
+    else
+      sysExTruncated = true;
+    return false;
+  }
+  if( status == 0 )
+    return false;            // no status to refer to
+  if( !started )
+  {
+    messageTime = time;      // running status: the message starts with this byte
+    started     = true;
+  }
+  data[numData++] = byte;
+  if( numData < numExpected )
+    return false;
+
+  message.time   = messageTime;
+  message.status = status;
+  message.data1  = data[0];
+  message.data2  = numExpected > 1 ? data[1] : 0;
+  message.length = (uint8_t) (numExpected + 1);
+  numData        = 0;
+  started        = false;
+  if( status >= 0xF0 )
+    status = 0;              // system common messages cancel the running status
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void MidiParser::reset()
+{
+  messageTime = 0.0;
+  status      = 0;
+  data[0]     = data[1] = 0;
+  numData     = 0;
+  numExpected = 0;
+  started     = false;
+  inSysEx     = false;
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+int MidiParser::getNumDataBytes(uint8_t status)
+{
+  switch( status & 0xF0 )
+  {
+  case 0xC0:
+  case 0xD0: return 1;       // program change, channel pressure
+  case 0xF0:
+    switch( status )
+    {
+    case 0xF1:
+    case 0xF3: return 1;     // time code quarter frame, song select
+    case 0xF2: return 2;     // song position
+    case 0xF6: return 0;     // tune request
+    default:   return -1;    // undefined (0xF4, 0xF5)
+    }
+  default:   return 2;       // note off/on, poly pressure, control change, pitch bend
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// MidiMessageQueue:
+
+MidiMessageQueue::MidiMessageQueue()
+{
+  writeIndex = 0;
+  readIndex  = 0;
+  numDropped = 0;
+}
+
+bool MidiMessageQueue::write(const MidiMessage &message)
+{
+  uint32_t w = writeIndex;
+  if( w - __atomic_load_n(&readIndex, __ATOMIC_ACQUIRE) >= (uint32_t) queueSize )
+  {
+    numDropped++;
+    return false;
+  }
+  messages[w & (queueSize-1)] = message;
+  __atomic_store_n(&writeIndex, w + 1, __ATOMIC_RELEASE); // publishes the message
+  return true;
+}
+
+bool HOT_CODE MidiMessageQueue::read(MidiMessage &message)
+{
+  uint32_t r = readIndex;
+  if( r == __atomic_load_n(&writeIndex, __ATOMIC_ACQUIRE) )
+    return false;
+  message = messages[r & (queueSize-1)];
+  __atomic_store_n(&readIndex, r + 1, __ATOMIC_RELEASE); // frees the slot
+  return true;
+}
@@ -13,6 +13,13 @@ namespace rosic
   This is a class for generating and storing a single-cycle-waveform in a lookup-table and 
   retrieving values form it at arbitrary positions by means of interpolation.
 
+  The mip-map is read per sample and is a member (and thus lives wherever the object lives, which 
+  should be internal RAM). The prototype waveform is rendered into a separate buffer in bulk memory
+  (PSRAM, see bulkMalloc) and copied into the mip-map in one go, such that a playing oscillator 
+  never reads a half-rendered waveform. With NO_PSRAM (or when the buffer can't be allocated), the 
+  prototype is rendered in place into the first table of the mip-map instead. The spectrum that the
+  mip-map is generated from is bulk memory, too - without it, the tables aren't band-limited.
+
   */
 
   class MipMappedWaveTable
@@ -35,7 +42,8 @@ namespace rosic
       SQUARE,
       SAW,
       SQUARE303,
-      SAW303
+      SAW303,
+      USER       // set from outside by setWaveform(float*, int) or setMipMap(), not rendered
     };
 
     //---------------------------------------------------------------------------------------------
@@ -56,13 +64,19 @@ namespace rosic
     void setWaveform(int newWaveform);
 
     /** Overloaded function to set the waveform form outside this class. This function expects a 
-    pointer to the prototype-waveform to be handed over along with the length of this waveform. It 
-    copies the values into the internal buffers and renders various bandlimited version via 
-    FFT/iFFT.
-    \todo: Interpolation for the case that lengthInSamples does not match the length of the 
-    internal table-length. */
+    pointer to the prototype-waveform (one cycle) to be handed over along with the length of this 
+    waveform. It copies the values into the internal buffers and renders various bandlimited 
+    version via FFT/iFFT. When the length differs from the internal table-length, the cycle is 
+    resampled to it by periodic sinc-interpolation (see resample()), so single cycles of any length 
+    (like the 600 samples of the AKWF collection) can be used. */
     void setWaveform(float* newWaveform, int lengthInSamples);
 
+    /** Sets the whole mip-map at once from getMipMapSize() values (table by table, as written by
+    getMipMap()) in 16 bit, which are multiplied by scale. Nothing is rendered, so this is cheap 
+    enough to switch between precomputed waveforms (see WaveBank). The first table also becomes 
+    the prototype-table. */
+    void setMipMap(const int16_t *data, float scale);
+
     /** Sets the time symmetry between the first and second half-wave (as value between 0...1) - 
     for a square wave, this is also known as pulse-width. Currently only implemented for square and 
     saw waveforms. */
@@ -100,6 +114,19 @@ namespace rosic
     - this is important when the two are mixed. */
     float get303SquarePhaseShift() const { return squarePhaseShift; }
 
+    /** Returns the length of each table of the mip-map. */
+    static int getTableLength() { return tableLength; }
+
+    /** Returns the number of tables in the mip-map, one per octave. */
+    static int getNumTables() { return numTables; }
+
+    /** Returns the number of values in the mip-map (without the additional samples for the 
+    interpolator) - the size of the data for getMipMap() and setMipMap(). */
+    static int getMipMapSize() { return numTables*tableLength; }
+
+    /** Copies the mip-map into data (getMipMapSize() values, table by table). */
+    void getMipMap(float *data) const;
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
@@ -145,6 +172,12 @@ namespace rosic
     /** Renders the prototype waveform and generates the mip-map from that. */
     void renderWaveform();
 
+    /** Resamples one cycle of a waveform of arbitrary length into the prototype-table by periodic 
+    sinc-interpolation: the harmonics of the cycle are found by a DFT (the length needn't be a 
+    power of 2) and transformed back at the table-length. Harmonics that don't fit below the 
+    Nyquist frequency of the table are dropped. */
+    void resample(const float *newWaveform, int length);
+
     void generateMipMap();
       // generates a multisample from the prototype table, where each of the
       // successive tables contains one half of the spectrum of the previous one
@@ -166,9 +199,9 @@ namespace rosic
     int    waveform;   // index of the currently chosen native waveform
     float sampleRate; // the sampleRate
 
-    float prototypeTable[tableLength+4];
-      // this is the prototype-table with full bandwidth. one additional sample (same as 
-      // prototypeTable[0]) for linear interpolation without need for table wraparound at the last 
+    float *prototypeTable;
+      // this is the prototype-table with full bandwidth (in bulk memory or tableSet[0], see above). 
+      // one additional sample (same as prototypeTable[0]) for linear interpolation without need for table wraparound at the last 
       // sample (-> saves one if-statement each audio-cycle) ...and a three further addtional 
       // samples for more elaborate interpolations like cubic (not implemented yet, also:
       // the fillWith...()-functions don't support these samples yet). */
@@ -180,6 +213,10 @@ namespace rosic
       // accesses the second version which is bandlimited to Nyquist/2, 2->Nyquist/4, 
       // 3->Nyquist/8, etc. */
 
+    float *spectrum;
+      // the spectrum of the prototype-table while the mip-map is generated (or a cycle resampled),
+      // in bulk memory (NULL when it can't be allocated)
+
     // embedded objects:
     FourierTransformerRadix2 fourierTransformer;
 
@@ -16,14 +16,26 @@ MipMappedWaveTable::MipMappedWaveTable()
   // set up the fourier-transformer:
   fourierTransformer.setBlockSize(tableLength);
 
+  // allocate the prototype-table, render in place if we are short of memory:
+#ifdef NO_PSRAM
+  prototypeTable = tableSet[0];
+#else
+  prototypeTable = (float*) bulkMalloc((tableLength+4)*sizeof(float));
+  if( prototypeTable == NULL )
+    prototypeTable = tableSet[0];
+#endif
+  spectrum = (float*) bulkMalloc(tableLength*sizeof(float));
+
   // initialize the buffers:
-  initPrototypeTable();
   initTableSet();
+  initPrototypeTable();
 }
 
 MipMappedWaveTable::~MipMappedWaveTable()
 {
-
+  if( prototypeTable != tableSet[0] )
+    bulkFree(prototypeTable);
+  bulkFree(spectrum);
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -39,11 +51,35 @@ void MipMappedWaveTable::setWaveform(float* newWaveForm, int lengthInSamples)
     for( i=0; i<tableLength; i++ )
       prototypeTable[i] = newWaveForm[i];
   }
+  else if( lengthInSamples > 1 && spectrum != NULL )
+    resample(newWaveForm, lengthInSamples);
   else
+    return;
+  waveform = USER;
+  generateMipMap();
+}
+
+void MipMappedWaveTable::setMipMap(const int16_t *data, float scale)
+{
+  for(int t=0; t<numTables; t++)
   {
-    // implement periodic sinc-interpolation here...
+    for(int i=0; i<tableLength; i++)
+      tableSet[t][i] = scale * data[t*tableLength+i];
+
+    // additional sample(s) for the interpolator:
+    tableSet[t][tableLength]   = tableSet[t][0];
+    tableSet[t][tableLength+1] = tableSet[t][1];
+    tableSet[t][tableLength+2] = tableSet[t][2];
+    tableSet[t][tableLength+3] = tableSet[t][3];
   }
-  generateMipMap();
+
+  // the full bandwidth table is the prototype of the mip-map:
+  if( prototypeTable != tableSet[0] )
+  {
+    for(int i=0; i<tableLength+4; i++)
+      prototypeTable[i] = tableSet[0][i];
+  }
+  waveform = USER;
 }
 
 void MipMappedWaveTable::setWaveform(int newWaveform)
@@ -61,6 +97,16 @@ void MipMappedWaveTable::setSymmetry(float newSymmetry)
   renderWaveform();
 }
 
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+void MipMappedWaveTable::getMipMap(float *data) const
+{
+  for(int t=0; t<numTables; t++)
+    for(int i=0; i<tableLength; i++)
+      data[t*tableLength+i] = tableSet[t][i];
+}
+
 //-------------------------------------------------------------------------------------------------
 // internal functions:
 
@@ -129,6 +175,7 @@ void MipMappedWaveTable::renderWaveform()
   case   SAW:       fillWithSaw();         break;
   case   SQUARE303: fillWithSquare303();   break;
   case   SAW303:    fillWithSaw303();      break;
+  case   USER:                             break; // keeps the table that was set
 
   default :  fillWithSine();
   }
@@ -136,19 +183,20 @@ void MipMappedWaveTable::renderWaveform()
 
 void MipMappedWaveTable::generateMipMap()
 {
-  static float spectrum[tableLength];
   //static int    position, offset;
-  static int t, i; // indices for the table and position
+  int t, i; // indices for the table and position
 
   //position = 0;             // begin of the 1st table (index 0)
   //offset   = tableLength+4; // offset between tow tables, the 4 is the number
   // of additional samples used for interpolation
 
-  // copy the prototypeTable into the 1st table of the mipmap (this actually makes the
-  // prototypeTable redundant - room for optimization here):
+  // copy the prototypeTable into the 1st table of the mipmap (unless it was rendered in place):
   t = 0;
-  for(i=0; i<tableLength; i++)
-    tableSet[0][i] = prototypeTable[i];
+  if( prototypeTable != tableSet[0] )
+  {
+    for(i=0; i<tableLength; i++)
+      tableSet[0][i] = prototypeTable[i];
+  }
 
   // additional sample(s) for the interpolator:
   tableSet[t][tableLength]   = tableSet[t][0];
@@ -156,6 +204,15 @@ void MipMappedWaveTable::generateMipMap()
   tableSet[t][tableLength+2] = tableSet[t][2];
   tableSet[t][tableLength+3] = tableSet[t][3];
 
+  // out of memory - the other tables repeat the full bandwidth one (which aliases):
+  if( spectrum == NULL )
+  {
+    for(t=1; t<numTables; t++)
+      for(i=0; i<tableLength+4; i++)
+        tableSet[t][i] = tableSet[0][i];
+    return;
+  }
+
   // get the spectrum from the prototype-table:
   fourierTransformer.transformRealSignal(prototypeTable, spectrum);
 
@@ -188,6 +245,50 @@ void MipMappedWaveTable::generateMipMap()
   }
 }
 
+void MipMappedWaveTable::resample(const float *newWaveform, int length)
+{
+  int i, n;
+  for(i=0; i<tableLength; i++)
+    spectrum[i] = 0.0;
+
+  // the DFT of the cycle, scaled to what the FFT of the same cycle at the table-length would give:
+  double scale = (double) tableLength / length;
+  double sum   = 0.0;
+  for(n=0; n<length; n++)
+    sum += newWaveform[n];
+  spectrum[0] = (float) (scale*sum);
+
+  int numHarmonics = rmin((length-1)/2, tableLength/2-1);
+  for(int h=1; h<=numHarmonics; h++)
+  {
+    // the phasor exp(-i*2*pi*h*n/length) is rotated instead of calling sin/cos for each n:
+    double wRe = cos(2.0*PI*h/length), wIm = -sin(2.0*PI*h/length);
+    double pRe = 1.0, pIm = 0.0, re = 0.0, im = 0.0, tmp;
+    for(n=0; n<length; n++)
+    {
+      re  += newWaveform[n]*pRe;
+      im  += newWaveform[n]*pIm;
+      tmp  = pRe*wRe - pIm*wIm;
+      pIm  = pRe*wIm + pIm*wRe;
+      pRe  = tmp;
+    }
+    spectrum[2*h]   = (float) (scale*re);
+    spectrum[2*h+1] = (float) (scale*im);
+  }
+
+  // the Nyquist frequency of an even length is a cosine, half of it goes to the positive 
+  // frequencies:
+  if( length%2 == 0 && length/2 < tableLength/2 )
+  {
+    sum = 0.0;
+    for(n=0; n<length; n++)
+      sum += (n%2 == 0) ? newWaveform[n] : -newWaveform[n];
+    spectrum[length] = (float) (0.5*scale*sum);
+  }
+
+  fourierTransformer.transformSymmetricSpectrum(spectrum, prototypeTable);
+}
+
 //-------------------------------------------------------------------------------------------------
 // fill the prototype-table with various standard waveforms:
 
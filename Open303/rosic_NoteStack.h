@@ -0,0 +1,101 @@
+#ifndef rosic_NoteStack_h
+#define rosic_NoteStack_h
+
+#include <stdint.h>
+
+namespace rosic
+{
+
+  /**
+
+  This is a stack of the currently held MIDI notes for a monophonic instrument. It decides which
+  of the held notes sounds (the most recent, the lowest or the highest one) and which note to
+  return to when that one is released.
+
+  It has one slot per MIDI key, so it never allocates: the held keys form a doubly linked list in
+  the order in which they were pressed (for last note priority) and a bit mask (for low and high
+  note priority). Pushing and removing a key are O(1), pushing a key that is already held moves
+  it to the top.
+
+  */
+
+  class NoteStack
+  {
+
+  public:
+
+    /** Enumeration of the note priorities. */
+    enum priorities
+    {
+      LAST_NOTE = 0,
+      LOW_NOTE,
+      HIGH_NOTE,
+
+      NUM_PRIORITIES
+    };
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    NoteStack();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Selects which of the held notes has priority @see priorities. */
+    void setPriority(int newPriority);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the selected note priority @see priorities. */
+    int getPriority() const { return priority; }
+
+    /** Returns true when no note is held. */
+    bool isEmpty() const { return numNotes == 0; }
+
+    /** Returns the number of held notes. */
+    int getNumNotes() const { return numNotes; }
+
+    /** Returns true when the given key is held. */
+    bool contains(int key) const
+    { return key >= 0 && key < numKeys && (held[key >> 5] & ((uint32_t)1 << (key & 31))) != 0; }
+
+    /** Returns the key of the held note that has priority, -1 if no note is held. */
+    int getKey() const;
+
+    /** Returns the velocity of the held note that has priority, 0 if no note is held. */
+    int getVelocity() const;
+
+    //---------------------------------------------------------------------------------------------
+    // event handling:
+
+    /** Adds a note (or moves it to the top, if it is already held). */
+    void push(int key, int velocity);
+
+    /** Removes a note, if it is held. */
+    void remove(int key);
+
+    /** Removes all notes. */
+    void clear();
+
+    static const int numKeys = 128;
+
+    //=============================================================================================
+
+  protected:
+
+    int8_t   next[numKeys];      // the next older held key, -1 at the end
+    int8_t   prev[numKeys];      // the next newer held key, -1 at the top
+    uint8_t  velocity[numKeys];  // velocities of the held keys
+    uint32_t held[numKeys / 32]; // one bit per held key
+    int      top;                // the most recent key, -1 if empty
+    int      numNotes;
+    int      priority;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_NoteStack_h
@@ -0,0 +1,92 @@
+#include "rosic_NoteStack.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+NoteStack::NoteStack()
+{
+  priority = LAST_NOTE;
+  clear();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void NoteStack::setPriority(int newPriority)
+{
+  if( newPriority >= 0 && newPriority < NUM_PRIORITIES )
+    priority = newPriority;
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+int NoteStack::getKey() const
+{
+  if( numNotes == 0 )
+    return -1;
+
+  int w;
+  switch( priority )
+  {
+  case LOW_NOTE:
+    for(w=0; held[w] == 0; w++);
+    return 32*w + __builtin_ctz(held[w]);
+  case HIGH_NOTE:
+    for(w=numKeys/32-1; held[w] == 0; w--);
+    return 32*w + 31 - __builtin_clz(held[w]);
+  default:
+    return top;
+  }
+}
+
+int NoteStack::getVelocity() const
+{
+  int key = getKey();
+  return key >= 0 ? velocity[key] : 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// event handling:
+
+void NoteStack::push(int key, int newVelocity)
+{
+  if( key < 0 || key >= numKeys )
+    return;
+  remove(key);
+
+  next[key] = (int8_t) top;
+  prev[key] = -1;
+  if( top >= 0 )
+    prev[top] = (int8_t) key;
+  top = key;
+
+  velocity[key]   = (uint8_t) newVelocity;
+  held[key >> 5] |= (uint32_t)1 << (key & 31);
+  numNotes++;
+}
+
+void NoteStack::remove(int key)
+{
+  if( !contains(key) )
+    return;
+
+  if( prev[key] >= 0 )
+    next[prev[key]] = next[key];
+  else
+    top = next[key];
+  if( next[key] >= 0 )
+    prev[next[key]] = prev[key];
+
+  held[key >> 5] &= ~((uint32_t)1 << (key & 31));
+  numNotes--;
+}
+
+void NoteStack::clear()
+{
+  for(int w=0; w<numKeys/32; w++)
+    held[w] = 0;
+  top      = -1;
+  numNotes = 0;
+}
@@ -68,6 +68,11 @@ class OnePoleFilter
       return cutoff;
     }
 
+    /** Retrieves the filter coefficients (as in setCoefficients). */
+    void getCoefficients(float *b0Out, float *b1Out, float *a1Out) const {
+      *b0Out = b0; *b1Out = b1; *a1Out = a1;
+    }
+
     //---------------------------------------------------------------------------------------------
     // audio processing:
 
@@ -32,7 +32,7 @@ void OnePoleFilter::setMode(int newMode)
   calcCoeffs();
 }
 
-void OnePoleFilter::setCutoff(float newCutoff)
+void HOT_CODE OnePoleFilter::setCutoff(float newCutoff)
 {
   if( (newCutoff>0.0f) && (newCutoff<=20000.0f) )
     cutoff = newCutoff;
@@ -76,7 +76,7 @@ void OnePoleFilter::setInternalState(float newX1, float newY1)
 //-------------------------------------------------------------------------------------------------
 //others:
 
-void OnePoleFilter::calcCoeffs()
+void HOT_CODE OnePoleFilter::calcCoeffs()
 {
   switch(mode)
   {
@@ -152,7 +152,7 @@ void OnePoleFilter::calcCoeffs()
   }
 }
 
-void OnePoleFilter::reset()
+void HOT_CODE OnePoleFilter::reset()
 {
   x1 = 0.0f;
   y1 = 0.0f;
@@ -1,20 +1,19 @@
 #ifndef rosic_Open303_h
 #define rosic_Open303_h
 
-#include "rosic_MidiNoteEvent.h"
+#include "rosic_NoteStack.h"
 #include "rosic_BlendOscillator.h"
 #include "rosic_BiquadFilter.h"
+#include "rosic_BiquadCascade.h"
 #include "rosic_TeeBeeFilter.h"
 #include "rosic_AnalogEnvelope.h"
 #include "rosic_DecayEnvelope.h"
 #include "rosic_LeakyIntegrator.h"
 #include "rosic_EllipticQuarterBandFilter.h"
 #include "rosic_AcidSequencer.h"
+#include "rosic_TuningTable.h"
 #include <limits.h>
 
-#include <list>
-using namespace std; // for the noteList
-
 namespace rosic
 {
 
@@ -30,6 +29,43 @@ namespace rosic
 
   public:
 
+    /** A snapshot of everything that evolves while the synth runs: the parameters, the states of
+    the oscillator, the filters and the envelopes, the held keys and the sequencer with its
+    patterns, its position and its drift compensation. The wavetables are not part of it: the
+    oscillator keeps playing the first wavetable of the synth it is restored into, which is the one
+    that requestWaveTable1() selected last there (a user waveform set by CC 78).
+
+    As long as both synths play the same wavetables, restoring a snapshot continues the output
+    exactly where it was taken. This allows to split a long rendering into chunks that run in
+    parallel (each chunk starts from a snapshot of the voice at its start, or from an earlier one
+    with a warm-up overlap that is discarded) and to recall a sound instantly, without any
+    allocation. The snapshot is a binary image of the embedded objects and thus only fits to the
+    same build of the synth, version and size are checked on restore. The version has to be
+    increased whenever the meaning of the state changes without its size. */
+    struct State
+    {
+      uint32_t        version, size;
+      BlendOscillator oscillator;
+      TeeBeeFilter    filter;
+      AnalogEnvelope  ampEnv;
+      DecayEnvelope   mainEnv;
+      LeakyIntegrator pitchSlewLimiter, rc1, rc2;
+      BiquadFilter    ampDeClicker, notch, antiAliasFilter;
+      OnePoleFilter   highpass1, highpass2, allpass;
+      BiquadCascade   postFilter;
+      AcidSequencer   sequencer;
+      NoteStack       noteStack;
+      TuningTable     tuningTable;
+      float tuning, ampScaler, oscFreq, sampleRate, level, levelByVel, accent, slideTime, cutoff,
+        envMod, envUpFraction, envOffset, envScaler, normalAttack, accentAttack, normalDecay,
+        accentDecay, normalAmpRelease, accentAmpRelease, accentGain, pitchWheelFactor, inputLevel,
+        inputGain, n1, n2;
+      int   currentNote, currentVel, noteOffCountDown;
+      bool  slideToNextNote, idle;
+    };
+
+    static const uint32_t stateVersion = 4;
+
     //-----------------------------------------------------------------------------------------------
     // construction/destruction:
 
@@ -49,8 +85,23 @@ namespace rosic
     0.0 .. 1.0 where 0 means pure saw and 1 means pure square. */
     void setWaveform(float newWaveform) { oscillator.setBlendFactor(newWaveform); }
 
-    /** Sets the master tuning frequency for note A4 (usually 440 Hz). */
-    void setTuning(float newTuning) { tuning = newTuning; }
+    /** Requests that the oscillator plays the given table as its first (saw) waveform instead of 
+    the one it plays now (initially waveTable1). The switch is taken up by the audio processing at 
+    the start of the next block, so the table can be built by another task while the oscillator 
+    still reads the other one - but it must not be touched anymore after the request. */
+    void requestWaveTable1(MipMappedWaveTable *newTable);
+
+    /** Withdraws a request of requestWaveTable1() that hasn't been taken up yet and returns its 
+    table, which is then free to be rebuilt - NULL when there is no such request. */
+    MipMappedWaveTable* cancelWaveTable1Request();
+
+    /** Sets the master tuning frequency for note A4 (usually 440 Hz) - this rebuilds the
+    tuningTable. */
+    void setTuning(float newTuning)
+    {
+      tuning = newTuning;
+      tuningTable.setMasterTuneA4(newTuning);
+    }
 
     /** Sets the filter's nominal cutoff frequency (in Hz). */
     void setCutoff(float newCutoff); 
@@ -97,15 +148,27 @@ namespace rosic
     void setFeedbackHighpass(float newCutoff) { filter.setFeedbackHighpassCutoff(newCutoff); }
 
     /** Sets the cutoff frequency for the highpass after the main filter. */
-    void setPostFilterHighpass(float newCutoff) { highpass2.setCutoff(newCutoff); }
+    void setPostFilterHighpass(float newCutoff) 
+    { 
+      highpass2.setCutoff(newCutoff); 
+      updatePostFilter();
+    }
 
     /** Sets the phase shift of tanh-shaped square wave with respect to the saw-wave (in degrees)
     - this is important when the two are mixed. */
     void setSquarePhaseShift(float newShift) { waveTable2.set303SquarePhaseShift(newShift); }
 
+    /** Sets the level of the external input (in dB) that is mixed to the oscillator in front of the
+    pre-filter highpass (see processBlock with input frames) - -100 dB and below turn it off. */
+    void setInputLevel(float newInputLevel);
+
     /** Sets the slide-time (in ms). The TB-303 had a slide time of 60 ms. */
     void setSlideTime(float newSlideTime);
 
+    /** Selects which of several held keys is played - the last, lowest or highest one
+    @see NoteStack::priorities. The 303 itself used last note priority. */
+    void setNotePriority(int newPriority) { noteStack.setPriority(newPriority); }
+
     /** Sets the filter envelope's attack time for non-accented notes (in milliseconds). 
     Devil Fish provides range of 0.3...30 ms for this parameter. */
     void setNormalAttack(float newNormalAttack) 
@@ -198,6 +261,9 @@ namespace rosic
     - this is important when the two are mixed. */
     float getSquarePhaseShift() const { return waveTable2.get303SquarePhaseShift(); }
 
+    /** Returns the level of the external input (in dB). */
+    float getInputLevel() const { return inputLevel; }
+
     /** Returns the slide-time (in ms). */
     float getSlideTime() const { return slideTime; }
 
@@ -216,12 +282,39 @@ namespace rosic
     /** Returns the amplitudes envelope's release time (in milliseconds). */
     float getAmpRelease() const { return normalAmpRelease; }
 
+    /** Returns true when the voice sleeps - the last note has been released and has decayed below
+    -120 dB. A sleeping voice does no DSP at all, the next note wakes it up without delay. */
+    bool isIdle() const { return idle; }
+
+    /** Takes a snapshot of the complete state of the synth. */
+    void getState(State &state) const;
+
+    //-----------------------------------------------------------------------------------------------
+    // state recall:
+
+    /** Restores a snapshot taken by getState() - the next sample is the one that would have
+    followed when the snapshot was taken. Returns false (and leaves the synth as it is) when the
+    snapshot was made by a different version of the synth. It must not be called concurrently to
+    the audio processing. */
+    bool setState(const State &state);
+
     //-----------------------------------------------------------------------------------------------
     // audio processing:
 
     /** Calculates one output sample at a time. */
     INLINE float getSample(); 
 
+    /** Calculates a block of output samples. In sequencer mode, the spans between the sequencer
+    events (steps and note-offs) are rendered without polling the sequencer per sample. */
+    void processBlock(float *buffer, int length);
+
+    /** Calculates a block of output samples with an external signal mixed to the oscillator, like
+    the external input of the Devil Fish: the signal runs through the pre-filter highpass, the main
+    filter with its envelope and the amplifier, so it is keyed by the notes. The input comes as
+    interleaved stereo 16 bit frames (as read from I2S), the channels are summed to mono - it is
+    read in place, there is no conversion buffer. */
+    void processBlock(float *buffer, int length, const int16_t *inputFrames);
+
     //-----------------------------------------------------------------------------------------------
     // event handling:
 
@@ -254,6 +347,7 @@ namespace rosic
     
     BiquadFilter              antiAliasFilter;
     AcidSequencer             sequencer;
+    TuningTable               tuningTable; // the note frequencies, scales are loaded into it
 
   protected:
 
@@ -269,6 +363,32 @@ namespace rosic
     used). */
     void releaseNote(int noteNumber);
 
+    /** Lets the sequencer advance by one sample and handles the note-on/off event that may occur
+    at this sample. */
+    INLINE void handleSequencerEvents();
+
+    /** Returns the number of upcoming samples which are free of sequencer events, i.e. the number
+    of handleSequencerEvents() calls that would do nothing but count down. */
+    INLINE int getNumEventFreeSamples();
+
+    /** Switches the oscillator to the table of a pending requestWaveTable1(), if any. */
+    INLINE void takeUpWaveTable1();
+
+    /** Calculates a block of the main envelope and the instantaneous cutoff frequency that results
+    from it (via rc1, rc2 and the modulation depths) - the states of the main envelope and the RCs 
+    are kept in registers over the whole block. */
+    INLINE void renderFilterEnvelope(float *mainEnvOut, float *instCutoff, int length);
+
+    /** Calculates a block of the oscillator signal (plus the external input frames, if any),
+    filtered by the pre-filter highpass and the main filter with the given instantaneous cutoff
+    frequencies. */
+    INLINE void renderFilteredOscillator(float *buffer, const int16_t *in, const float *instCutoff,
+                                         int length);
+
+    /** Calculates a span of output samples without looking at the sequencer - silence once the
+    voice sleeps. */
+    INLINE void renderSpan(float *buffer, int length);
+
     /** Sets the decay-time of the main envelope and updates the normalizers n1, n2 accordingly. */
     void setMainEnvDecay(float newDecay);
 
@@ -282,7 +402,13 @@ namespace rosic
     main envelope generator. */
     void updateNormalizer2();
 
+    /** Sets up the postFilter cascade from the allpass, highpass2 and notch filters - to be called
+    whenever one of them was changed. */
+    void updatePostFilter();
+
     static const int oversampling = 1;
+    static const int maxBlockSize = 32;  // block size of the stages in renderSpan
+    static constexpr float silenceThreshold = 0.000001f; // -120 dB, the voice sleeps below that
 
     float tuning;           // master tunung for A4 in Hz
     float ampScaler;        // final volume as raw factor
@@ -305,14 +431,23 @@ namespace rosic
     float accentAmpRelease; // amp-env release time for accented notes
     float accentGain;       // between 0.0...1.0 - to scale the 3rd amp-envelope on accents
     float pitchWheelFactor; // scale factor for oscillator frequency from pitch-wheel
+    float inputLevel;       // level of the external input (in dB)
+    float inputGain;        // raw factor for the sum of the two input channels (0 when off)
     float n1, n2;           // normalizers for the RCs that are driven by the MEG
     int    currentNote;      // note which is currently played (-1 if none)
     int    currentVel;       // velocity of currently played note
     int    noteOffCountDown; // a countdown variable till next note-off in sequencer mode
     bool   slideToNextNote;  // indicate that we need to slide to the next note in sequencer mode
-    bool   idle;             // flag to indicate that we have currently nothing to do in getSample
+    bool   idle;             // flag to indicate that the voice sleeps (no DSP until the next note)
+
+    const int16_t *input;    // the input frames of the current block (NULL without input)
+
+    NoteStack noteStack;     // the held keys (when the sequencer is off)
 
-    list<MidiNoteEvent> noteList;
+    MipMappedWaveTable *activeWaveTable1;  // the first table of the oscillator
+    MipMappedWaveTable *pendingWaveTable1; // requested, not taken up yet (NULL if none)
+
+    BiquadCascade postFilter; // allpass, highpass2 and notch in one (they are only the design)
 
   };
 
@@ -321,97 +456,202 @@ namespace rosic
 
   INLINE float Open303::getSample()
   {
-    //if( sequencer.getSequencerMode() == AcidSequencer::OFF && ampEnv.endIsReached() )
-    //  return 0.0;
+    takeUpWaveTable1();
+
+    // check the sequencer if we have some note to trigger (a sleeping voice with a stopped
+    // sequencer has nothing to release):
+    if( sequencer.getSequencerMode() != AcidSequencer::OFF && (!idle || sequencer.isRunning()) )
+      handleSequencerEvents();
+
     if( idle )
       return 0.0f;
 
-    // check the sequencer if we have some note to trigger:
-    if( sequencer.getSequencerMode() != AcidSequencer::OFF )
+    float out;
+    renderSpan(&out, 1);
+    return out;
+  }
+
+  INLINE void Open303::takeUpWaveTable1()
+  {
+    // exchanged atomically, the control side may withdraw the request at the same time:
+    MipMappedWaveTable *table = __atomic_exchange_n(&pendingWaveTable1, (MipMappedWaveTable*) NULL,
+      __ATOMIC_ACQ_REL);
+    if( table != NULL )
     {
-      noteOffCountDown--;
-      if( noteOffCountDown == 0 || sequencer.isRunning() == false )
-        releaseNote(currentNote);
+      oscillator.setWaveTable1(table);
+      activeWaveTable1 = table;
+    }
+  }
 
-      AcidNote *note = sequencer.getNote();
-      if( note != NULL )
+  INLINE void Open303::handleSequencerEvents()
+  {
+    noteOffCountDown--;
+    if( noteOffCountDown == 0 || sequencer.isRunning() == false )
+      releaseNote(currentNote);
+
+    AcidNote *note = sequencer.getNote();
+    if( note != NULL )
+    {
+      if( note->gate == true && currentNote != -1)
       {
-        if( note->gate == true && currentNote != -1)
+        int key = note->key + 12*note->octave + currentNote;
+        key = clip(key, 0, 127);
+
+        // a key that the keyboard mapping leaves out is a rest, which ends a slide into it:
+        if( !tuningTable.isMapped(key) )
+        {
+          if( slideToNextNote )
+            releaseNote(currentNote);
+          slideToNextNote = false;
+          return;
+        }
+
+        if( !slideToNextNote )
+          triggerNote(key, note->accent);
+        else
+          slideToNote(key, note->accent);
+
+        AcidNote* nextNote = sequencer.getNextScheduledNote();
+        if( note->slide && nextNote->gate == true )
         {
-          int key = note->key + 12*note->octave + currentNote;
-          key = clip(key, 0, 127);
-
-          if( !slideToNextNote )
-            triggerNote(key, note->accent);
-          else
-            slideToNote(key, note->accent);
-
-          AcidNote* nextNote = sequencer.getNextScheduledNote();
-          if( note->slide && nextNote->gate == true )
-          {
-            noteOffCountDown = INT_MAX;
-            slideToNextNote  = true;
-          }
-          else
-          {
-            noteOffCountDown = sequencer.getStepLengthInSamples();
-            slideToNextNote  = false;
-          }
+          noteOffCountDown = INT_MAX;
+          slideToNextNote  = true;
+        }
+        else
+        {
+          noteOffCountDown = sequencer.getStepLengthInSamples();
+          slideToNextNote  = false;
         }
       }
     }
+  }
 
-    // calculate instantaneous oscillator frequency and set up the oscillator:
-    float instFreq = pitchSlewLimiter.getSample(oscFreq);
-    oscillator.setFrequency(instFreq*pitchWheelFactor);
-    oscillator.calculateIncrement();
-
-    // calculate instantaneous cutoff frequency from the nominal cutoff and all its modifiers and 
-    // set up the filter:
-    float mainEnvOut = mainEnv.getSample();
-    float tmp1       = n1 * rc1.getSample(mainEnvOut);
-    float tmp2       = 0.0f;
-    if( accentGain > 0.0f )
-      tmp2 = mainEnvOut;
-    tmp2 = n2 * rc2.getSample(tmp2);  
-    tmp1 = envScaler * ( tmp1 - envOffset );  // seems not to work yet
-    tmp2 = accentGain*tmp2;
-    float instCutoff = cutoff * powf(2.0f, tmp1+tmp2);
-    filter.setCutoff(instCutoff);
-    
-    float ampEnvOut = ampEnv.getSample();
-    
-    //ampEnvOut += 0.45*filterEnvOut + accentGain*6.8*filterEnvOut; 
-    if( ampEnv.isNoteOn() )
-      ampEnvOut += 0.45f*mainEnvOut + accentGain*4.0f*mainEnvOut; 
-    ampEnvOut = ampDeClicker.getSample(ampEnvOut);
-
-    // oversampled calculations:
-    float tmp;
-    for(int i=1; i<=oversampling; i++)
+  INLINE int Open303::getNumEventFreeSamples()
+  {
+    // a stopped sequencer releases the note at each sample:
+    if( sequencer.isRunning() == false )
+      return 0;
+
+    // the note-off occurs at the sample where noteOffCountDown is decremented to zero:
+    int n = sequencer.getSamplesToNextStep();
+    if( noteOffCountDown > 0 && noteOffCountDown-1 < n )
+      n = noteOffCountDown-1;
+    return n;
+  }
+
+  INLINE void Open303::renderSpan(float *buffer, int length)
+  {
+    const int16_t *in = input;
+    if( input != NULL )
+      input += 2*length; // the next span continues after this one, also when the voice sleeps
+
+    float ampEnvBuffer[maxBlockSize], mainEnvBuffer[maxBlockSize], cutoffBuffer[maxBlockSize];
+
+    // the envelopes, the oscillator and the filters may run ahead of a voice that falls asleep
+    // within a block because the next note retriggers and resets them - except for the amp 
+    // envelope which is rendered ahead only while the note is held (the voice can't fall asleep
+    // then):
+    int i = 0;
+    while( i < length && !idle )
     {
-      tmp  = -oscillator.getSample();         // the raw oscillator signal 
-      tmp  = highpass1.getSample(tmp);        // pre-filter highpass
-      tmp  = filter.getSample(tmp);           // now it's filtered
-      tmp  = antiAliasFilter.getSample(tmp);  // anti-aliasing filtered
-   //   DEBF ("SYNTH: oversampled tmp: %f\r\n", tmp);
+      int    n   = length-i < maxBlockSize ? length-i : maxBlockSize;
+      float *out = &buffer[i];
+      renderFilterEnvelope(mainEnvBuffer, cutoffBuffer, n);
+      renderFilteredOscillator(out, in != NULL ? &in[2*i] : NULL, cutoffBuffer, n);
+      postFilter.processBlock(out, n);
 
+      if( ampEnv.isNoteOn() )
+      {
+        ampEnv.processBlock(ampEnvBuffer, n);
+        for(int k=0; k<n; k++)
+        {
+          float ampEnvOut = ampEnvBuffer[k];
+          ampEnvOut += 0.45f*mainEnvBuffer[k] + accentGain*4.0f*mainEnvBuffer[k];
+          ampEnvOut  = ampDeClicker.getSample(ampEnvOut);
+          out[k]    *= ampEnvOut;
+          out[k]    *= ampScaler;
+        }
+        i += n;
+      }
+      else
+      {
+        for(int k=0; k<n && !idle; k++)
+        {
+          float ampEnvOut = ampDeClicker.getSample(ampEnv.getSample());
+          out[k] *= ampEnvOut;
+          out[k] *= ampScaler;
+          i++;
+
+          // find out whether we may switch ourselves off - that's when the amplitude (after the
+          // de-clicker) and the output have decayed:
+          idle = ampEnv.endIsReached() && fabs(ampEnvOut) < silenceThreshold
+            && fabs(out[k]) < silenceThreshold;
+        }
+      }
+    }
+    while( i < length )
+      buffer[i++] = 0.0f;
+  }
+
+  INLINE void Open303::renderFilterEnvelope(float *mainEnvOut, float *instCutoff, int length)
+  {
+    float y  = mainEnv.getState();
+    float c  = mainEnv.getCoefficient();
+    float y1 = rc1.getState();
+    float c1 = rc1.getCoefficient();
+    float y2 = rc2.getState();
+    float c2 = rc2.getCoefficient();
+
+    // rc2 (the accent sweep) is driven by the main envelope only on accented notes:
+    float accentIn = accentGain > 0.0f ? 1.0f : 0.0f;
+
+    // the exponent for the cutoff - envelope and accent sweep in octaves:
+    for(int i=0; i<length; i++)
+    {
+      y            *= c;
+      y1            = y + c1*(y1-y);
+      float in2     = accentIn*y;
+      y2            = in2 + c2*(y2-in2);
+      float tmp1    = envScaler * ( n1*y1 - envOffset );
+      float tmp2    = accentGain * (n2*y2);
+      mainEnvOut[i] = y;
+      instCutoff[i] = tmp1+tmp2;
     }
 
-    // these filters may actually operate without oversampling (but only if we reset them in
-    // triggerNote - avoid clicks)
-    tmp  = allpass.getSample(tmp);
-    tmp  = highpass2.getSample(tmp);        
-    tmp  = notch.getSample(tmp);
-    tmp *= ampEnvOut;                       // amplified
-    tmp *= ampScaler;
+    mainEnv.setState(y);
+    rc1.setState(y1);
+    rc2.setState(y2);
+
+    for(int i=0; i<length; i++)
+      instCutoff[i] = cutoff * fast_exp2(instCutoff[i]);
+  }
 
-    // find out whether we may switch ourselves off for the next call:
-    idle = false;
-    //idle = (sequencer.getSequencerMode() == AcidSequencer::OFF && ampEnv.endIsReached() 
-    //        && fabs(tmp) < 0.000001); // ampEnvOut < 0.000001;
+  INLINE void Open303::renderFilteredOscillator(float *buffer, const int16_t *in,
+                                                const float *instCutoff, int length)
+  {
+    for(int k=0; k<length; k++)
+    {
+      // calculate instantaneous oscillator frequency and set up the oscillator:
+      float instFreq = pitchSlewLimiter.getSample(oscFreq);
+      oscillator.setFrequency(instFreq*pitchWheelFactor);
+      oscillator.calculateIncrement();
 
-    return tmp;
+      // set up the filter for the instantaneous cutoff frequency:
+      filter.setCutoff(instCutoff[k]);
+
+      // oversampled calculations:
+      float tmp;
+      for(int i=1; i<=oversampling; i++)
+      {
+        tmp  = -oscillator.getSample();         // the raw oscillator signal 
+        if( in != NULL )                        // plus the external input
+          tmp += inputGain * (float) (in[2*k] + in[2*k+1]);
+        tmp  = highpass1.getSample(tmp);        // pre-filter highpass
+        tmp  = filter.getSample(tmp);           // now it's filtered
+        tmp  = antiAliasFilter.getSample(tmp);  // anti-aliasing filtered
+      }
+      buffer[k] = tmp;
+    }
   }
 
 }
@@ -24,6 +24,9 @@ Open303::Open303()
   accentAmpRelease =    50.0;
   accentGain       =     0.0;
   pitchWheelFactor =     1.0;
+  inputLevel       =  -100.0;
+  inputGain        =     0.0;
+  input            =  NULL;
   currentNote      =    -1;
   currentVel       =     0;
   noteOffCountDown =     0;
@@ -34,6 +37,8 @@ Open303::Open303()
 
   oscillator.setWaveTable1(&waveTable1);
   oscillator.setWaveForm1(MipMappedWaveTable::SAW303);
+  activeWaveTable1  = &waveTable1;
+  pendingWaveTable1 = NULL;
   oscillator.setWaveTable2(&waveTable2);
   oscillator.setWaveForm2(MipMappedWaveTable::SQUARE303);
 
@@ -76,6 +81,7 @@ Open303::Open303()
   allpass.setCutoff(14.008f);
   notch.setFrequency(7.5164f);
   notch.setBandwidth(4.7f);
+  updatePostFilter();
 
   filter.setFeedbackHighpassCutoff(150.0f);
 }
@@ -106,32 +112,43 @@ void Open303::setSampleRate(float newSampleRate)
 
   oscillator.setSampleRate    (  (float)oversampling*(float)newSampleRate);
   filter.setSampleRate        (  (float)oversampling*(float)newSampleRate);
+
+  updatePostFilter();
 }
 
-void Open303::setCutoff(float newCutoff)
+void HOT_CODE Open303::setCutoff(float newCutoff)
 {
   cutoff = newCutoff;
   calculateEnvModScalerAndOffset();
 }
 
-void Open303::setEnvMod(float newEnvMod)
+void HOT_CODE Open303::setEnvMod(float newEnvMod)
 {
   envMod = newEnvMod;
   calculateEnvModScalerAndOffset();
 }
 
-void Open303::setAccent(float newAccent)
+void HOT_CODE Open303::setAccent(float newAccent)
 {
   accent = 0.01f * newAccent;
 }
 
-void Open303::setVolume(float newLevel)
+void HOT_CODE Open303::setVolume(float newLevel)
 {
   level     = newLevel;
   ampScaler = dB2amp(level);
 }
 
-void Open303::setSlideTime(float newSlideTime)
+void HOT_CODE Open303::setInputLevel(float newInputLevel)
+{
+  inputLevel = newInputLevel;
+  if( inputLevel <= -100.0f )
+    inputGain = 0.0f;
+  else
+    inputGain = dB2amp(inputLevel) * (1.0f/65536.0f); // the mean of the channels, full scale = 1
+}
+
+void HOT_CODE Open303::setSlideTime(float newSlideTime)
 {
   if( newSlideTime >= 0.0f )
   {
@@ -142,7 +159,181 @@ void Open303::setSlideTime(float newSlideTime)
 
 void Open303::setPitchBend(float newPitchBend)
 {
-  pitchWheelFactor = pitchOffsetToFreqFactor(newPitchBend);
+  pitchWheelFactor = fast_exp2(newPitchBend * (1.0f/12.0f)); // table lookup, about 0.1 cent
+}
+
+void Open303::requestWaveTable1(MipMappedWaveTable *newTable)
+{
+  // the release makes the writes to the table visible to the audio task before the pointer:
+  __atomic_store_n(&pendingWaveTable1, newTable, __ATOMIC_RELEASE);
+}
+
+MipMappedWaveTable* Open303::cancelWaveTable1Request()
+{
+  return __atomic_exchange_n(&pendingWaveTable1, (MipMappedWaveTable*) NULL, __ATOMIC_ACQ_REL);
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+void Open303::getState(State &state) const
+{
+  state.version          = stateVersion;
+  state.size             = sizeof(State);
+  state.oscillator       = oscillator;
+  state.filter           = filter;
+  state.ampEnv           = ampEnv;
+  state.mainEnv          = mainEnv;
+  state.pitchSlewLimiter = pitchSlewLimiter;
+  state.rc1              = rc1;
+  state.rc2              = rc2;
+  state.ampDeClicker     = ampDeClicker;
+  state.notch            = notch;
+  state.antiAliasFilter  = antiAliasFilter;
+  state.highpass1        = highpass1;
+  state.highpass2        = highpass2;
+  state.allpass          = allpass;
+  state.postFilter       = postFilter;
+  state.sequencer        = sequencer;
+  state.noteStack        = noteStack;
+  state.tuningTable      = tuningTable;
+
+  state.tuning           = tuning;
+  state.ampScaler        = ampScaler;
+  state.oscFreq          = oscFreq;
+  state.sampleRate       = sampleRate;
+  state.level            = level;
+  state.levelByVel       = levelByVel;
+  state.accent           = accent;
+  state.slideTime        = slideTime;
+  state.cutoff           = cutoff;
+  state.envMod           = envMod;
+  state.envUpFraction    = envUpFraction;
+  state.envOffset        = envOffset;
+  state.envScaler        = envScaler;
+  state.normalAttack     = normalAttack;
+  state.accentAttack     = accentAttack;
+  state.normalDecay      = normalDecay;
+  state.accentDecay      = accentDecay;
+  state.normalAmpRelease = normalAmpRelease;
+  state.accentAmpRelease = accentAmpRelease;
+  state.accentGain       = accentGain;
+  state.pitchWheelFactor = pitchWheelFactor;
+  state.inputLevel       = inputLevel;
+  state.inputGain        = inputGain;
+  state.n1               = n1;
+  state.n2               = n2;
+  state.currentNote      = currentNote;
+  state.currentVel       = currentVel;
+  state.noteOffCountDown = noteOffCountDown;
+  state.slideToNextNote  = slideToNextNote;
+  state.idle             = idle;
+}
+
+//-------------------------------------------------------------------------------------------------
+// state recall:
+
+bool Open303::setState(const State &state)
+{
+  if( state.version != stateVersion || state.size != sizeof(State) )
+    return false;
+
+  // the oscillator of the snapshot points to the wavetables of the synth it was taken from:
+  oscillator       = state.oscillator;
+  oscillator.setWaveTable1(activeWaveTable1);
+  oscillator.setWaveTable2(&waveTable2);
+
+  filter           = state.filter;
+  ampEnv           = state.ampEnv;
+  mainEnv          = state.mainEnv;
+  pitchSlewLimiter = state.pitchSlewLimiter;
+  rc1              = state.rc1;
+  rc2              = state.rc2;
+  ampDeClicker     = state.ampDeClicker;
+  notch            = state.notch;
+  antiAliasFilter  = state.antiAliasFilter;
+  highpass1        = state.highpass1;
+  highpass2        = state.highpass2;
+  allpass          = state.allpass;
+  postFilter       = state.postFilter;
+  sequencer        = state.sequencer;
+  noteStack        = state.noteStack;
+  tuningTable      = state.tuningTable;
+
+  tuning           = state.tuning;
+  ampScaler        = state.ampScaler;
+  oscFreq          = state.oscFreq;
+  sampleRate       = state.sampleRate;
+  level            = state.level;
+  levelByVel       = state.levelByVel;
+  accent           = state.accent;
+  slideTime        = state.slideTime;
+  cutoff           = state.cutoff;
+  envMod           = state.envMod;
+  envUpFraction    = state.envUpFraction;
+  envOffset        = state.envOffset;
+  envScaler        = state.envScaler;
+  normalAttack     = state.normalAttack;
+  accentAttack     = state.accentAttack;
+  normalDecay      = state.normalDecay;
+  accentDecay      = state.accentDecay;
+  normalAmpRelease = state.normalAmpRelease;
+  accentAmpRelease = state.accentAmpRelease;
+  accentGain       = state.accentGain;
+  pitchWheelFactor = state.pitchWheelFactor;
+  inputLevel       = state.inputLevel;
+  inputGain        = state.inputGain;
+  n1               = state.n1;
+  n2               = state.n2;
+  currentNote      = state.currentNote;
+  currentVel       = state.currentVel;
+  noteOffCountDown = state.noteOffCountDown;
+  slideToNextNote  = state.slideToNextNote;
+  idle             = state.idle;
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE Open303::processBlock(float *buffer, int length)
+{
+  takeUpWaveTable1();
+
+  if( sequencer.getSequencerMode() == AcidSequencer::OFF
+    || (idle && sequencer.isRunning() == false) )
+  {
+    renderSpan(buffer, length);
+    return;
+  }
+
+  // render the event-free spans in one go and split the block only where the sequencer triggers
+  // or releases a note:
+  int i = 0;
+  while( i < length )
+  {
+    int n = getNumEventFreeSamples();
+    if( n > length-i )
+      n = length-i;
+    sequencer.advance(n);
+    noteOffCountDown -= n;
+    renderSpan(&buffer[i], n);
+    i += n;
+
+    if( i < length )
+    {
+      handleSequencerEvents();
+      renderSpan(&buffer[i], 1);
+      i++;
+    }
+  }
+}
+
+void HOT_CODE Open303::processBlock(float *buffer, int length, const int16_t *inputFrames)
+{
+  input = inputGain != 0.0f ? inputFrames : NULL;
+  processBlock(buffer, length);
+  input = NULL;
 }
 
 //------------------------------------------------------------------------------------------------------------
@@ -155,18 +346,24 @@ void Open303::noteOn(int noteNumber, int velocity, float detune)
 
   if( sequencer.getSequencerMode() != AcidSequencer::OFF )
   {
+    // in KEY_SYNC mode, the keys start and stop the sequencer, in HOST_SYNC mode, the host's
+    // clock does and the keys only transpose:
     if( velocity == 0 )
     {
-      sequencer.stop();
+      if( sequencer.getSequencerMode() == AcidSequencer::KEY_SYNC )
+        sequencer.stop();
       releaseNote(currentNote);
       currentNote = -1;
       currentVel  = 0;
     }
     else
     {
-      sequencer.start();
-      noteOffCountDown = INT_MAX;
-      slideToNextNote  = false;
+      if( sequencer.getSequencerMode() == AcidSequencer::KEY_SYNC )
+      {
+        sequencer.start();
+        noteOffCountDown = INT_MAX;
+        slideToNextNote  = false;
+      }
       currentNote      = noteNumber;
       currentVel       = velocity;
     }
@@ -174,60 +371,62 @@ void Open303::noteOn(int noteNumber, int velocity, float detune)
     return;
   }
 
+  if( velocity != 0 && !tuningTable.isMapped(noteNumber) )
+    return; // a key that the keyboard mapping leaves out
+
   if( velocity == 0 ) // velocity zero indicates note-off events
   {
-    MidiNoteEvent releasedNote(noteNumber, 0);
-    noteList.remove(releasedNote);
-    if( noteList.empty() )
+    noteStack.remove(noteNumber);
+    if( noteStack.isEmpty() )
     {
       currentNote = -1;
       currentVel  = 0;
     }
     else
     {
-      currentNote = noteList.front().getKey();
-      currentVel  = noteList.front().getVelocity();
+      currentNote = noteStack.getKey();
+      currentVel  = noteStack.getVelocity();
     }
     releaseNote(noteNumber);
   }
   else // velocity was not zero, so this is an actual note-on
   {
-    // check if the note-list is empty (indicating that currently no note is playing) - if so,
-    // trigger a new note, otherwise, slide to the new note:
-    if( noteList.empty() )
+    // check if the note-stack is empty (indicating that currently no note is playing) - if so,
+    // trigger a new note, otherwise, slide to the new note if it takes priority over the held
+    // ones:
+    bool wasEmpty = noteStack.isEmpty();
+    noteStack.push(noteNumber, velocity);
+    if( wasEmpty )
       triggerNote(noteNumber, velocity >= 80);
-    else
+    else if( noteStack.getKey() == noteNumber )
       slideToNote(noteNumber, velocity >= 80);
 
-    currentNote = noteNumber;
+    currentNote = noteStack.getKey();
     currentVel  = 64;
-
-    // and we need to add the new note to our list, of course:
-    MidiNoteEvent newNote(noteNumber, velocity);
-    noteList.push_front(newNote);
   }
   idle = false;
 }
 
 void Open303::allNotesOff()
 {
-  noteList.clear();
+  noteStack.clear();
   ampEnv.noteOff();
   currentNote = -1;
   currentVel  = 0;
 }
 
-void Open303::triggerNote(int noteNumber, bool hasAccent)
+void HOT_CODE Open303::triggerNote(int noteNumber, bool hasAccent)
 {
-  // retrigger osc and reset filter buffers only if amplitude is near zero (to avoid clicks):
+  // retrigger osc and reset filter buffers only if amplitude is near zero (to avoid clicks) - the
+  // RCs have stopped while the voice was sleeping, they go to the state they were decaying to:
   if( idle )
   {
+    rc1.reset();
+    rc2.reset();
     oscillator.resetPhase();
     filter.reset();
     highpass1.reset();
-    highpass2.reset();
-    allpass.reset();
-    notch.reset();
+    postFilter.reset();
     antiAliasFilter.reset();
     ampDeClicker.reset();
   }
@@ -245,16 +444,16 @@ void Open303::triggerNote(int noteNumber, bool hasAccent)
     ampEnv.setRelease(normalAmpRelease);
   }
 
-  oscFreq = pitchToFreq(noteNumber, tuning);
+  oscFreq = tuningTable.getFrequency(noteNumber);
   pitchSlewLimiter.setState(oscFreq);
   mainEnv.trigger();
   ampEnv.noteOn(true, noteNumber, 64);
   idle = false;
 }
 
-void Open303::slideToNote(int noteNumber, bool hasAccent)
+void HOT_CODE Open303::slideToNote(int noteNumber, bool hasAccent)
 {
-  oscFreq = pitchToFreq(noteNumber, tuning);
+  oscFreq = tuningTable.getFrequency(noteNumber);
 
   if( hasAccent )
   {
@@ -271,12 +470,11 @@ void Open303::slideToNote(int noteNumber, bool hasAccent)
   idle = false;
 }
 
-void Open303::releaseNote(int noteNumber)
+void HOT_CODE Open303::releaseNote(int noteNumber)
 {
-  // check if the note-list is empty now. if so, trigger a release, otherwise slide to the note
-  // at the beginning of the list (this is the most recent one which is still in the list). this
-  // initiates a slide back to the most recent note that is still being held:
-  if( noteList.empty() )
+  // check if the note-stack is empty now. if so, trigger a release, otherwise slide to the note
+  // that has priority among the ones that are still being held:
+  if( noteStack.isEmpty() )
   {
     //filterEnvelope.noteOff();
     ampEnv.noteOff();
@@ -284,18 +482,18 @@ void Open303::releaseNote(int noteNumber)
   else
   {
     // initiate slide back:
-    oscFreq     = pitchToFreq(currentNote);
+    oscFreq     = tuningTable.getFrequency(currentNote);
   }
 }
 
-void Open303::setMainEnvDecay(float newDecay)
+void HOT_CODE Open303::setMainEnvDecay(float newDecay)
 {
   mainEnv.setDecayTimeConstant(newDecay);
   updateNormalizer1();
   updateNormalizer2();
 }
 
-void Open303::calculateEnvModScalerAndOffset()
+void HOT_CODE Open303::calculateEnvModScalerAndOffset()
 {
   bool useMeasuredMapping = true; // might be shown as user parameter later
   if( useMeasuredMapping == true )
@@ -330,14 +528,29 @@ void Open303::calculateEnvModScalerAndOffset()
   }
 }
 
-void Open303::updateNormalizer1()
+void HOT_CODE Open303::updateNormalizer1()
 {
   n1 = LeakyIntegrator::getNormalizer(mainEnv.getDecayTimeConstant(), rc1.getTimeConstant(),     sampleRate);
   n1 = 1.0f; // test
 }
 
-void Open303::updateNormalizer2()
+void HOT_CODE Open303::updateNormalizer2()
 {
   n2 = LeakyIntegrator::getNormalizer(mainEnv.getDecayTimeConstant(), rc2.getTimeConstant(),     sampleRate);
   n2 = 1.0f; // test
 }
+
+void HOT_CODE Open303::updatePostFilter()
+{
+  // the first order filters are stages of their own - multiplying them out into one second order
+  // stage would move their poles (which are close to z = 1) by rounding errors in the order of
+  // a Hertz:
+  float b0, b1, b2, a1, a2;
+  postFilter.setNumStages(3);
+  allpass.getCoefficients(&b0, &b1, &a1);
+  postFilter.setStage(0, b0, b1, 0.0f, a1, 0.0f);
+  highpass2.getCoefficients(&b0, &b1, &a1);
+  postFilter.setStage(1, b0, b1, 0.0f, a1, 0.0f);
+  notch.getCoefficients(&b0, &b1, &b2, &a1, &a2);
+  postFilter.setStage(2, b0, b1, b2, a1, a2);
+}
@@ -0,0 +1,114 @@
+#ifndef rosic_Open303Preset_h
+#define rosic_Open303Preset_h
+
+// rosic-indcludes:
+#include "rosic_Open303.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a patch for the Open303 - the sound-shaping parameters (the ones with a setter in
+  Open303) without the tuning and the wavetable internals. It is meant to be stored in bulk, so it
+  is kept compact: each parameter is a 16 bit raw value that spans the parameter's range on its
+  natural scale (linear or exponential), which also makes the raw values the right domain to
+  interpolate in (see PresetMorpher). A preset is a plain binary object of 46 bytes.
+
+  */
+
+  class Open303Preset
+  {
+
+  public:
+
+    /** The parameters of a preset. */
+    enum parameters
+    {
+      WAVEFORM = 0,         // 0...1 (saw...square)
+      CUTOFF,               // Hz
+      RESONANCE,            // %
+      ENV_MOD,              // %
+      DECAY,                // ms
+      ACCENT,               // %
+      VOLUME,               // dB
+      SLIDE_TIME,           // ms
+      NORMAL_ATTACK,        // ms
+      ACCENT_ATTACK,        // ms
+      ACCENT_DECAY,         // ms
+      AMP_SUSTAIN,          // dB
+      AMP_DECAY,            // ms
+      AMP_RELEASE,          // ms
+      PRE_FILTER_HIGHPASS,  // Hz
+      FEEDBACK_HIGHPASS,    // Hz
+      POST_FILTER_HIGHPASS, // Hz
+
+      NUM_PARAMETERS
+    };
+
+    /** The maximum length of the name (without the terminating zero). */
+    static const int maxNameLength = 11;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. Initializes the preset to the settings of a freshly constructed synth. */
+    Open303Preset();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the name (it is truncated to maxNameLength characters). */
+    void setName(const char *newName);
+
+    /** Sets a parameter (in its natural unit, see parameters) - the value is clipped to the range
+    of the parameter. */
+    void setValue(int parameter, float newValue);
+
+    /** Sets the raw 16 bit value of a parameter. */
+    void setRawValue(int parameter, uint16_t newValue)
+    { if( parameter >= 0 && parameter < NUM_PARAMETERS ) rawValues[parameter] = newValue; }
+
+    /** Takes over the current settings of a synth. */
+    void readFrom(const Open303 &synth);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the name. */
+    const char* getName() const { return name; }
+
+    /** Returns a parameter (in its natural unit). */
+    float getValue(int parameter) const;
+
+    /** Returns the raw 16 bit value of a parameter. */
+    uint16_t getRawValue(int parameter) const
+    { return (parameter >= 0 && parameter < NUM_PARAMETERS) ? rawValues[parameter] : 0; }
+
+    /** Converts a raw value of a parameter into its natural unit. */
+    static float rawToValue(int parameter, uint16_t rawValue);
+
+    /** Converts a value of a parameter (in its natural unit) into a raw value. */
+    static uint16_t valueToRaw(int parameter, float value);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Sets all parameters of a synth at once. */
+    void applyTo(Open303 &synth) const;
+
+    /** Sets one parameter of a synth from a raw value. */
+    static void applyRawValue(Open303 &synth, int parameter, uint16_t rawValue);
+
+    //=============================================================================================
+
+  protected:
+
+    char     name[maxNameLength+1];
+    uint16_t rawValues[NUM_PARAMETERS];
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_Open303Preset_h
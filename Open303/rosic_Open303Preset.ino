@@ -0,0 +1,166 @@
+#include "rosic_Open303Preset.h"
+using namespace rosic;
+
+// the ranges of the parameters, octaves = log2(max/min) for the exponential ones and 0 for the
+// linear ones (read by the PresetMorpher from the audio task, hence in DRAM):
+struct Open303ParameterRange
+{
+  float min, max, octaves;
+};
+
+static const Open303ParameterRange open303ParameterRanges[Open303Preset::NUM_PARAMETERS] HOT_DATA =
+{
+  {    0.0f,     1.0f,  0.0f       }, // WAVEFORM
+  {   20.0f, 20000.0f,  9.9657843f }, // CUTOFF
+  {    0.0f,   100.0f,  0.0f       }, // RESONANCE
+  {    0.0f,   100.0f,  0.0f       }, // ENV_MOD
+  {   30.0f,  3000.0f,  6.6438562f }, // DECAY
+  {    0.0f,   100.0f,  0.0f       }, // ACCENT
+  {  -60.0f,     6.0f,  0.0f       }, // VOLUME
+  {    1.0f,  2000.0f, 10.9657843f }, // SLIDE_TIME
+  {    0.1f,    30.0f,  8.2288187f }, // NORMAL_ATTACK
+  {    0.1f,    30.0f,  8.2288187f }, // ACCENT_ATTACK
+  {   30.0f,  3000.0f,  6.6438562f }, // ACCENT_DECAY
+  { -100.0f,     0.0f,  0.0f       }, // AMP_SUSTAIN
+  {   16.0f,  3000.0f,  7.5507468f }, // AMP_DECAY
+  {    0.5f,  1000.0f, 10.9657843f }, // AMP_RELEASE
+  {   10.0f,   500.0f,  5.6438562f }, // PRE_FILTER_HIGHPASS
+  {   10.0f,   500.0f,  5.6438562f }, // FEEDBACK_HIGHPASS
+  {   10.0f,   500.0f,  5.6438562f }, // POST_FILTER_HIGHPASS
+};
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+Open303Preset::Open303Preset()
+{
+  setName("Init");
+
+  // the settings of Open303's constructor:
+  setValue(WAVEFORM,                0.0f);
+  setValue(CUTOFF,               1000.0f);
+  setValue(RESONANCE,               0.0f);
+  setValue(ENV_MOD,                25.0f);
+  setValue(DECAY,                1000.0f);
+  setValue(ACCENT,                  0.0f);
+  setValue(VOLUME,                -12.0f);
+  setValue(SLIDE_TIME,             60.0f);
+  setValue(NORMAL_ATTACK,           3.0f);
+  setValue(ACCENT_ATTACK,           3.0f);
+  setValue(ACCENT_DECAY,          200.0f);
+  setValue(AMP_SUSTAIN,          -100.0f);
+  setValue(AMP_DECAY,            1230.0f);
+  setValue(AMP_RELEASE,             1.0f);
+  setValue(PRE_FILTER_HIGHPASS,    44.486f);
+  setValue(FEEDBACK_HIGHPASS,     150.0f);
+  setValue(POST_FILTER_HIGHPASS,   24.167f);
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void Open303Preset::setName(const char *newName)
+{
+  int i = 0;
+  while( i < maxNameLength && newName[i] != 0 )
+  {
+    name[i] = newName[i];
+    i++;
+  }
+  while( i <= maxNameLength )
+    name[i++] = 0;
+}
+
+void Open303Preset::setValue(int parameter, float newValue)
+{
+  setRawValue(parameter, valueToRaw(parameter, newValue));
+}
+
+void Open303Preset::readFrom(const Open303 &synth)
+{
+  setValue(WAVEFORM,             synth.getWaveform());
+  setValue(CUTOFF,               synth.getCutoff());
+  setValue(RESONANCE,            synth.getResonance());
+  setValue(ENV_MOD,              synth.getEnvMod());
+  setValue(DECAY,                synth.getDecay());
+  setValue(ACCENT,               synth.getAccent());
+  setValue(VOLUME,               synth.getVolume());
+  setValue(SLIDE_TIME,           synth.getSlideTime());
+  setValue(NORMAL_ATTACK,        synth.getNormalAttack());
+  setValue(ACCENT_ATTACK,        synth.getAccentAttack());
+  setValue(ACCENT_DECAY,         synth.getAccentDecay());
+  setValue(AMP_SUSTAIN,          synth.getAmpSustain());
+  setValue(AMP_DECAY,            synth.getAmpDecay());
+  setValue(AMP_RELEASE,          synth.getAmpRelease());
+  setValue(PRE_FILTER_HIGHPASS,  synth.getPreFilterHighpass());
+  setValue(FEEDBACK_HIGHPASS,    synth.getFeedbackHighpass());
+  setValue(POST_FILTER_HIGHPASS, synth.getPostFilterHighpass());
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+float Open303Preset::getValue(int parameter) const
+{
+  return rawToValue(parameter, getRawValue(parameter));
+}
+
+float HOT_CODE Open303Preset::rawToValue(int parameter, uint16_t rawValue)
+{
+  if( parameter < 0 || parameter >= NUM_PARAMETERS )
+    return 0.0f;
+  const Open303ParameterRange &r = open303ParameterRanges[parameter];
+  float x = (float) rawValue * (1.0f/65535.0f);
+  if( r.octaves == 0.0f )
+    return r.min + x * (r.max-r.min);
+  else
+    return r.min * fast_exp2(x * r.octaves);
+}
+
+uint16_t Open303Preset::valueToRaw(int parameter, float value)
+{
+  if( parameter < 0 || parameter >= NUM_PARAMETERS )
+    return 0;
+  const Open303ParameterRange &r = open303ParameterRanges[parameter];
+  value = clip(value, r.min, r.max); // also maps -inf dB to the minimum
+  float x;
+  if( r.octaves == 0.0f )
+    x = (value-r.min) / (r.max-r.min);
+  else
+    x = log2f(value/r.min) / r.octaves;
+  return (uint16_t) clip(roundToInt(65535.0f*x), 0, 65535);
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void Open303Preset::applyTo(Open303 &synth) const
+{
+  for(int i=0; i<NUM_PARAMETERS; i++)
+    applyRawValue(synth, i, rawValues[i]);
+}
+
+void HOT_CODE Open303Preset::applyRawValue(Open303 &synth, int parameter, uint16_t rawValue)
+{
+  float value = rawToValue(parameter, rawValue);
+  switch( parameter )
+  {
+  case WAVEFORM:             synth.setWaveform(value);           break;
+  case CUTOFF:               synth.setCutoff(value);             break;
+  case RESONANCE:            synth.setResonance(value);          break;
+  case ENV_MOD:              synth.setEnvMod(value);             break;
+  case DECAY:                synth.setDecay(value);              break;
+  case ACCENT:               synth.setAccent(value);             break;
+  case VOLUME:               synth.setVolume(value);             break;
+  case SLIDE_TIME:           synth.setSlideTime(value);          break;
+  case NORMAL_ATTACK:        synth.setNormalAttack(value);       break;
+  case ACCENT_ATTACK:        synth.setAccentAttack(value);       break;
+  case ACCENT_DECAY:         synth.setAccentDecay(value);        break;
+  case AMP_SUSTAIN:          synth.setAmpSustain(value);         break;
+  case AMP_DECAY:            synth.setAmpDecay(value);           break;
+  case AMP_RELEASE:          synth.setAmpRelease(value);         break;
+  case PRE_FILTER_HIGHPASS:  synth.setPreFilterHighpass(value);  break;
+  case FEEDBACK_HIGHPASS:    synth.setFeedbackHighpass(value);   break;
+  case POST_FILTER_HIGHPASS: synth.setPostFilterHighpass(value); break;
+  }
+}
@@ -0,0 +1,91 @@
+#ifndef rosic_PresetBank_h
+#define rosic_PresetBank_h
+
+// rosic-indcludes:
+#include "rosic_Open303Preset.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a bank of 128 presets for the Open303 (one per MIDI program). The bank is kept as one
+  binary image in bulk memory (PSRAM, if there is one), such that it can be stored and loaded as a
+  whole, e.g. as a blob in the NVS. A program change only copies a preset, it does not touch the
+  image otherwise.
+
+  Layout of the image (all values little endian):
+
+    offset 0:  char     magic[4]       "O3PB"
+    offset 4:  uint16_t version        currently 1
+    offset 6:  uint16_t numPresets     128
+    offset 8:  uint16_t presetSize     sizeof(Open303Preset)
+    offset 10: uint16_t reserved
+    then:      numPresets presets (see Open303Preset)
+
+  */
+
+  class PresetBank
+  {
+
+  public:
+
+    /** The number of presets. */
+    static const int numPresets = 128;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. Allocates the image and fills it with the factory presets. */
+    PresetBank();
+
+    /** Destructor. */
+    ~PresetBank();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Stores a preset in the bank. */
+    void setPreset(int index, const Open303Preset &newPreset);
+
+    /** Takes over a bank image (as returned by getData). Returns false and leaves the bank as it
+    is, if the image doesn't have the layout of this version of the bank. */
+    bool setData(const void *data, int size);
+
+    /** Fills the bank with the factory presets - the first few programs are different sounds, the
+    rest are initialized. */
+    void initFactoryPresets();
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns true when the memory for the bank could be allocated. */
+    bool isValid() const { return image != NULL; }
+
+    /** Returns a preset, NULL if the index is out of range or the bank is not valid. */
+    const Open303Preset* getPreset(int index) const;
+
+    /** Returns the binary image of the bank. */
+    const void* getData() const { return image; }
+
+    /** Returns the size of the binary image in bytes. */
+    int getDataSize() const { return dataSize; }
+
+    //=============================================================================================
+
+  protected:
+
+    /** Writes the header of the image. */
+    void writeHeader();
+
+    static const int headerSize = 12;
+    static const int dataSize   = headerSize + numPresets * sizeof(Open303Preset);
+
+    uint8_t       *image;   // header and presets
+    Open303Preset *presets; // the presets inside the image
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_PresetBank_h
@@ -0,0 +1,154 @@
+#include "rosic_PresetBank.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+PresetBank::PresetBank()
+{
+  // the bank is touched only on program changes, so it goes to bulk memory:
+  image   = (uint8_t*) bulkMalloc(dataSize);
+  presets = NULL;
+  if( image != NULL )
+  {
+    presets = (Open303Preset*) (image + headerSize);
+    writeHeader();
+    initFactoryPresets();
+  }
+}
+
+PresetBank::~PresetBank()
+{
+  if( image != NULL )
+    bulkFree(image);
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void PresetBank::setPreset(int index, const Open303Preset &newPreset)
+{
+  if( presets != NULL && index >= 0 && index < numPresets )
+    presets[index] = newPreset;
+}
+
+bool PresetBank::setData(const void *data, int size)
+{
+  const uint8_t *d = (const uint8_t*) data;
+  if( image == NULL || size != dataSize || memcmp(d, "O3PB", 4) != 0 )
+    return false;
+  uint16_t version    = d[4] | (d[5] << 8);
+  uint16_t number     = d[6] | (d[7] << 8);
+  uint16_t presetSize = d[8] | (d[9] << 8);
+  if( version != 1 || number != numPresets || presetSize != sizeof(Open303Preset) )
+    return false;
+  memcpy(image, data, dataSize);
+  return true;
+}
+
+void PresetBank::initFactoryPresets()
+{
+  if( presets == NULL )
+    return;
+
+  Open303Preset init, p;
+  for(int i=0; i<numPresets; i++)
+    presets[i] = init;
+
+  // 1: high resonance, strong envelope, short decay
+  p = init;
+  p.setName("Squelch");
+  p.setValue(Open303Preset::CUTOFF,     400.0f);
+  p.setValue(Open303Preset::RESONANCE,   90.0f);
+  p.setValue(Open303Preset::ENV_MOD,     80.0f);
+  p.setValue(Open303Preset::DECAY,      300.0f);
+  p.setValue(Open303Preset::ACCENT,      80.0f);
+  presets[1] = p;
+
+  // 2: low, round bass line
+  p = init;
+  p.setName("Deep Bass");
+  p.setValue(Open303Preset::CUTOFF,     300.0f);
+  p.setValue(Open303Preset::RESONANCE,   40.0f);
+  p.setValue(Open303Preset::ENV_MOD,     30.0f);
+  p.setValue(Open303Preset::DECAY,      800.0f);
+  p.setValue(Open303Preset::ACCENT,      50.0f);
+  presets[2] = p;
+
+  // 3: square wave lead
+  p = init;
+  p.setName("Acid Lead");
+  p.setValue(Open303Preset::WAVEFORM,     1.0f);
+  p.setValue(Open303Preset::CUTOFF,     800.0f);
+  p.setValue(Open303Preset::RESONANCE,   85.0f);
+  p.setValue(Open303Preset::ENV_MOD,     60.0f);
+  p.setValue(Open303Preset::DECAY,      200.0f);
+  p.setValue(Open303Preset::ACCENT,     100.0f);
+  presets[3] = p;
+
+  // 4: full envelope sweep from a closed filter, long slides
+  p = init;
+  p.setName("Rubber");
+  p.setValue(Open303Preset::CUTOFF,     250.0f);
+  p.setValue(Open303Preset::RESONANCE,   70.0f);
+  p.setValue(Open303Preset::ENV_MOD,    100.0f);
+  p.setValue(Open303Preset::DECAY,      150.0f);
+  p.setValue(Open303Preset::SLIDE_TIME, 120.0f);
+  presets[4] = p;
+
+  // 5: open filter at self-oscillation
+  p = init;
+  p.setName("Screamer");
+  p.setValue(Open303Preset::CUTOFF,    1500.0f);
+  p.setValue(Open303Preset::RESONANCE,   95.0f);
+  p.setValue(Open303Preset::ENV_MOD,     90.0f);
+  p.setValue(Open303Preset::DECAY,      500.0f);
+  p.setValue(Open303Preset::ACCENT,     100.0f);
+  presets[5] = p;
+
+  // 6: short amplitude decay
+  p = init;
+  p.setName("Pluck");
+  p.setValue(Open303Preset::CUTOFF,     600.0f);
+  p.setValue(Open303Preset::RESONANCE,   50.0f);
+  p.setValue(Open303Preset::ENV_MOD,     70.0f);
+  p.setValue(Open303Preset::DECAY,       80.0f);
+  p.setValue(Open303Preset::AMP_DECAY,  200.0f);
+  presets[6] = p;
+
+  // 7: sustained, slowly released
+  p = init;
+  p.setName("Drone");
+  p.setValue(Open303Preset::WAVEFORM,     0.5f);
+  p.setValue(Open303Preset::CUTOFF,    2000.0f);
+  p.setValue(Open303Preset::RESONANCE,   60.0f);
+  p.setValue(Open303Preset::ENV_MOD,     10.0f);
+  p.setValue(Open303Preset::DECAY,     3000.0f);
+  p.setValue(Open303Preset::AMP_SUSTAIN, -6.0f);
+  p.setValue(Open303Preset::AMP_RELEASE, 400.0f);
+  presets[7] = p;
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+const Open303Preset* PresetBank::getPreset(int index) const
+{
+  if( presets == NULL || index < 0 || index >= numPresets )
+    return NULL;
+  return &presets[index];
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+void PresetBank::writeHeader()
+{
+  uint16_t values[4] = { 1, numPresets, sizeof(Open303Preset), 0 };
+  memcpy(image, "O3PB", 4);
+  for(int i=0; i<4; i++)
+  {
+    image[4+2*i]   = values[i] & 0xFF;
+    image[4+2*i+1] = values[i] >> 8;
+  }
+}
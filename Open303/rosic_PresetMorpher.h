@@ -0,0 +1,106 @@
+#ifndef rosic_PresetMorpher_h
+#define rosic_PresetMorpher_h
+
+// rosic-indcludes:
+#include "rosic_Open303Preset.h"
+
+namespace rosic
+{
+
+  /**
+
+  This class morphs the parameters of an Open303 between two presets A and B at control rate. It
+  is called once per block from the audio task before the synth renders the block: it interpolates
+  the raw values of both presets with the morph amount and calls the setters of the synth only for
+  the parameters whose value has changed since they were last applied - so the coefficients of
+  parameters that A and B have in common are never recomputed, and a morph that doesn't move costs
+  nothing but the comparison. The number of setter calls per block is limited (maxUpdatesPerBlock),
+  the parameters beyond the budget are applied in the next blocks (round robin), such that a
+  program change or a jump of the morph amount doesn't cause a spike in the audio task.
+
+  The presets and the morph amount are set from the control side (MIDI handlers) while update runs
+  in the audio task. A block that sees a half-copied preset applies a mixture for one block only,
+  the next block applies the complete one.
+
+  Parameters that are set on the synth directly (e.g. by a CC) keep their value until the morph
+  changes them again or preset A is set.
+
+  */
+
+  class PresetMorpher
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. The morpher is inactive until a synth and a preset have been set. */
+    PresetMorpher();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the synth to be controlled. */
+    void setSynth(Open303 *newSynth);
+
+    /** Sets preset A (morph = 0) - with no morph target set yet, it is also taken as B. All
+    parameters are applied anew, so a program change overrides what was set by CCs. */
+    void setPresetA(const Open303Preset &newPreset);
+
+    /** Sets preset B (morph = 1). */
+    void setPresetB(const Open303Preset &newPreset);
+
+    /** Sets the morph amount between preset A (0) and preset B (1). */
+    void setMorph(float newMorph);
+
+    /** Sets the maximum number of parameters applied to the synth per block (at least 1). */
+    void setMaxUpdatesPerBlock(int newMaxUpdates) { maxUpdatesPerBlock = rmax(1, newMaxUpdates); }
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the morph amount. */
+    float getMorph() const { return (float) morph / 32768.0f; }
+
+    /** Returns the current (morphed) state as a preset, named like preset A. */
+    Open303Preset getMorphedPreset() const;
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Applies the changed parameters to the synth - to be called once per block before the synth
+    renders. */
+    void update();
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Makes the next updates apply all parameters, e.g. after the synth was set from elsewhere. */
+    void reset();
+
+    //=============================================================================================
+
+  protected:
+
+    /** Returns the interpolated raw value of a parameter. */
+    INLINE uint16_t morphedRawValue(int parameter, int m) const
+    {
+      int32_t a = presetA.getRawValue(parameter);
+      int32_t b = presetB.getRawValue(parameter);
+      return (uint16_t) (a + (((b-a) * m) >> 15));
+    }
+
+    Open303       *synth;
+    Open303Preset presetA, presetB;
+    int32_t       applied[Open303Preset::NUM_PARAMETERS]; // raw values set on the synth, -1: none
+    volatile int  morph;                                  // 0...32768
+    int           maxUpdatesPerBlock;
+    int           nextParameter;                          // where the next update starts
+    bool          active, targetSet;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_PresetMorpher_h
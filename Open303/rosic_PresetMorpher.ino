@@ -0,0 +1,94 @@
+#include "rosic_PresetMorpher.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+PresetMorpher::PresetMorpher()
+{
+  synth              = NULL;
+  morph              = 0;
+  maxUpdatesPerBlock = 4;
+  nextParameter      = 0;
+  active             = false;
+  targetSet          = false;
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void PresetMorpher::setSynth(Open303 *newSynth)
+{
+  synth = newSynth;
+  reset();
+}
+
+void PresetMorpher::setPresetA(const Open303Preset &newPreset)
+{
+  presetA = newPreset;
+  if( !targetSet )
+    presetB = newPreset;
+  reset();
+  active = true;
+}
+
+void PresetMorpher::setPresetB(const Open303Preset &newPreset)
+{
+  presetB   = newPreset;
+  targetSet = true;
+}
+
+void PresetMorpher::setMorph(float newMorph)
+{
+  morph = roundToInt(32768.0f * clip(newMorph, 0.0f, 1.0f));
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+Open303Preset PresetMorpher::getMorphedPreset() const
+{
+  Open303Preset p = presetA;
+  int m = morph;
+  for(int i=0; i<Open303Preset::NUM_PARAMETERS; i++)
+    p.setRawValue(i, morphedRawValue(i, m));
+  return p;
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE PresetMorpher::update()
+{
+  if( synth == NULL || !active )
+    return;
+
+  int m      = morph;
+  int budget = maxUpdatesPerBlock;
+  int p      = nextParameter;
+  for(int k=0; k<Open303Preset::NUM_PARAMETERS; k++)
+  {
+    uint16_t v = morphedRawValue(p, m);
+    if( v != applied[p] )
+    {
+      if( budget == 0 )
+        break;                 // continued from here in the next block
+      Open303Preset::applyRawValue(*synth, p, v);
+      applied[p] = v;
+      budget--;
+    }
+    if( ++p == Open303Preset::NUM_PARAMETERS )
+      p = 0;
+  }
+  nextParameter = p;
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void PresetMorpher::reset()
+{
+  for(int i=0; i<Open303Preset::NUM_PARAMETERS; i++)
+    applied[i] = -1;
+}
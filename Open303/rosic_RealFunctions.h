@@ -148,15 +148,11 @@ namespace rosic
   
   
   INLINE float lookupTable(const float (&table)[TABLE_SIZE+1], float index ) { // lookup value in a table by float index, using linear interpolation
-    static float v1, v2, res;
-    static int32_t i;
-    static float f;
-    i = (int32_t)index;
-    f = (float)index - i;
-    v1 = (table)[i];
-    v2 = (table)[i+1];
-    res = (float)f * (float)(v2-v1) + v1;
-    return res;
+    const int32_t i  = (int32_t)index;
+    const float   f  = (float)index - i;
+    const float   v1 = (table)[i];
+    const float   v2 = (table)[i+1];
+    return (float)f * (float)(v2-v1) + v1;
   }
   
   INLINE float fclamp(float in, float min, float max){
@@ -175,6 +171,23 @@ namespace rosic
     return  (float)sign * (float)lookupTable(shaper_tbl, (x*SHAPER_LOOKUP_COEF)); // lookup table contains tanh(x), 0 <= x <= 5
   }
   
+  INLINE float fast_log2(float x) { // x must be > 0, exponent is taken from the float bits, mantissa from the table
+    union { float f; uint32_t i; } u = { x };
+    const int32_t expo = (int32_t)((u.i >> 23) & 0xFF) - 127;
+    const float mant = (float)(u.i & 0x007FFFFF) * (float)(TABLE_SIZE / 8388608.0f);
+    return (float)expo + lookupTable(log2_tbl, mant);
+  }
+
+  INLINE float fast_exp2(float x) {
+    if (x < -126.0f) return 0.0f;
+    if (x > 127.0f) x = 127.0f;
+    const int32_t expo = (int32_t)floorf(x);
+    union { float f; uint32_t i; } u;
+    u.f = lookupTable(exp2_tbl, ((float)x - expo) * TABLE_SIZE); // 1.0 ... 2.0
+    u.i += (uint32_t)expo << 23;
+    return u.f;
+  }
+  
   INLINE float fast_sin(const float x) {
     const float argument = (((float)x * (float)ONE_DIV_2PI) * TABLE_SIZE);
     const float res = lookupTable(sin_tbl, CYCLE_INDEX(argument)+((float)argument-(int32_t)argument));
@@ -0,0 +1,112 @@
+#ifndef rosic_SampleBank_h
+#define rosic_SampleBank_h
+
+#include <stdint.h>
+
+#if defined(ESP_PLATFORM)
+#include "esp_partition.h"
+#include "esp_idf_version.h"
+#endif
+
+namespace rosic
+{
+
+  /**
+
+  This is a read-only bank of 16 bit mono samples that is used in place - the sample data is never
+  copied into RAM. On the ESP32, the bank lives in a data partition of the flash which is mapped
+  into the address space via esp_partition_mmap (the flash cache fetches the data on access). On
+  other platforms, the bank is a file which is mapped via mmap, such that the same code can be run
+  and tested on a host. The bank is built on a host from WAV files (host/drum_bank.cpp).
+
+  Layout of the bank (all values little endian):
+
+    offset 0:  char     magic[4]       "O3DS"
+    offset 4:  uint16_t version        currently 1
+    offset 6:  uint16_t numSamples
+    offset 8:  numSamples entries of
+                 uint32_t dataOffset   byte offset of the sample data from the start of the bank,
+                                       must be even
+                 uint32_t numFrames    length of the sample in frames
+                 uint32_t sampleRate   the rate at which the sample was recorded
+                 uint32_t reserved
+    then:      int16_t sample data
+
+  */
+
+  class SampleBank
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    SampleBank();
+
+    /** Destructor - unmaps the bank. */
+    ~SampleBank();
+
+    //---------------------------------------------------------------------------------------------
+    // setup:
+
+    /** Maps the bank into memory. On the ESP32, the name is the label of the data partition, on
+    the host, it is a file path. Returns true when the bank was mapped and has a valid layout. */
+    bool open(const char* name);
+
+    /** Unmaps the bank. */
+    void close();
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns true when a valid bank is mapped. */
+    bool isOpen() const { return numSamples > 0; }
+
+    /** Returns the number of samples in the bank. */
+    int getNumSamples() const { return numSamples; }
+
+    /** Returns a pointer to the (memory mapped) data of a sample - NULL if index is out of
+    range. */
+    const int16_t* getSampleData(int index) const;
+
+    /** Returns the length of a sample in frames - 0 if index is out of range. */
+    uint32_t getSampleLength(int index) const;
+
+    /** Returns the sample-rate at which a sample was recorded. */
+    float getSampleRate(int index) const;
+
+    //=============================================================================================
+
+  protected:
+
+    struct Entry
+    {
+      uint32_t dataOffset;
+      uint32_t numFrames;
+      uint32_t sampleRate;
+      uint32_t reserved;
+    };
+
+    /** Checks the header and the sample table of the mapped bank. */
+    bool validate();
+
+    const uint8_t* base;       // start of the mapped bank
+    uint32_t       size;       // size of the mapped region in bytes
+    const Entry*   entries;    // the sample table inside the mapped region
+    int            numSamples; // number of samples, 0 when nothing valid is mapped
+
+#if defined(ESP_PLATFORM)
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_mmap_handle_t mmapHandle;
+#else
+    spi_flash_mmap_handle_t     mmapHandle;
+#endif
+#endif
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_SampleBank_h
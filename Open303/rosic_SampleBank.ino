@@ -0,0 +1,146 @@
+#include "rosic_SampleBank.h"
+using namespace rosic;
+
+#if !defined(ESP_PLATFORM)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+SampleBank::SampleBank()
+{
+  base       = NULL;
+  size       = 0;
+  entries    = NULL;
+  numSamples = 0;
+}
+
+SampleBank::~SampleBank()
+{
+  close();
+}
+
+//-------------------------------------------------------------------------------------------------
+// setup:
+
+bool SampleBank::open(const char* name)
+{
+  close();
+
+#if defined(ESP_PLATFORM)
+  const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+    ESP_PARTITION_SUBTYPE_ANY, name);
+  if( partition == NULL )
+    return false;
+
+  const void* mapped = NULL;
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+    &mapped, &mmapHandle);
+#else
+  esp_err_t err = esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA,
+    &mapped, &mmapHandle);
+#endif
+  if( err != ESP_OK )
+    return false;
+  size = partition->size;
+#else
+  int fd = ::open(name, O_RDONLY);
+  if( fd < 0 )
+    return false;
+  struct stat st;
+  if( fstat(fd, &st) != 0 || st.st_size <= 0 )
+  {
+    ::close(fd);
+    return false;
+  }
+  void* mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping stays valid
+  if( mapped == MAP_FAILED )
+    return false;
+  size = (uint32_t)st.st_size;
+#endif
+
+  base = (const uint8_t*) mapped;
+  if( !validate() )
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void SampleBank::close()
+{
+  if( base != NULL )
+  {
+#if defined(ESP_PLATFORM)
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_munmap(mmapHandle);
+#else
+    spi_flash_munmap(mmapHandle);
+#endif
+#else
+    munmap((void*) base, size);
+#endif
+  }
+  base       = NULL;
+  size       = 0;
+  entries    = NULL;
+  numSamples = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+const int16_t* SampleBank::getSampleData(int index) const
+{
+  if( index < 0 || index >= numSamples )
+    return NULL;
+  return (const int16_t*) (base + entries[index].dataOffset);
+}
+
+uint32_t SampleBank::getSampleLength(int index) const
+{
+  if( index < 0 || index >= numSamples )
+    return 0;
+  return entries[index].numFrames;
+}
+
+float SampleBank::getSampleRate(int index) const
+{
+  if( index < 0 || index >= numSamples )
+    return SAMPLE_RATE;
+  return (float) entries[index].sampleRate;
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+bool SampleBank::validate()
+{
+  if( size < 8 || base[0] != 'O' || base[1] != '3' || base[2] != 'D' || base[3] != 'S' )
+    return false;
+
+  uint16_t version = base[4] | (base[5] << 8);
+  uint16_t count   = base[6] | (base[7] << 8);
+  if( version != 1 || (uint32_t)8 + (uint32_t)count * sizeof(Entry) > size )
+    return false;
+
+  const Entry* table = (const Entry*) (base + 8);
+  for(int i=0; i<count; i++)
+  {
+    // numFrames * 2 could overflow - compare the frames against what fits behind the offset:
+    if( (table[i].dataOffset & 1) != 0 || table[i].numFrames < 2 || table[i].sampleRate == 0
+      || table[i].dataOffset > size || table[i].numFrames > (size - table[i].dataOffset) / 2 )
+      return false;
+  }
+
+  entries    = table;
+  numSamples = count;
+  return true;
+}
@@ -0,0 +1,97 @@
+#ifndef rosic_StereoPanner_h
+#define rosic_StereoPanner_h
+
+// rosic-indcludes:
+#include "rosic_RealFunctions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This places a mono voice into the stereo mix. The position is set by an equal-power pan law
+  (pan_tbl, unity gain in the center) and the width by a side signal which is a short delayed copy
+  of the voice (Haas effect): it is added to the left and subtracted from the right channel, so the
+  image widens while the sum of both channels stays the mono signal.
+
+  The output is added to a block of interleaved stereo frames (left, right, left, ...) - the format
+  of the I2S output - so the voices are mixed directly into the master buffer. Changes of pan and
+  width ramp linearly over the next block.
+
+  */
+
+  class StereoPanner
+  {
+
+  public:
+
+    /** The length of the delay line in samples (a power of 2). */
+    static const int maxDelay = 512;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. The voice is centered and has no width. */
+    StereoPanner();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample-rate. */
+    void setSampleRate(float newSampleRate);
+
+    /** Sets the position from -1 (left) over 0 (center) to +1 (right). */
+    void setPan(float newPan);
+
+    /** Sets the width from 0 (mono) to 1. */
+    void setWidth(float newWidth);
+
+    /** Sets the delay of the side signal in milliseconds (about 5...15 ms work well). */
+    void setDelay(float newDelay);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the position (-1...+1). */
+    float getPan() const { return pan; }
+
+    /** Returns the width (0...1). */
+    float getWidth() const { return width; }
+
+    /** Returns the delay of the side signal in milliseconds. */
+    float getDelay() const { return delay; }
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Adds a block of the mono input to the interleaved stereo frames. */
+    void processBlock(const float *in, float *frames, int length);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Clears the delay line. */
+    void reset();
+
+    //=============================================================================================
+
+  protected:
+
+    /** Calculates the target gains from pan and width. */
+    void calculateGains();
+
+    /** Calculates the length of the delay in samples. */
+    void calculateDelay();
+
+    float pan, width, delay, sampleRate;   // user parameters
+    float targetL, targetR, targetSide;    // gains the next block ramps to
+    float gainL, gainR, gainSide;          // gains at the end of the previous block
+    int   delaySamples, writeIndex;
+
+    float delayLine[maxDelay];
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_StereoPanner_h
@@ -0,0 +1,116 @@
+#include "rosic_StereoPanner.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+StereoPanner::StereoPanner()
+{
+  sampleRate = SAMPLE_RATE;
+  pan        = 0.0f;
+  width      = 0.0f;
+  delay      = 8.0f;
+  calculateGains();
+  calculateDelay();
+  gainL      = targetL;
+  gainR      = targetR;
+  gainSide   = targetSide;
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void StereoPanner::setSampleRate(float newSampleRate)
+{
+  if( newSampleRate > 0.0f )
+  {
+    sampleRate = newSampleRate;
+    calculateDelay();
+  }
+}
+
+void StereoPanner::setPan(float newPan)
+{
+  pan = clip(newPan, -1.0f, 1.0f);
+  calculateGains();
+}
+
+void StereoPanner::setWidth(float newWidth)
+{
+  width = clip(newWidth, 0.0f, 1.0f);
+  calculateGains();
+}
+
+void StereoPanner::setDelay(float newDelay)
+{
+  if( newDelay >= 0.0f )
+  {
+    delay = newDelay;
+    calculateDelay();
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE StereoPanner::processBlock(const float *in, float *frames, int length)
+{
+  // local copies, the gains ramp from where the previous block ended to the targets:
+  const float scale = 1.0f / (float) length;
+  float gl = gainL, gr = gainR, gs = gainSide;
+  float il = (targetL    - gl) * scale;
+  float ir = (targetR    - gr) * scale;
+  float is = (targetSide - gs) * scale;
+  int   w  = writeIndex;
+  int   r  = (w - delaySamples) & (maxDelay-1);
+
+  for(int n=0; n<length; n++)
+  {
+    float x        = in[n];
+    delayLine[w]   = x;
+    gl            += il;
+    gr            += ir;
+    gs            += is;
+    float s        = gs * delayLine[r];
+    frames[2*n]   += gl * (x + s);
+    frames[2*n+1] += gr * (x - s);
+    w              = (w+1) & (maxDelay-1);
+    r              = (r+1) & (maxDelay-1);
+  }
+
+  writeIndex = w;
+  gainL      = gl;
+  gainR      = gr;
+  gainSide   = gs;
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void StereoPanner::reset()
+{
+  for(int i=0; i<maxDelay; i++)
+    delayLine[i] = 0.0f;
+  writeIndex = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+void StereoPanner::calculateGains()
+{
+  // the right gain is the left one mirrored, interpolated between the same two table entries:
+  float index = 0.5f * (pan + 1.0f) * TABLE_SIZE;
+  int   i     = rmin((int) index, (int) TABLE_SIZE - 1);
+  int   j     = (int) TABLE_SIZE - i;
+  float f     = index - i;
+  targetL     = pan_tbl[i] + f * (pan_tbl[i+1] - pan_tbl[i]);
+  targetR     = pan_tbl[j] + f * (pan_tbl[j-1] - pan_tbl[j]);
+  targetSide  = 0.5f * width;
+}
+
+void StereoPanner::calculateDelay()
+{
+  delaySamples = clip(roundToInt(0.001f * delay * sampleRate), 1, maxDelay-1);
+}
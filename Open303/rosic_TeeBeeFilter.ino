@@ -78,7 +78,7 @@ void TeeBeeFilter::setMode(int newMode)
 //-------------------------------------------------------------------------------------------------
 // others:
 
-void TeeBeeFilter::reset()
+void HOT_CODE TeeBeeFilter::reset()
 {
   feedbackHighpass.reset();
   y1 = 0.0f;
@@ -0,0 +1,100 @@
+#ifndef rosic_Transport_h
+#define rosic_Transport_h
+
+// rosic-indcludes:
+#include "rosic_RealFunctions.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is the master clock of the box - a 64 bit count of the samples that have been rendered,
+  advanced by the audio task after each block, and a 24 ppqn tick grid in sample time which is
+  derived from it. Other tasks poll the ticks via pollTick(), so whatever they trigger (the
+  jukebox steps, the outgoing MIDI clock) cannot drift against the audio clock, no matter how late
+  the polling task gets to run: a late tick is caught up and the next one is still due at its own
+  time. The events themselves take effect when the polling task gets to them, though, so each one
+  is late by up to the polling period (of loop()) - the ticks don't accumulate that lateness, but
+  they jitter by it. The tick times are kept as fractional sample positions, so no tempo is
+  rounded.
+
+  The sample count is written by the audio task only and read with a sequence counter, such that
+  readers on the other core never see a torn 64 bit value.
+
+  */
+
+  class Transport
+  {
+
+  public:
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    Transport();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the sample-rate. */
+    void setSampleRate(float newSampleRate);
+
+    /** Sets the tempo in BPM - it takes effect from the next tick on. */
+    void setTempo(float newTempo);
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the number of samples rendered so far. */
+    uint64_t getSampleTime() const;
+
+    /** Returns the tempo in BPM. */
+    float getTempo() const { return bpm; }
+
+    /** Returns true between start() and stop(). */
+    bool isPlaying() const { return playing; }
+
+    /** Returns the number of ticks since the last start. */
+    uint32_t getTickCount() const { return tickCount; }
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Advances the sample count - to be called by the audio task after each block. */
+    void advance(int numSamples);
+
+    //---------------------------------------------------------------------------------------------
+    // event handling:
+
+    /** Starts the tick grid at the current sample time. */
+    void start();
+
+    /** Stops the ticks. */
+    void stop();
+
+    /** Returns true when the sample time has passed the next tick - that tick is then consumed.
+    Call it until it returns false to catch up with all ticks that are due. */
+    bool pollTick();
+
+    static const int ticksPerQuarter = 24;
+
+    //=============================================================================================
+
+  protected:
+
+    volatile uint32_t sampleTimeLo, sampleTimeHi; // the sample count, split for the writer
+    volatile uint32_t sequence;                   // odd while the writer updates the count
+    double            nextTickTime;               // in samples
+    double            samplesPerTick;
+    uint32_t          tickCount;
+    float             bpm;
+    float             sampleRate;
+    bool              playing;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_Transport_h
@@ -0,0 +1,89 @@
+#include "rosic_Transport.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+Transport::Transport()
+{
+  sampleTimeLo = 0;
+  sampleTimeHi = 0;
+  sequence     = 0;
+  nextTickTime = 0.0;
+  tickCount    = 0;
+  playing      = false;
+  sampleRate   = SAMPLE_RATE;
+  setTempo(130.0f);
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void Transport::setSampleRate(float newSampleRate)
+{
+  if( newSampleRate > 0.0f )
+  {
+    sampleRate = newSampleRate;
+    setTempo(bpm);
+  }
+}
+
+void Transport::setTempo(float newTempo)
+{
+  if( newTempo > 0.0f )
+  {
+    bpm            = newTempo;
+    samplesPerTick = 60.0 * sampleRate / ((double)bpm * ticksPerQuarter);
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+uint64_t Transport::getSampleTime() const
+{
+  uint32_t seq, lo, hi;
+  do
+  {
+    seq = sequence;
+    lo  = sampleTimeLo;
+    hi  = sampleTimeHi;
+  } while( (seq & 1) != 0 || seq != sequence );
+  return ((uint64_t)hi << 32) | lo;
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE Transport::advance(int numSamples)
+{
+  uint64_t t = (((uint64_t)sampleTimeHi << 32) | sampleTimeLo) + (uint64_t)numSamples;
+  sequence++;
+  sampleTimeLo = (uint32_t)t;
+  sampleTimeHi = (uint32_t)(t >> 32);
+  sequence++;
+}
+
+//-------------------------------------------------------------------------------------------------
+// event handling:
+
+void Transport::start()
+{
+  nextTickTime = (double)getSampleTime();
+  tickCount    = 0;
+  playing      = true;
+}
+
+void Transport::stop()
+{
+  playing = false;
+}
+
+bool Transport::pollTick()
+{
+  if( !playing || (double)getSampleTime() < nextTickTime )
+    return false;
+  nextTickTime += samplesPerTick;
+  tickCount++;
+  return true;
+}
@@ -0,0 +1,104 @@
+#ifndef rosic_TuningTable_h
+#define rosic_TuningTable_h
+
+// rosic-indcludes:
+#include "rosic_FunctionTemplates.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is the table of the frequencies of the 128 MIDI notes, such that triggering a note is a
+  lookup instead of an exponential. The table is only rebuilt when the tuning changes: the master
+  tuning, the scale or the keyboard mapping.
+
+  The scale and the keyboard mapping are given in the formats of Scala (.scl and .kbm files, see
+  https://www.huygens-fokker.org/scala/scl_format.html), as text - wherever it comes from. Without
+  them, the table is 12 tone equal temperament with A4 (note 69) at the master tuning. With a
+  keyboard mapping, its reference frequency is meant for a master tuning of 440 Hz, other master
+  tunings scale the whole table. Keys that the mapping leaves out have the frequency 0 (see
+  isMapped).
+
+  */
+
+  class TuningTable
+  {
+
+  public:
+
+    /** The maximum number of degrees of a scale. */
+    static const int maxScaleSize = 128;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. Sets up 12 tone equal temperament at 440 Hz. */
+    TuningTable();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Sets the master tuning, the frequency of A4 (in Hz). */
+    void setMasterTuneA4(float newTuning);
+
+    /** Sets a scale from the text of a Scala .scl file. Returns false and leaves the tuning as it
+    is when the text is not a valid scale. */
+    bool setScale(const char *sclText);
+
+    /** Sets a keyboard mapping from the text of a Scala .kbm file. Returns false and leaves the
+    tuning as it is when the text is not a valid mapping. */
+    bool setKeyboardMapping(const char *kbmText);
+
+    /** Goes back to 12 tone equal temperament (the keyboard mapping is kept). */
+    void setEqualTemperament();
+
+    /** Goes back to the default keyboard mapping: consecutive keys play consecutive degrees, the
+    scale starts at note 60 and note 69 is at 440 Hz. */
+    void resetKeyboardMapping();
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the frequency of a note (in Hz), 0 for a key that is not mapped. */
+    INLINE float getFrequency(int note) const { return freqs[clip(note, 0, 127)]; }
+
+    /** Returns false for the keys that the keyboard mapping leaves out. */
+    bool isMapped(int note) const { return getFrequency(note) > 0.0f; }
+
+    /** Returns the master tuning (in Hz). */
+    float getMasterTuneA4() const { return masterTune; }
+
+    /** Returns the number of degrees of the scale. */
+    int getScaleSize() const { return scaleSize; }
+
+    //=============================================================================================
+
+  protected:
+
+    /** Finds the scale degree of a note, returns false for a key that is not mapped. */
+    bool noteToDegree(int note, int &degree) const;
+
+    /** Returns the frequency ratio of a scale degree (relative to degree 0). */
+    double degreeToRatio(int degree) const;
+
+    /** Rebuilds the table. */
+    void updateTable();
+
+    float   freqs[128];
+    float   masterTune;
+
+    // the scale, ratios[0] is 1/1, ratios[scaleSize] the period (usually the octave):
+    float   ratios[maxScaleSize+1];
+    int     scaleSize;
+
+    // the keyboard mapping, mapSize 0 is the linear mapping, -1 in mapping is an unmapped key:
+    int16_t mapping[128];
+    int     mapSize, firstNote, lastNote, middleNote, referenceNote, octaveDegree;
+    float   referenceFreq;
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_TuningTable_h
@@ -0,0 +1,249 @@
+#include "rosic_TuningTable.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// Scala text parsing:
+
+/** Returns the next line that is not a comment (comments start with '!') and advances text to the
+line after it - false at the end of the text. */
+static bool scalaNextLine(const char *&text, const char *&line)
+{
+  while( *text != 0 )
+  {
+    line = text;
+    while( *text != 0 && *text != '\n' )
+      text++;
+    if( *text == '\n' )
+      text++;
+    if( *line != '!' )
+      return true;
+  }
+  return false;
+}
+
+/** Like scalaNextLine, but also skips blank lines and leading white space. */
+static bool scalaNextValue(const char *&text, const char *&value)
+{
+  while( scalaNextLine(text, value) )
+  {
+    while( *value == ' ' || *value == '\t' )
+      value++;
+    if( *value != '\n' && *value != '\r' && *value != 0 )
+      return true;
+  }
+  return false;
+}
+
+/** Reads an integer, returns false when there is none. */
+static bool scalaParseInt(const char *value, int &result)
+{
+  char *end;
+  long v = strtol(value, &end, 10);
+  if( end == value )
+    return false;
+  result = (int) v;
+  return true;
+}
+
+/** Reads a pitch of a scale - in cents when it has a period, otherwise a ratio like 3/2 or 2. */
+static bool scalaParsePitch(const char *value, double &ratio)
+{
+  const char *p = value;
+  while( *p != 0 && *p != '\n' && *p != '\r' && *p != ' ' && *p != '\t' && *p != '.' )
+    p++;
+  char *end;
+  if( *p == '.' )
+  {
+    double cents = strtod(value, &end);
+    if( end == value )
+      return false;
+    ratio = pow(2.0, cents/1200.0);
+  }
+  else
+  {
+    long numerator = strtol(value, &end, 10), denominator = 1;
+    if( end == value )
+      return false;
+    if( *end == '/' )
+    {
+      const char *d = end+1;
+      denominator = strtol(d, &end, 10);
+      if( end == d )
+        return false;
+    }
+    if( numerator <= 0 || denominator <= 0 )
+      return false;
+    ratio = (double) numerator / (double) denominator;
+  }
+  return ratio > 0.0;
+}
+
+/** Integer division that rounds towards minus infinity. */
+static int floorDivide(int a, int b)
+{
+  int q = a / b;
+  return (a % b != 0 && (a < 0) != (b < 0)) ? q-1 : q;
+}
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+TuningTable::TuningTable()
+{
+  masterTune = 440.0f;
+  scaleSize  = 1;     // a valid scale for the first update, replaced right away
+  ratios[0]  = 1.0f;
+  ratios[1]  = 2.0f;
+  resetKeyboardMapping();
+  setEqualTemperament();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void TuningTable::setMasterTuneA4(float newTuning)
+{
+  if( newTuning > 0.0f )
+  {
+    masterTune = newTuning;
+    updateTable();
+  }
+}
+
+bool TuningTable::setScale(const char *sclText)
+{
+  const char *text = sclText, *line;
+  int newSize;
+  if( !scalaNextLine(text, line) )                       // the description (may be blank)
+    return false;
+  if( !scalaNextValue(text, line) || !scalaParseInt(line, newSize) )
+    return false;
+  if( newSize < 1 || newSize > maxScaleSize )
+    return false;
+
+  double newRatios[maxScaleSize+1];
+  newRatios[0] = 1.0;
+  for(int i=1; i<=newSize; i++)
+  {
+    if( !scalaNextValue(text, line) || !scalaParsePitch(line, newRatios[i]) )
+      return false;
+  }
+
+  scaleSize = newSize;
+  for(int i=0; i<=scaleSize; i++)
+    ratios[i] = (float) newRatios[i];
+  updateTable();
+  return true;
+}
+
+bool TuningTable::setKeyboardMapping(const char *kbmText)
+{
+  const char *text = kbmText, *line;
+  int v[5], newOctaveDegree;
+  double newReferenceFreq;
+  for(int i=0; i<5; i++)                                 // size, first, last, middle, reference
+  {
+    if( !scalaNextValue(text, line) || !scalaParseInt(line, v[i]) )
+      return false;
+  }
+  if( !scalaNextValue(text, line) )
+    return false;
+  newReferenceFreq = strtod(line, NULL);
+  if( !scalaNextValue(text, line) || !scalaParseInt(line, newOctaveDegree) )
+    return false;
+  if( v[0] < 0 || v[0] > 128 || newReferenceFreq <= 0.0 || newOctaveDegree < 0 )
+    return false;
+  for(int i=1; i<5; i++)
+  {
+    if( v[i] < 0 || v[i] > 127 )
+      return false;
+  }
+
+  // the entries of the mapping, the ones that are missing are unmapped:
+  int16_t newMapping[128];
+  for(int i=0; i<v[0]; i++)
+  {
+    int degree;
+    if( !scalaNextValue(text, line) || *line == 'x' || !scalaParseInt(line, degree) )
+      newMapping[i] = -1;
+    else if( degree < 0 || degree > 32767 )
+      return false;
+    else
+      newMapping[i] = (int16_t) degree;
+  }
+
+  mapSize       = v[0];
+  firstNote     = v[1];
+  lastNote      = v[2];
+  middleNote    = v[3];
+  referenceNote = v[4];
+  referenceFreq = (float) newReferenceFreq;
+  octaveDegree  = newOctaveDegree;
+  for(int i=0; i<mapSize; i++)
+    mapping[i] = newMapping[i];
+  updateTable();
+  return true;
+}
+
+void TuningTable::setEqualTemperament()
+{
+  scaleSize = 12;
+  for(int i=0; i<=scaleSize; i++)
+    ratios[i] = (float) pow(2.0, i/12.0);
+  updateTable();
+}
+
+void TuningTable::resetKeyboardMapping()
+{
+  mapSize       = 0;
+  firstNote     = 0;
+  lastNote      = 127;
+  middleNote    = 60;
+  referenceNote = 69;
+  referenceFreq = 440.0f;
+  octaveDegree  = 12;
+  updateTable();
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+bool TuningTable::noteToDegree(int note, int &degree) const
+{
+  if( mapSize == 0 )
+  {
+    degree = note - middleNote;
+    return true;
+  }
+  int distance = note - middleNote;
+  int octave   = floorDivide(distance, mapSize);
+  int entry    = mapping[distance - octave*mapSize];
+  if( entry < 0 )
+    return false;
+  degree = octave*octaveDegree + entry;
+  return true;
+}
+
+double TuningTable::degreeToRatio(int degree) const
+{
+  int period = floorDivide(degree, scaleSize);
+  return pow((double) ratios[scaleSize], period) * ratios[degree - period*scaleSize];
+}
+
+void TuningTable::updateTable()
+{
+  // the reference note sounds at the reference frequency, even when it is not mapped itself:
+  int referenceDegree;
+  if( !noteToDegree(referenceNote, referenceDegree) )
+    referenceDegree = referenceNote - middleNote;
+  double scaler = referenceFreq * (masterTune/440.0) / degreeToRatio(referenceDegree);
+
+  for(int note=0; note<128; note++)
+  {
+    int degree;
+    if( note < firstNote || note > lastNote || !noteToDegree(note, degree) )
+      freqs[note] = 0.0f;
+    else
+      freqs[note] = (float) (scaler * degreeToRatio(degree));
+  }
+}
@@ -0,0 +1,121 @@
+#ifndef rosic_WaveBank_h
+#define rosic_WaveBank_h
+
+#include <stdint.h>
+
+// rosic-indcludes:
+#include "rosic_MipMappedWaveTable.h"
+
+#if defined(ESP_PLATFORM)
+#include "esp_partition.h"
+#include "esp_idf_version.h"
+#endif
+
+namespace rosic
+{
+
+  /**
+
+  This is a read-only bank of user waveforms for the oscillator, stored as precomputed mip-maps
+  (see MipMappedWaveTable::getMipMap), such that switching to one of them is a copy into the
+  wavetable (MipMappedWaveTable::setMipMap) - no resampling and no FFT at runtime. The bank is
+  built on a host from single cycle WAV files (host/wave_bank.cpp). Like the SampleBank, it is
+  used in place: on the ESP32 it lives in a data partition of the flash which is mapped via
+  esp_partition_mmap, on other platforms it is a file which is mapped via mmap.
+
+  Layout of the bank (all values little endian):
+
+    offset 0:  char     magic[4]       "O3WT"
+    offset 4:  uint16_t version        currently 1
+    offset 6:  uint16_t numWaves
+    offset 8:  uint16_t tableLength    must match MipMappedWaveTable (512)
+    offset 10: uint16_t numTables      must match MipMappedWaveTable (12)
+    offset 12: uint32_t reserved
+    offset 16: numWaves entries of
+                 char     name[24]     zero terminated, for display
+                 float    scale        the 16 bit values times scale are the waveform
+                 uint32_t dataOffset   byte offset of the mip-map from the start of the bank,
+                                       must be even
+    then:      int16_t mip-maps, numTables*tableLength values each, table by table
+
+  */
+
+  class WaveBank
+  {
+
+  public:
+
+    /** The maximum length of a name, including the terminating zero. */
+    static const int nameLength = 24;
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    WaveBank();
+
+    /** Destructor - unmaps the bank. */
+    ~WaveBank();
+
+    //---------------------------------------------------------------------------------------------
+    // setup:
+
+    /** Maps the bank into memory. On the ESP32, the name is the label of the data partition, on
+    the host, it is a file path. Returns true when the bank was mapped and has a valid layout that
+    fits the wavetables of this build. */
+    bool open(const char* name);
+
+    /** Unmaps the bank. */
+    void close();
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns true when a valid bank is mapped. */
+    bool isOpen() const { return numWaves > 0; }
+
+    /** Returns the number of waveforms in the bank. */
+    int getNumWaves() const { return numWaves; }
+
+    /** Returns the name of a waveform - an empty string if index is out of range. */
+    const char* getName(int index) const;
+
+    /** Returns the factor for the 16 bit values of a waveform. */
+    float getScale(int index) const;
+
+    /** Returns a pointer to the (memory mapped) mip-map of a waveform, for
+    MipMappedWaveTable::setMipMap - NULL if index is out of range. */
+    const int16_t* getMipMap(int index) const;
+
+    //=============================================================================================
+
+  protected:
+
+    struct Entry
+    {
+      char     name[nameLength];
+      float    scale;
+      uint32_t dataOffset;
+    };
+
+    /** Checks the header and the wave table of the mapped bank. */
+    bool validate();
+
+    const uint8_t* base;       // start of the mapped bank
+    uint32_t       size;       // size of the mapped region in bytes
+    const Entry*   entries;    // the wave table inside the mapped region
+    int            numWaves;   // number of waveforms, 0 when nothing valid is mapped
+
+#if defined(ESP_PLATFORM)
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_mmap_handle_t mmapHandle;
+#else
+    spi_flash_mmap_handle_t     mmapHandle;
+#endif
+#endif
+
+  };
+
+} // end namespace rosic
+
+#endif // rosic_WaveBank_h
@@ -0,0 +1,153 @@
+#include "rosic_WaveBank.h"
+using namespace rosic;
+
+#if !defined(ESP_PLATFORM)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+WaveBank::WaveBank()
+{
+  base     = NULL;
+  size     = 0;
+  entries  = NULL;
+  numWaves = 0;
+}
+
+WaveBank::~WaveBank()
+{
+  close();
+}
+
+//-------------------------------------------------------------------------------------------------
+// setup:
+
+bool WaveBank::open(const char* name)
+{
+  close();
+
+#if defined(ESP_PLATFORM)
+  const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+    ESP_PARTITION_SUBTYPE_ANY, name);
+  if( partition == NULL )
+    return false;
+
+  const void* mapped = NULL;
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA,
+    &mapped, &mmapHandle);
+#else
+  esp_err_t err = esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA,
+    &mapped, &mmapHandle);
+#endif
+  if( err != ESP_OK )
+    return false;
+  size = partition->size;
+#else
+  int fd = ::open(name, O_RDONLY);
+  if( fd < 0 )
+    return false;
+  struct stat st;
+  if( fstat(fd, &st) != 0 || st.st_size <= 0 )
+  {
+    ::close(fd);
+    return false;
+  }
+  void* mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // the mapping stays valid
+  if( mapped == MAP_FAILED )
+    return false;
+  size = (uint32_t)st.st_size;
+#endif
+
+  base = (const uint8_t*) mapped;
+  if( !validate() )
+  {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void WaveBank::close()
+{
+  if( base != NULL )
+  {
+#if defined(ESP_PLATFORM)
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_munmap(mmapHandle);
+#else
+    spi_flash_munmap(mmapHandle);
+#endif
+#else
+    munmap((void*) base, size);
+#endif
+  }
+  base     = NULL;
+  size     = 0;
+  entries  = NULL;
+  numWaves = 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// inquiry:
+
+const char* WaveBank::getName(int index) const
+{
+  if( index < 0 || index >= numWaves )
+    return "";
+  return entries[index].name;
+}
+
+float WaveBank::getScale(int index) const
+{
+  if( index < 0 || index >= numWaves )
+    return 0.0f;
+  return entries[index].scale;
+}
+
+const int16_t* WaveBank::getMipMap(int index) const
+{
+  if( index < 0 || index >= numWaves )
+    return NULL;
+  return (const int16_t*) (base + entries[index].dataOffset);
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+bool WaveBank::validate()
+{
+  if( size < 16 || base[0] != 'O' || base[1] != '3' || base[2] != 'W' || base[3] != 'T' )
+    return false;
+
+  uint16_t version     = base[4]  | (base[5]  << 8);
+  uint16_t count       = base[6]  | (base[7]  << 8);
+  uint16_t tableLength = base[8]  | (base[9]  << 8);
+  uint16_t numTables   = base[10] | (base[11] << 8);
+  if( version != 1 || (uint32_t)16 + (uint32_t)count * sizeof(Entry) > size )
+    return false;
+
+  // the mip-maps are copied as they are, so they must have the layout of this build:
+  if( tableLength != MipMappedWaveTable::getTableLength()
+    || numTables != MipMappedWaveTable::getNumTables() )
+    return false;
+  uint32_t bytes = (uint32_t) MipMappedWaveTable::getMipMapSize() * 2;
+
+  const Entry* table = (const Entry*) (base + 16);
+  for(int i=0; i<count; i++)
+  {
+    if( (table[i].dataOffset & 1) != 0 || table[i].dataOffset > size
+      || bytes > size - table[i].dataOffset || table[i].name[nameLength-1] != 0 )
+      return false;
+  }
+
+  entries  = table;
+  numWaves = count;
+  return true;
+}
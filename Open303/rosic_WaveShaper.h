@@ -0,0 +1,172 @@
+#ifndef rosic_WaveShaper_h
+#define rosic_WaveShaper_h
+
+// rosic-indcludes:
+#include "rosic_RealFunctions.h"
+#include "rosic_FunctionTemplates.h"
+
+namespace rosic
+{
+
+  /**
+
+  This is a waveshaping distortion with first-order antiderivative anti-aliasing (ADAA). Instead of
+  evaluating the transfer curve f(x) at each sample, it evaluates the difference quotient of its
+  antiderivative F(x) between the current and the previous input sample, which suppresses the
+  aliasing of the generated overtones without oversampling.
+
+  The transfer curves are odd-symmetric and stored as lookup tables over 0...xMax with TABLE_SIZE+1
+  points (the tanh curve is the global shaper_tbl). The curve between the points is linearly
+  interpolated, so the antiderivative is piecewise quadratic and can be evaluated exactly from a
+  second table which holds the integral up to each point.
+
+  */
+
+  class WaveShaper
+  {
+
+  public:
+
+    /** Enumeration of the available transfer curves. */
+    enum modes
+    {
+      TANH = 0,
+      HARDCLIP,
+      FOLDBACK,
+
+      NUM_MODES
+    };
+
+    //---------------------------------------------------------------------------------------------
+    // construction/destruction:
+
+    /** Constructor. */
+    WaveShaper();
+
+    //---------------------------------------------------------------------------------------------
+    // parameter settings:
+
+    /** Selects the transfer curve @see modes. */
+    void setMode(int newMode);
+
+    /** Sets the gain in front of the shaper (in dB). */
+    void setDrive(float newDrive);
+
+    /** Sets the gain after the shaper (in dB). */
+    void setOutputLevel(float newLevel);
+
+    /** Switches the shaper off (processBlock returns immediately) or on. */
+    void setBypass(bool shouldBeBypassed) { bypass = shouldBeBypassed; }
+
+    //---------------------------------------------------------------------------------------------
+    // inquiry:
+
+    /** Returns the selected transfer curve @see modes. */
+    int getMode() const { return mode; }
+
+    /** Returns the gain in front of the shaper (in dB). */
+    float getDrive() const { return drive; }
+
+    /** Returns the gain after the shaper (in dB). */
+    float getOutputLevel() const { return outputLevel; }
+
+    /** Returns true when the shaper is switched off. */
+    bool isBypassed() const { return bypass; }
+
+    //---------------------------------------------------------------------------------------------
+    // audio processing:
+
+    /** Evaluates the transfer curve at x. */
+    INLINE float shape(float x);
+
+    /** Evaluates the antiderivative of the transfer curve at x. */
+    INLINE float antiderivative(float x);
+
+    /** Calculates one output sample at a time. */
+    INLINE float getSample(float in);
+
+    /** Processes a block of samples in place. */
+    void processBlock(float *buffer, int length);
+
+    //---------------------------------------------------------------------------------------------
+    // others:
+
+    /** Resets the previous input and its antiderivative. */
+    void reset();
+
+    //=============================================================================================
+
+  protected:
+
+    /** Fills the curve table for the selected mode and integrates it. */
+    void fillTables();
+
+    float curve[TABLE_SIZE+1];     // transfer curve f(x) on 0...xMax
+    float integral[TABLE_SIZE+1];  // antiderivative F(x) on 0...xMax (F(0) = 0)
+    float xMax;                    // range of the tables
+    float indexScale;              // TABLE_SIZE / xMax
+    float step;                    // xMax / TABLE_SIZE
+    bool  periodic;                // curve repeats with period xMax beyond the table (foldback)
+
+    float x1, F1;                  // previous (driven) input and its antiderivative
+    float drive, driveFactor;      // input gain in dB and as raw factor
+    float outputLevel, outFactor;  // output gain in dB and as raw factor
+    int   mode;
+    bool  bypass;
+
+  };
+
+  //-----------------------------------------------------------------------------------------------
+  // inlined functions:
+
+  INLINE float WaveShaper::shape(float x)
+  {
+    float a = fabsf(x);
+    if( periodic )
+    {
+      a -= xMax * floorf(a * (1.0f/xMax));
+      if( a >= xMax ) // rounding
+        a = 0.0f;
+    }
+    else if( a >= xMax )
+      return x < 0.0f ? -curve[TABLE_SIZE] : curve[TABLE_SIZE];
+    float y = lookupTable(curve, a*indexScale);
+    return x < 0.0f ? -y : y;
+  }
+
+  INLINE float WaveShaper::antiderivative(float x)
+  {
+    // F is even because f is odd:
+    float a = fabsf(x);
+    if( periodic )
+      a -= xMax * floorf(a * (1.0f/xMax)); // f integrates to zero over one period
+    else if( a >= xMax )
+      return integral[TABLE_SIZE] + curve[TABLE_SIZE] * (a - xMax);
+
+    float idx = a*indexScale;
+    int   i   = (int)idx;
+    if( i >= TABLE_SIZE )
+      i = TABLE_SIZE-1;
+    float t   = idx - (float)i;
+    return integral[i] + step * t * (curve[i] + 0.5f * t * (curve[i+1] - curve[i]));
+  }
+
+  INLINE float WaveShaper::getSample(float in)
+  {
+    float x  = driveFactor * in;
+    float F  = antiderivative(x);
+    float dx = x - x1;
+    float y;
+    // F grows with |x|, so does its rounding error - the threshold is relative to the magnitude:
+    if( fabsf(dx) > 1.e-3f * rmax(1.0f, fabsf(x)) )
+      y = (F - F1) / dx;
+    else
+      y = shape(0.5f * (x + x1)); // ill-conditioned quotient - use the curve at the midpoint
+    x1 = x;
+    F1 = F;
+    return outFactor * y;
+  }
+
+} // end namespace rosic
+
+#endif // rosic_WaveShaper_h
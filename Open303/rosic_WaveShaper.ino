@@ -0,0 +1,109 @@
+#include "rosic_WaveShaper.h"
+using namespace rosic;
+
+//-------------------------------------------------------------------------------------------------
+// construction/destruction:
+
+WaveShaper::WaveShaper()
+{
+  mode   = TANH;
+  bypass = false;
+  setDrive(0.0f);
+  setOutputLevel(0.0f);
+  fillTables();
+  reset();
+}
+
+//-------------------------------------------------------------------------------------------------
+// parameter settings:
+
+void WaveShaper::setMode(int newMode)
+{
+  if( newMode >= 0 && newMode < NUM_MODES && newMode != mode )
+  {
+    mode = newMode;
+    fillTables();
+    reset();
+  }
+}
+
+void WaveShaper::setDrive(float newDrive)
+{
+  drive       = newDrive;
+  driveFactor = dB2amp(drive);
+}
+
+void WaveShaper::setOutputLevel(float newLevel)
+{
+  outputLevel = newLevel;
+  outFactor   = dB2amp(outputLevel);
+}
+
+//-------------------------------------------------------------------------------------------------
+// audio processing:
+
+void HOT_CODE WaveShaper::processBlock(float *buffer, int length)
+{
+  if( bypass )
+    return;
+  for(int i=0; i<length; i++)
+    buffer[i] = getSample(buffer[i]);
+}
+
+//-------------------------------------------------------------------------------------------------
+// others:
+
+void WaveShaper::reset()
+{
+  x1 = 0.0f;
+  F1 = 0.0f;
+}
+
+//-------------------------------------------------------------------------------------------------
+// internal functions:
+
+void WaveShaper::fillTables()
+{
+  int i;
+  switch( mode )
+  {
+  case HARDCLIP: // clips at 1, the knee falls on a table point
+    {
+      xMax     = 2.0f;
+      periodic = false;
+      for(i=0; i<=TABLE_SIZE; i++)
+        curve[i] = fminf((float)i * xMax / TABLE_SIZE, 1.0f);
+    }
+    break;
+  case FOLDBACK: // triangle with period 4 that folds back at +-1, knees fall on table points
+    {
+      xMax     = 4.0f;
+      periodic = true;
+      for(i=0; i<=TABLE_SIZE; i++)
+      {
+        float x = (float)i * xMax / TABLE_SIZE;
+        if( x <= 1.0f )
+          curve[i] = x;
+        else if( x <= 3.0f )
+          curve[i] = 2.0f - x;
+        else
+          curve[i] = x - 4.0f;
+      }
+    }
+    break;
+  default: // TANH
+    {
+      xMax     = SHAPER_LOOKUP_MAX;
+      periodic = false;
+      for(i=0; i<=TABLE_SIZE; i++)
+        curve[i] = shaper_tbl[i];
+    }
+  }
+  indexScale = (float)TABLE_SIZE / xMax;
+  step       = xMax / (float)TABLE_SIZE;
+
+  // exact integral of the linearly interpolated curve (trapezoidal rule per segment):
+  integral[0] = 0.0f;
+  for(i=1; i<=TABLE_SIZE; i++)
+    integral[i] = integral[i-1] + 0.5f * step * (curve[i-1] + curve[i]);
+}
@@ -0,0 +1,71 @@
+// Cache stall profiler (PROFILE_STALLS): counts the cycles that the audio render spends waiting for
+// instruction fetches and data loads, per DMA buffer, with the performance counters of the Xtensa 
+// core. Everything that is fetched through the flash/PSRAM cache can stall, so with the render path
+// in IRAM and its state in DRAM, the counts should stay close to zero. What remains comes from the
+// flash functions the render path still calls (see host/iram_report.sh) and from drum samples,
+// which are read from the flash partition.
+
+#ifdef PROFILE_STALLS
+#include "perfmon.h"
+
+#define PROF_CYCLES   0     // performance counter indices
+#define PROF_I_STALLS 1
+#define PROF_D_STALLS 2
+
+static volatile uint32_t prof_buffers = 0;  // running totals, written by the audio task
+static volatile uint32_t prof_cycles = 0;
+static volatile uint32_t prof_i_stalls = 0;
+static volatile uint32_t prof_d_stalls = 0;
+static volatile uint32_t prof_worst = 0;    // most stall cycles in a buffer since the last report
+static volatile bool prof_reset_worst = false;
+
+// called by the audio task before rendering a buffer - the counters belong to the core it runs on
+void HOT_CODE stallProfileStart() {
+  static bool initialized = false;
+  if (!initialized) {
+    xtensa_perfmon_init(PROF_CYCLES, XTPERF_CNT_CYCLES, XTPERF_MASK_CYCLES, 0, -1);
+    xtensa_perfmon_init(PROF_I_STALLS, XTPERF_CNT_I_STALL, 0xFFFF, 0, -1); // all causes
+    xtensa_perfmon_init(PROF_D_STALLS, XTPERF_CNT_D_STALL, 0xFFFF, 0, -1);
+    initialized = true;
+  }
+  xtensa_perfmon_reset(PROF_CYCLES);
+  xtensa_perfmon_reset(PROF_I_STALLS);
+  xtensa_perfmon_reset(PROF_D_STALLS);
+  xtensa_perfmon_start();
+}
+
+// called by the audio task after rendering a buffer
+void HOT_CODE stallProfileStop() {
+  xtensa_perfmon_stop();
+  uint32_t i_stalls = xtensa_perfmon_value(PROF_I_STALLS);
+  uint32_t d_stalls = xtensa_perfmon_value(PROF_D_STALLS);
+  prof_cycles += xtensa_perfmon_value(PROF_CYCLES);
+  prof_i_stalls += i_stalls;
+  prof_d_stalls += d_stalls;
+  if (prof_reset_worst) {
+    prof_worst = 0;
+    prof_reset_worst = false;
+  }
+  if (i_stalls + d_stalls > prof_worst) prof_worst = i_stalls + d_stalls;
+  prof_buffers++;
+}
+
+// called from loop(), prints the averages per buffer every 2 seconds
+void stallProfileReport() {
+  static uint32_t last_report = 0, last_buffers = 0, last_cycles = 0, last_i_stalls = 0, last_d_stalls = 0;
+  if (millis() - last_report < 2000) return;
+  last_report = millis();
+  uint32_t buffers = prof_buffers - last_buffers;
+  if (buffers == 0) return;
+  uint32_t cycles = prof_cycles - last_cycles;
+  uint32_t i_stalls = prof_i_stalls - last_i_stalls;
+  uint32_t d_stalls = prof_d_stalls - last_d_stalls;
+  last_buffers += buffers;
+  last_cycles += cycles;
+  last_i_stalls += i_stalls;
+  last_d_stalls += d_stalls;
+  DEBF("stalls per buffer: %u instruction + %u data of %u cycles, worst %u\r\n",
+       i_stalls / buffers, d_stalls / buffers, cycles / buffers, prof_worst);
+  prof_reset_worst = true;
+}
+#endif
@@ -0,0 +1,427 @@
+/*
+  acid_render - offline batch renderer for the Endless Acid Banger jukebox (AcidBanger.ino)
+
+  Renders any number of seeded jukebox sessions in parallel and writes, for each session, the audio
+  as a 16 bit stereo WAV file and the generated material as a JSON manifest. The manifest has one
+  section for every bar at which the playing patterns changed (breaks, new melodies, new note sets),
+  so interesting sessions can be found and recreated from their seed.
+
+  The sessions run exactly the sketch code: the generators, the breaks and the CC ramps of
+  AcidBanger.ino, the MIDI handling of midi_handler.ino and presets.ino and the same voice and master chain as the
+  audio task in Open303.ino, clocked by the rendered samples instead of the I2S DMA.
+
+  The sketch keeps the synth and the jukebox in globals, so a session can't share a process with
+  another one. Each worker thread renders its sessions in child processes forked from the pristine
+  state after startup, one Open303 per child. The sessions are dealt out to per-worker queues; a
+  worker takes from the back of its own queue and when that runs dry, it steals from the front of
+  the others', so the workers stay busy until the batch is done.
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 acid_render.cpp -o acid_render -pthread
+
+  Usage:
+    acid_render [-n sessions] [-f first] [-t seconds] [-b bpm] [-s seed] [-j threads]
+                [-d drumbank] [-o outdir]
+
+    -n  number of sessions to render (default 16)
+    -f  index of the first session (default 0) - together with -s and -n 1, a single session of
+        a batch is rendered again
+    -t  length of each session in seconds (default 60)
+    -b  tempo in BPM (default 130)
+    -s  seed of the batch (default 1), the seed of each session is derived from it and the index
+    -j  number of worker threads (default: number of CPU cores)
+    -d  drum sample bank (see rosic_SampleBank.h), without it the synthesized drums play
+    -o  output directory (default "."), the files are named acid_<index>.wav/.json
+*/
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "rosic_host.h"
+
+// jukebox configuration, as in Open303.ino:
+#define JUKEBOX
+#define JUKEBOX_PLAY_ON_START
+#define SYNTH1_MIDI_CHAN        1
+#define DRUM_MIDI_CHAN          10
+
+// the sketch globals (see Open303.ino):
+float bpm = 130.0f;
+
+rosic::Open303 Synth;
+rosic::WaveShaper Overdrive, Distortion;
+rosic::StereoPanner SynthPan, DrumPan;
+rosic::Compressor Comp;
+rosic::SampleBank DrumBank;
+rosic::DrumSampler Drums;
+rosic::DrumSynth SynthDrums;
+rosic::ClockTracker MidiClock;
+rosic::Transport SampleClock;
+rosic::PresetBank Presets;
+rosic::PresetMorpher Morph;
+
+inline double sample_time_now() {
+  return (double)SampleClock.getSampleTime();
+}
+
+// prototypes of the sketch functions that are used before their definition (in the sketch, the
+// Arduino builder generates them):
+void handleNoteOn(uint8_t inChannel, uint8_t inNote, uint8_t inVelocity);
+void handleNoteOff(uint8_t inChannel, uint8_t inNote, uint8_t inVelocity);
+void handleCC(uint8_t inChannel, uint8_t cc_number, uint8_t cc_value);
+void handleProgramChange(uint8_t inChannel, uint8_t number);
+void handlePitchBend(uint8_t inChannel, int number);
+void handleClock();
+void handleStart();
+void handleContinue();
+void handleStop();
+static void init_button(struct Button *button, byte pin, uint8_t num);
+static void init_instruments();
+void init_patterns();
+static void do_midi_start();
+static void do_midi_ramps();
+static void check_midi_ramps(boolean force_restart);
+static byte flip(byte percent_chance);
+void mem_generate_drums(byte mem, byte drum_kind);
+void mem_generate_melody_and_seed(byte mem, byte voice);
+void mem_generate_note_set(byte mem);
+void presetsInit();
+void selectProgram(uint8_t number);
+void setMorphTarget(uint8_t number);
+void storePreset(uint8_t number);
+
+#include "AcidBanger.ino"
+#include "midi_handler.ino"
+#include "presets.ino"
+
+//-------------------------------------------------------------------------------------------------
+// rendering of a session:
+
+struct RenderSettings
+{
+  int         numSessions = 16;
+  int         firstSession = 0;
+  float       seconds     = 60.0f;
+  float       tempo       = 130.0f;
+  uint32_t    seed        = 1;
+  int         numThreads  = 0;
+  const char* drumBank    = NULL;
+  const char* outDir      = ".";
+};
+
+/** The patterns that played from a bar on. */
+struct Section
+{
+  uint32_t bar;
+  double   time;
+  bool     isBreak;
+  byte     drumkit;
+  Memory   memory;
+};
+
+/** Derives the seed of a session from the seed of the batch and the index (splitmix32), such that
+neighbouring sessions are unrelated. */
+static uint32_t session_seed(uint32_t seed, int session) {
+  uint32_t z = seed + 0x9e3779b9u * (uint32_t)(session + 1);
+  z = (z ^ (z >> 16)) * 0x85ebca6bu;
+  z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+  return z ^ (z >> 16);
+}
+
+static void write_le(FILE *f, uint32_t value, int numBytes) {
+  for (int i = 0; i < numBytes; i++)
+    fputc((value >> (8 * i)) & 0xff, f);
+}
+
+/** Writes the header of a 16 bit stereo WAV file with the given number of frames. */
+static void write_wav_header(FILE *f, uint32_t numFrames) {
+  uint32_t dataBytes = numFrames * 4;
+  fwrite("RIFF", 1, 4, f);
+  write_le(f, 36 + dataBytes, 4);
+  fwrite("WAVEfmt ", 1, 8, f);
+  write_le(f, 16, 4);              // fmt chunk size
+  write_le(f, 1, 2);               // PCM
+  write_le(f, 2, 2);               // channels
+  write_le(f, SAMPLE_RATE, 4);
+  write_le(f, SAMPLE_RATE * 4, 4); // bytes per second
+  write_le(f, 4, 2);               // bytes per frame
+  write_le(f, 16, 2);              // bits per sample
+  fwrite("data", 1, 4, f);
+  write_le(f, dataBytes, 4);
+}
+
+static void write_json_steps(FILE *f, const uint8_t *steps) {
+  fputc('[', f);
+  for (int i = 0; i < PatternLength; i++)
+    fprintf(f, i ? ",%d" : "%d", steps[i]);
+  fputc(']', f);
+}
+
+static void write_json_bits(FILE *f, uint16_t bits) {
+  fputc('[', f);
+  for (int i = 0; i < PatternLength; i++)
+    fprintf(f, i ? ",%d" : "%d", (bits >> i) & 1);
+  fputc(']', f);
+}
+
+static bool write_manifest(const char *path, const RenderSettings &settings, int session,
+                           const char *wavName, const std::vector<Section> &sections) {
+  static const char *drum_names[6] = { "kick", "snare", "closed_hat", "open_hat", "percussion", "crash" };
+
+  FILE *f = fopen(path, "w");
+  if (f == NULL)
+    return false;
+  fprintf(f, "{\n");
+  fprintf(f, "  \"session\": %d,\n", session);
+  fprintf(f, "  \"seed\": %u,\n", settings.seed);
+  fprintf(f, "  \"session_seed\": %u,\n", session_seed(settings.seed, session));
+  fprintf(f, "  \"bpm\": %g,\n", settings.tempo);
+  fprintf(f, "  \"seconds\": %g,\n", settings.seconds);
+  fprintf(f, "  \"sample_rate\": %d,\n", SAMPLE_RATE);
+  fprintf(f, "  \"wav\": \"%s\",\n", wavName);
+  fprintf(f, "  \"drums\": \"%s\",\n", DrumBank.isOpen() ? "samples" : "synth");
+  fprintf(f, "  \"sections\": [\n");
+  for (size_t s = 0; s < sections.size(); s++) {
+    const Section &sec = sections[s];
+    const Memory  &m   = sec.memory;
+    fprintf(f, "    {\n");
+    fprintf(f, "      \"bar\": %u,\n", sec.bar);
+    fprintf(f, "      \"time\": %.3f,\n", sec.time);
+    fprintf(f, "      \"break\": %s,\n", sec.isBreak ? "true" : "false");
+    fprintf(f, "      \"drumkit\": %d,\n", sec.drumkit);
+    fprintf(f, "      \"note_set\": [");
+    for (int i = 0; i < m.num_notes_in_set; i++)
+      fprintf(f, i ? ",%d" : "%d", m.note_set[i]);
+    fprintf(f, "],\n");
+    fprintf(f, "      \"melodies\": [\n");
+    for (int v = 0; v < 2; v++) {
+      const Pattern &p = m.patterns[v];
+      fprintf(f, "        { \"notes\": ");
+      write_json_steps(f, p.notes);
+      fprintf(f, ", \"accent\": ");
+      write_json_bits(f, p.accent);
+      fprintf(f, ", \"glide\": ");
+      write_json_bits(f, p.glide);
+      fprintf(f, v < 1 ? " },\n" : " }\n");
+    }
+    fprintf(f, "      ],\n");
+    fprintf(f, "      \"drums\": {\n");
+    for (int d = 0; d < 6; d++) {
+      fprintf(f, "        \"%s\": ", drum_names[d]);
+      write_json_steps(f, m.patterns[2 + d].notes);
+      fprintf(f, d < 5 ? ",\n" : "\n");
+    }
+    fprintf(f, "      }\n");
+    fprintf(f, s + 1 < sections.size() ? "    },\n" : "    }\n");
+  }
+  fprintf(f, "  ]\n}\n");
+  return fclose(f) == 0;
+}
+
+/** Renders one session into the output directory - this runs in a child process, with the sketch
+globals as they are after startup. */
+static bool render_session(const RenderSettings &settings, int session) {
+  char wavName[32], wavPath[4096], jsonPath[4096];
+  snprintf(wavName, sizeof(wavName), "acid_%05d.wav", session);
+  snprintf(wavPath, sizeof(wavPath), "%s/%s", settings.outDir, wavName);
+  snprintf(jsonPath, sizeof(jsonPath), "%s/acid_%05d.json", settings.outDir, session);
+
+  // seed both random generators of the sketch:
+  uint32_t seed = session_seed(settings.seed, session);
+  randomSeed(seed);
+  myRandomState = (uint16_t)(seed ^ (seed >> 16));
+  if (myRandomState == 0)
+    myRandomState = 1; // the LFSR would get stuck
+
+  // what setup() does:
+  set_bpm(settings.tempo);
+  Overdrive.setMode(rosic::WaveShaper::TANH);
+  Overdrive.setBypass(true);
+  Distortion.setMode(rosic::WaveShaper::HARDCLIP);
+  Distortion.setBypass(true);
+  if (settings.drumBank != NULL) {
+    if (!DrumBank.open(settings.drumBank)) {
+      fprintf(stderr, "can't open drum bank %s\n", settings.drumBank);
+      return false;
+    }
+    Drums.setSampleBank(&DrumBank);
+  }
+  init_midi();
+  presetsInit();
+
+  FILE *wav = fopen(wavPath, "wb");
+  if (wav == NULL) {
+    fprintf(stderr, "can't write %s\n", wavPath);
+    return false;
+  }
+  uint32_t numBlocks = (uint32_t)(settings.seconds * SAMPLE_RATE / DMA_BUF_LEN);
+  write_wav_header(wav, numBlocks * DMA_BUF_LEN);
+
+  std::vector<Section> sections;
+  uint32_t checkedBar = 0;
+  float   synth_buf[DMA_BUF_LEN], drum_buf[DMA_BUF_LEN], mix_buf[DMA_BUF_LEN * 2];
+  int16_t out_buf[DMA_BUF_LEN * 2];
+  for (uint32_t b = 0; b < numBlocks; b++) {
+    // what loop() does:
+    run_tick();
+
+    // note the patterns whenever they changed at the start of a bar:
+    if (sections.empty() || bar_current != checkedBar) {
+      checkedBar = bar_current;
+      Section sec;
+      sec.bar     = bar_current;
+      sec.time    = sample_time_now() / SAMPLE_RATE;
+      sec.isBreak = Break.status == sPlaying;
+      sec.drumkit = current_drumkit;
+      sec.memory  = memories[cur_memory];
+      const Section *last = sections.empty() ? NULL : &sections.back();
+      if (last == NULL || last->isBreak != sec.isBreak || last->drumkit != sec.drumkit
+          || memcmp(&last->memory, &sec.memory, sizeof(Memory)) != 0)
+        sections.push_back(sec);
+    }
+
+    // what audio_task1() does:
+    Morph.update();
+    Synth.processBlock(synth_buf, DMA_BUF_LEN);
+    Overdrive.processBlock(synth_buf, DMA_BUF_LEN);
+    Distortion.processBlock(synth_buf, DMA_BUF_LEN);
+    memset(drum_buf, 0, sizeof(drum_buf));
+    Drums.processBlock(drum_buf, DMA_BUF_LEN);
+    SynthDrums.processBlock(drum_buf, DMA_BUF_LEN);
+    memset(mix_buf, 0, sizeof(mix_buf));
+    SynthPan.processBlock(synth_buf, mix_buf, DMA_BUF_LEN);
+    DrumPan.processBlock(drum_buf, mix_buf, DMA_BUF_LEN);
+    Comp.processBlock(mix_buf, out_buf);
+    fwrite(out_buf, sizeof(out_buf), 1, wav);
+    SampleClock.advance(DMA_BUF_LEN);
+  }
+  if (fclose(wav) != 0) {
+    fprintf(stderr, "can't write %s\n", wavPath);
+    return false;
+  }
+  if (!write_manifest(jsonPath, settings, session, wavName, sections)) {
+    fprintf(stderr, "can't write %s\n", jsonPath);
+    return false;
+  }
+  return true;
+}
+
+//-------------------------------------------------------------------------------------------------
+// the worker pool:
+
+struct SessionQueue
+{
+  std::mutex      lock;
+  std::deque<int> sessions;
+};
+
+/** Takes the next session for a worker: from the back of its own queue, or stolen from the front
+of another one. Returns false when all queues are empty. */
+static bool take_session(std::vector<SessionQueue> &queues, int worker, int &session) {
+  int numQueues = (int)queues.size();
+  for (int k = 0; k < numQueues; k++) {
+    SessionQueue &q = queues[(worker + k) % numQueues];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.sessions.empty())
+      continue;
+    if (k == 0) {
+      session = q.sessions.back();
+      q.sessions.pop_back();
+    } else {
+      session = q.sessions.front();
+      q.sessions.pop_front();
+    }
+    return true;
+  }
+  return false;
+}
+
+static void run_worker(const RenderSettings &settings, std::vector<SessionQueue> &queues,
+                       int worker, std::atomic<int> &numFailed) {
+  int session;
+  while (take_session(queues, worker, session)) {
+    pid_t pid = fork();
+    if (pid == 0)
+      _exit(render_session(settings, session) ? 0 : 1);
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      fprintf(stderr, "session %d failed\n", session);
+      numFailed++;
+    }
+  }
+}
+
+static void print_usage() {
+  fprintf(stderr,
+    "usage: acid_render [-n sessions] [-f first] [-t seconds] [-b bpm] [-s seed] [-j threads]\n"
+    "                   [-d drumbank] [-o outdir]\n");
+}
+
+int main(int argc, char **argv) {
+  RenderSettings settings;
+  int opt;
+  while ((opt = getopt(argc, argv, "n:f:t:b:s:j:d:o:h")) != -1) {
+    switch (opt) {
+      case 'n': settings.numSessions  = atoi(optarg);                    break;
+      case 'f': settings.firstSession = atoi(optarg);                    break;
+      case 't': settings.seconds      = (float)atof(optarg);             break;
+      case 'b': settings.tempo        = (float)atof(optarg);             break;
+      case 's': settings.seed         = (uint32_t)strtoul(optarg, NULL, 0); break;
+      case 'j': settings.numThreads   = atoi(optarg);                    break;
+      case 'd': settings.drumBank     = optarg;                          break;
+      case 'o': settings.outDir       = optarg;                          break;
+      default:
+        print_usage();
+        return 1;
+    }
+  }
+  if (optind < argc || settings.numSessions < 1 || settings.firstSession < 0
+      || settings.seconds <= 0.0f || settings.tempo < 20.0f || settings.tempo > 400.0f) {
+    print_usage();
+    return 1;
+  }
+  if (mkdir(settings.outDir, 0777) != 0 && errno != EEXIST) {
+    fprintf(stderr, "can't create %s\n", settings.outDir);
+    return 1;
+  }
+
+  int numThreads = settings.numThreads;
+  if (numThreads < 1)
+    numThreads = (int)std::thread::hardware_concurrency();
+  if (numThreads < 1)
+    numThreads = 1;
+  if (numThreads > settings.numSessions)
+    numThreads = settings.numSessions;
+
+  // deal the sessions out in contiguous runs, stealing evens out what is left at the end:
+  std::vector<SessionQueue> queues(numThreads);
+  for (int i = 0; i < settings.numSessions; i++)
+    queues[(int)((long long)i * numThreads / settings.numSessions)].sessions.push_back(settings.firstSession + i);
+
+  fflush(stdout);
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<int> numFailed(0);
+  std::vector<std::thread> workers;
+  for (int w = 0; w < numThreads; w++)
+    workers.emplace_back(run_worker, std::cref(settings), std::ref(queues), w, std::ref(numFailed));
+  for (auto &t : workers)
+    t.join();
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  double audio = settings.numSessions * (double)settings.seconds;
+  printf("%d sessions (%.0f s of audio) in %.1f s on %d threads, %.1fx realtime\n",
+         settings.numSessions, audio, elapsed, numThreads, audio / elapsed);
+  if (numFailed > 0) {
+    printf("%d sessions failed\n", (int)numFailed);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*
+  drum_bank - builds a drum sample bank from WAV files
+
+  Writes the bank that the sketch maps from the "drums" data partition (see rosic_SampleBank.h and
+  partitions.csv): each WAV file becomes one 16 bit mono sample at its own sample rate (the
+  DrumSampler plays it back at the right pitch), stereo files are mixed down. The sample numbers
+  are the MIDI notes on DRUM_MIDI_CHAN, so only the first 128 samples can be played.
+
+  The jukebox (AcidBanger.ino) takes the samples as drum kits of 12 consecutive samples - kick,
+  snare, closed hat, open hat, percussion and crash first, the rest of a kit is free. With -k, each
+  folder is one kit: its files fill the kit in the order of their names and the kit is padded to
+  12 samples with silence, so the next folder starts the next kit.
+
+  Folders are scanned for *.wav files (not recursively), in the order of their names. PCM with 8,
+  16, 24 or 32 bit and 32 or 64 bit float are read.
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 drum_bank.cpp -o drum_bank
+
+  Usage:
+    drum_bank [-k] -o drums.bin folder|file.wav...
+
+  E.g.:
+
+    drum_bank -k -o drums.bin kits/808 kits/909
+    esptool.py write_flash 0x210000 drums.bin
+*/
+
+#include <unistd.h>
+
+#include "rosic_host.h"
+#include "wav_file.h"
+
+static const int drumkitSize = 12;   // DRUMKIT_SIZE in AcidBanger.ino
+static const int numMidiNotes = 128;
+
+struct Sample
+{
+  std::string name;
+  uint32_t    offset;     // of the data in the bank, 0 for silence
+  uint32_t    numFrames;
+  uint32_t    sampleRate;
+};
+
+static void print_usage() {
+  fprintf(stderr, "usage: drum_bank [-k] -o drums.bin folder|file.wav...\n");
+}
+
+int main(int argc, char **argv) {
+  const char *output = NULL;
+  bool kits = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "ko:h")) != -1) {
+    switch (opt) {
+      case 'k': kits   = true;   break;
+      case 'o': output = optarg; break;
+      default:
+        print_usage();
+        return 1;
+    }
+  }
+  if (output == NULL || optind >= argc) {
+    print_usage();
+    return 1;
+  }
+
+  // the files, with -k each folder padded to a whole kit (an empty name is a silent slot):
+  std::vector<std::string> files;
+  for (int i = optind; i < argc; i++) {
+    size_t first = files.size();
+    if (!add_wav_files(argv[i], files))
+      return 1;
+    if (kits) {
+      if (files.size() - first > (size_t)drumkitSize) {
+        fprintf(stderr, "%s has more than %d samples for a kit\n", argv[i], drumkitSize);
+        return 1;
+      }
+      files.resize(first + drumkitSize);
+    }
+  }
+  if (files.size() > 65535) {
+    fprintf(stderr, "too many samples (%zu)\n", files.size());
+    return 1;
+  }
+
+  // the data first, the table needs the offsets - the silent slots share 2 frames of silence:
+  const uint32_t tableOffset = 8, entrySize = 16;
+  uint32_t dataOffset = tableOffset + entrySize * (uint32_t)files.size();
+  std::vector<uint8_t> data;
+  std::vector<Sample> samples;
+  uint32_t silence = 0;
+  for (const std::string &file : files) {
+    Sample s;
+    s.name = file;
+    if (file.empty()) {
+      if (silence == 0) {
+        silence = dataOffset + (uint32_t)data.size();
+        put_le(data, 0, 4);
+      }
+      s.offset     = silence;
+      s.numFrames  = 2;
+      s.sampleRate = SAMPLE_RATE;
+      samples.push_back(s);
+      continue;
+    }
+    WavData wav;
+    if (!read_wav(file.c_str(), wav))
+      return 1;
+    if (wav.numFrames() < 2) {
+      fprintf(stderr, "%s: a sample needs at least 2 frames\n", file.c_str());
+      return 1;
+    }
+    s.offset     = dataOffset + (uint32_t)data.size();
+    s.numFrames  = wav.numFrames();
+    s.sampleRate = wav.sampleRate;
+    for (int i = 0; i < wav.numFrames(); i++) {
+      float sum = 0.0f;
+      for (int c = 0; c < wav.numChannels; c++)
+        sum += wav.samples[i * wav.numChannels + c];
+      float v = sum / wav.numChannels * 32768.0f;
+      put_le(data, (uint16_t)(int16_t)lrintf(std::min(std::max(v, -32768.0f), 32767.0f)), 2);
+    }
+    samples.push_back(s);
+  }
+
+  std::vector<uint8_t> bank;
+  bank.insert(bank.end(), {'O', '3', 'D', 'S'});
+  put_le(bank, 1, 2);                                       // version
+  put_le(bank, (uint32_t)samples.size(), 2);
+  for (const Sample &s : samples) {
+    put_le(bank, s.offset, 4);
+    put_le(bank, s.numFrames, 4);
+    put_le(bank, s.sampleRate, 4);
+    put_le(bank, 0, 4);                                     // reserved
+  }
+  bank.insert(bank.end(), data.begin(), data.end());
+
+  for (size_t i = 0; i < samples.size(); i++) {
+    if (!samples[i].name.empty())
+      printf("%3zu  kit %2zu/%2zu  %6u frames at %5u Hz  %s\n", i, i / drumkitSize,
+             i % drumkitSize, samples[i].numFrames, samples[i].sampleRate, samples[i].name.c_str());
+  }
+  if (samples.size() > (size_t)numMidiNotes)
+    fprintf(stderr, "warning: only the first %d samples can be played by MIDI notes\n", numMidiNotes);
+
+  FILE *out = fopen(output, "wb");
+  if (out == NULL || fwrite(bank.data(), 1, bank.size(), out) != bank.size() || fclose(out) != 0) {
+    fprintf(stderr, "can't write %s\n", output);
+    return 1;
+  }
+  printf("%zu samples, %zu bytes\n", samples.size(), bank.size());
+  return 0;
+}
@@ -0,0 +1,302 @@
+/*
+  envelope_bench - checks and times the block rendering of AnalogEnvelope (rosic_AnalogEnvelope.h)
+
+  Plays the same notes through AnalogEnvelope and through the previous implementation, which
+  advanced a float time and compared it against the accumulated segment times at every sample
+  (ReferenceEnvelope below, the code as it was). The curves must match: with the 303's amp envelope
+  settings exactly, with a general ADSR up to float rounding. Then the time per sample is measured
+  for the reference, for getSample() and for processBlock(), in blocks of DMA_BUF_LEN samples as in
+  the audio task, with denormals flushed to zero.
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 envelope_bench.cpp -o envelope_bench
+
+  Usage:
+    envelope_bench [seconds]
+
+    seconds  length of the rendering that is timed (default 60)
+  The exit code is 0 when the curves match.
+*/
+
+#include <chrono>
+#include <vector>
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#include "rosic_host.h"
+
+using rosic::AnalogEnvelope;
+
+//-------------------------------------------------------------------------------------------------
+// the previous implementation:
+
+/** AnalogEnvelope before the segment state machine, reduced to what the tests use. */
+class ReferenceEnvelope
+{
+public:
+  ReferenceEnvelope()
+  {
+    sampleRate     = SAMPLE_RATE;
+    startLevel     = 0.0;
+    attackTime     = 0.0;
+    peakLevel      = 1.0;
+    holdTime       = 0.0;
+    decayTime      = 0.1;
+    sustainLevel   = 0.5;
+    releaseTime    = 0.01;
+    endLevel       = 0.0;
+    time           = 0.0;
+    timeScale      = 1.0;
+    increment      = 1000.0*timeScale/sampleRate;
+    tauScale       = 1.0;
+    peakScale      = 1.0;
+    noteIsOn       = false;
+    previousOutput = 0.0;
+    setAttack(attackTime);
+    setDecay(decayTime);
+    setRelease(releaseTime);
+  }
+
+  void setSustainLevel(float newSustain) { sustainLevel = newSustain; }
+
+  void setAttack(float newAttackTime)
+  {
+    if( newAttackTime > 0.0 )
+    {
+      attackTime  = newAttackTime;
+      float tau  = (sampleRate*0.001*attackTime) * tauScale/timeScale;
+      attackCoeff = 1.0 - exp( -1.0 / tau );
+    }
+    else
+    {
+      attackTime  = 0.0;
+      attackCoeff = 1.0;
+    }
+    calculateAccumulatedTimes();
+  }
+
+  void setHold(float newHoldTime)
+  {
+    if( newHoldTime >= 0 )
+      holdTime = newHoldTime;
+    calculateAccumulatedTimes();
+  }
+
+  void setDecay(float newDecayTime)
+  {
+    if( newDecayTime > 0.0 )
+    {
+      decayTime  = newDecayTime;
+      float tau = (sampleRate*0.001*decayTime) * tauScale/timeScale;
+      decayCoeff = 1.0 - exp( -1.0 / tau  );
+    }
+    else
+    {
+      decayTime  = 0.0;
+      decayCoeff = 1.0;
+    }
+    calculateAccumulatedTimes();
+  }
+
+  void setRelease(float newReleaseTime)
+  {
+    if( newReleaseTime > 0.0 )
+    {
+      releaseTime  = newReleaseTime;
+      float tau   = (sampleRate*0.001*releaseTime) * tauScale/timeScale;
+      releaseCoeff = 1.0 - exp( -1.0 / tau  );
+    }
+    else
+    {
+      releaseTime  = 0.0;
+      releaseCoeff = 1.0;
+    }
+    calculateAccumulatedTimes();
+  }
+
+  void noteOn(bool startFromCurrentLevel)
+  {
+    if( !startFromCurrentLevel )
+      previousOutput = startLevel;
+    time     = 0.0f;
+    noteIsOn = true;
+  }
+
+  void noteOff()
+  {
+    noteIsOn = false;
+    time = (attackTime + holdTime + decayTime + increment);
+  }
+
+  INLINE float getSample()
+  {
+    float out;
+    if(time <= attPlusHld)
+    {
+      out   = previousOutput + attackCoeff * (peakScale*peakLevel - previousOutput);
+      time += increment;
+    }
+    else if(time <= (attPlusHldPlusDec))
+    {
+      out   = previousOutput + decayCoeff * (sustainLevel - previousOutput);
+      time += increment;
+    }
+    else if(noteIsOn)
+    {
+      out = previousOutput + decayCoeff * (sustainLevel - previousOutput);
+    }
+    else
+    {
+      out   = previousOutput + releaseCoeff * (endLevel - previousOutput);
+      time += increment;
+    }
+    previousOutput = out;
+    return out;
+  }
+
+protected:
+  void calculateAccumulatedTimes()
+  {
+    attPlusHld        = attackTime + holdTime;
+    attPlusHldPlusDec = attPlusHld + decayTime;
+  }
+
+  float startLevel, peakLevel, sustainLevel, endLevel;
+  float attackTime, holdTime, decayTime, releaseTime;
+  float attPlusHld, attPlusHldPlusDec;
+  float time, timeScale, increment, tauScale, peakScale;
+  float attackCoeff, decayCoeff, releaseCoeff;
+  float previousOutput, sampleRate;
+  bool  noteIsOn;
+};
+
+//-------------------------------------------------------------------------------------------------
+// settings and notes:
+
+struct Settings
+{
+  const char *name;
+  float attack, hold, decay, sustain, release;   // times in milliseconds
+  float tolerance;                               // for the largest difference of the curves
+};
+
+static const Settings settings[] = {
+  { "303 amp",  0.0f, 0.0f, 1230.0f, 0.0f,   0.5f, 0.0f  },
+  { "ADSR",     3.0f, 1.0f,  200.0f, 0.5f, 100.0f, 1e-5f },
+};
+
+template<class Envelope>
+static void setUp(Envelope &env, const Settings &s) {
+  env.setAttack(s.attack);
+  env.setHold(s.hold);
+  env.setDecay(s.decay);
+  env.setSustainLevel(s.sustain);
+  env.setRelease(s.release);
+}
+
+/** The length of the note that starts at the given sample (16th notes and ties at 130 BPM). */
+static int noteLength(int n) {
+  static const int lengths[] = { 5088, 2544, 20352, 1272, 10176, 636, 2544, 40704 };
+  return lengths[n & 7];
+}
+
+static void processBlock(ReferenceEnvelope &env, float *out, int length) {
+  for (int k = 0; k < length; k++)
+    out[k] = env.getSample();
+}
+
+static void processBlock(AnalogEnvelope &env, float *out, int length) {
+  env.processBlock(out, length);
+}
+
+/** Renders notes that start every other noteLength(), retriggered from the current level as in
+Open303::noteOn, either sample by sample or in blocks. */
+template<class Envelope>
+static void render(Envelope &env, float *out, int numSamples, bool blocks) {
+  int n = 0, next = 0;
+  for (int i = 0; i < numSamples; ) {
+    if (i == next) {
+      if ((n & 1) == 0)
+        env.noteOn(true);
+      else
+        env.noteOff();
+      next += noteLength(n++);
+    }
+    int length = std::min(std::min(DMA_BUF_LEN, numSamples - i), next - i);
+    if (blocks)
+      processBlock(env, out + i, length);
+    else {
+      for (int k = 0; k < length; k++)
+        out[i + k] = env.getSample();
+    }
+    i += length;
+  }
+}
+
+//-------------------------------------------------------------------------------------------------
+
+static bool compareCurves(const Settings &s, int numSamples) {
+  std::vector<float> reference(numSamples), single(numSamples), block(numSamples);
+  ReferenceEnvelope oldEnv;
+  AnalogEnvelope singleEnv, blockEnv;
+  setUp(oldEnv, s);
+  setUp(singleEnv, s);
+  setUp(blockEnv, s);
+  render(oldEnv, reference.data(), numSamples, false);
+  render(singleEnv, single.data(), numSamples, false);
+  render(blockEnv, block.data(), numSamples, true);
+
+  float maxDiff = 0.0f;
+  bool blockMatches = true;
+  for (int i = 0; i < numSamples; i++) {
+    maxDiff = std::max(maxDiff, fabsf(single[i] - reference[i]));
+    blockMatches = blockMatches && block[i] == single[i];
+  }
+  bool ok = maxDiff <= s.tolerance && blockMatches;
+  printf("%-8s  largest difference to the reference %.3g, processBlock %s getSample\n", s.name,
+         maxDiff, blockMatches ? "equals" : "DIFFERS FROM");
+  return ok;
+}
+
+template<class Envelope>
+static double nanosecondsPerSample(const Settings &s, int numSamples, bool blocks) {
+  std::vector<float> out(numSamples);
+  Envelope env;
+  setUp(env, s);
+  auto start = std::chrono::steady_clock::now();
+  render(env, out.data(), numSamples, blocks);
+  auto end = std::chrono::steady_clock::now();
+  volatile float sink = out[numSamples - 1];
+  (void)sink;
+  return std::chrono::duration<double, std::nano>(end - start).count() / numSamples;
+}
+
+int main(int argc, char **argv) {
+  double seconds = argc > 1 ? atof(argv[1]) : 60.0;
+  if (argc > 2 || seconds <= 0.0) {
+    fprintf(stderr, "usage: envelope_bench [seconds]\n");
+    return 1;
+  }
+
+  bool ok = true;
+  for (const Settings &s : settings)
+    ok = compareCurves(s, 20 * SAMPLE_RATE) && ok;
+
+  // the decays towards zero end in denormals, which x86 handles in microcode - flush them, so the
+  // code is timed rather than the host CPU's denormal handling:
+#if defined(__SSE__)
+  _mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+  int numSamples = (int)(seconds * SAMPLE_RATE);
+  printf("\nns/sample over %g s:\n%-8s  %10s %10s %13s\n", seconds, "", "reference", "getSample",
+         "processBlock");
+  for (const Settings &s : settings) {
+    printf("%-8s  %10.2f %10.2f %13.2f\n", s.name,
+           nanosecondsPerSample<ReferenceEnvelope>(s, numSamples, false),
+           nanosecondsPerSample<AnalogEnvelope>(s, numSamples, false),
+           nanosecondsPerSample<AnalogEnvelope>(s, numSamples, true));
+  }
+  printf(ok ? "passed\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
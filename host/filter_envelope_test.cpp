@@ -0,0 +1,128 @@
+/*
+  filter_envelope_test - unit test of the fused filter envelope kernel of Open303
+
+  Open303::renderFilterEnvelope() computes blocks of the main envelope and the instantaneous cutoff
+  frequency with the states of the main envelope and the RCs rc1, rc2 in registers. This test plays
+  random notes (accented and not, with random cutoff, envelope modulation, decay and accent) into
+  two synths and renders the filter envelope of one with the kernel and of the other with the
+  per-sample chain that renderSample() ran before - mainEnv, rc1 and rc2, the normalizers n1 and
+  n2, envScaler/envOffset, the accent gain and powf. The main envelope must be bit-identical, the
+  cutoff may differ by the error of fast_exp2 (which replaced powf).
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 filter_envelope_test.cpp -o filter_envelope_test
+
+  Usage:
+    filter_envelope_test [numNotes]
+
+    numNotes  number of notes per block size (default 500)
+  The exit code is 0 when the test passes.
+*/
+
+#include "rosic_host.h"
+
+/** Open303 with access to the filter envelope - the kernel and the chain as it was. */
+class FilterEnvelopeProbe : public rosic::Open303
+{
+public:
+  void renderKernel(float *mainEnvOut, float *instCutoff, int length)
+  {
+    renderFilterEnvelope(mainEnvOut, instCutoff, length);
+  }
+
+  void renderReference(float *mainEnvOut, float *instCutoff, int length)
+  {
+    for(int i=0; i<length; i++)
+    {
+      mainEnvOut[i] = mainEnv.getSample();
+      float tmp1    = n1 * rc1.getSample(mainEnvOut[i]);
+      float tmp2    = 0.0f;
+      if( accentGain > 0.0f )
+        tmp2 = mainEnvOut[i];
+      tmp2 = n2 * rc2.getSample(tmp2);
+      tmp1 = envScaler * ( tmp1 - envOffset );
+      tmp2 = accentGain*tmp2;
+      instCutoff[i] = cutoff * powf(2.0f, tmp1+tmp2);
+    }
+  }
+};
+
+static FilterEnvelopeProbe kernelSynth, referenceSynth;
+
+static uint32_t testRandomState = 12345;
+static float testRandom(float min, float max) {
+  testRandomState = 1664525 * testRandomState + 1013904223;
+  return min + (max - min) * (testRandomState >> 8) * (1.0f / 16777216.0f);
+}
+
+/** Applies the same parameters or notes to both synths. */
+template<class Function>
+static void both(Function f) {
+  f(kernelSynth);
+  f(referenceSynth);
+}
+
+struct Result
+{
+  long  numSamples = 0;
+  long  envelopeMismatches = 0;
+  float maxCutoffError = 0.0f;  // relative
+};
+
+/** Renders the given number of samples in blocks of blockSize with both synths and compares. */
+static void renderAndCompare(int numSamples, int blockSize, Result &result) {
+  float kernelEnv[32], kernelCutoff[32], referenceEnv[32], referenceCutoff[32];
+  while (numSamples > 0) {
+    int n = std::min(numSamples, blockSize);
+    kernelSynth.renderKernel(kernelEnv, kernelCutoff, n);
+    referenceSynth.renderReference(referenceEnv, referenceCutoff, n);
+    for (int k = 0; k < n; k++) {
+      if (kernelEnv[k] != referenceEnv[k])
+        result.envelopeMismatches++;
+      float error = fabsf(kernelCutoff[k] - referenceCutoff[k]) / referenceCutoff[k];
+      result.maxCutoffError = std::max(result.maxCutoffError, error);
+    }
+    result.numSamples += n;
+    numSamples -= n;
+  }
+}
+
+static bool testBlockSize(int blockSize, int numNotes) {
+  Result result;
+  for (int i = 0; i < numNotes; i++) {
+    float cutoff = testRandom(300.0f, 3000.0f), envMod = testRandom(0.0f, 100.0f);
+    float decay = testRandom(200.0f, 2000.0f), accent = testRandom(0.0f, 100.0f);
+    int   key = (int)testRandom(36.0f, 60.0f), velocity = testRandom(0.0f, 1.0f) < 0.3f ? 127 : 64;
+    int   gate = (int)testRandom(100.0f, 20000.0f), rest = (int)testRandom(0.0f, 5000.0f);
+    both([&](FilterEnvelopeProbe &s) {
+      s.setCutoff(cutoff);
+      s.setEnvMod(envMod);
+      s.setDecay(decay);
+      s.setAccent(accent);
+      s.noteOn(key, velocity, 0.0f);
+    });
+    renderAndCompare(gate, blockSize, result);
+    both([&](FilterEnvelopeProbe &s) { s.noteOff(key, 0.0f); });
+    renderAndCompare(rest, blockSize, result);
+  }
+
+  // fast_exp2 is accurate to about 0.1 cent:
+  bool ok = result.envelopeMismatches == 0 && result.maxCutoffError < 1e-4f;
+  printf("block size %2d: %ld samples, %ld envelope mismatches, cutoff error %.2g relative\n",
+         blockSize, result.numSamples, result.envelopeMismatches, result.maxCutoffError);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  int numNotes = argc > 1 ? atoi(argv[1]) : 500;
+  if (argc > 2 || numNotes <= 0) {
+    fprintf(stderr, "usage: filter_envelope_test [numNotes]\n");
+    return 1;
+  }
+
+  bool ok = true;
+  for (int blockSize : { 1, 7, 32 })
+    ok = testBlockSize(blockSize, numNotes) && ok;
+  printf(ok ? "passed\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
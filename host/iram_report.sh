@@ -0,0 +1,68 @@
+#!/bin/sh
+#
+# iram_report - build-time report of the IRAM usage of the Open303 sketch
+#
+#   host/iram_report.sh build/esp32.esp32.esp32/Open303.ino.elf
+#
+# The ELF is written by "Sketch > Export Compiled Binary" (or arduino-cli compile --export-binaries).
+# For the ESP32-S3, run it with OBJDUMP=xtensa-esp32s3-elf-objdump.
+#
+# It prints the size of the IRAM sections, the audio code that made it into IRAM (the rosic
+# functions and the audio task of the sketch, see HOT_CODE in GlobalDefinitions.h) and every direct
+# call from that code into flash. Those calls are where the render path can still stall on a cache
+# miss, and where it would crash while the cache is disabled. Calls through function pointers
+# (callx) don't show up.
+
+OBJDUMP=${OBJDUMP:-xtensa-esp32-elf-objdump}
+ELF=$1
+if [ ! -f "$ELF" ]; then
+  echo "usage: $0 <sketch.elf>" >&2
+  exit 1
+fi
+
+# the functions that belong to the audio code:
+AUDIO='^(rosic::|audio_task|i2s_output|stallProfile)'
+
+# IRAM address ranges as "start:end start:end ...":
+RANGES=$($OBJDUMP -h "$ELF" | awk '
+  function hex(s,   i, n) { n = 0; s = tolower(s); for(i = 1; i <= length(s); i++) n = n*16 + index("0123456789abcdef", substr(s, i, 1)) - 1; return n }
+  $2 ~ /^\.iram/ { printf "%d:%d ", hex($4), hex($4) + hex($3) }')
+
+echo "IRAM sections:"
+$OBJDUMP -h "$ELF" | awk '
+  function hex(s,   i, n) { n = 0; s = tolower(s); for(i = 1; i <= length(s); i++) n = n*16 + index("0123456789abcdef", substr(s, i, 1)) - 1; return n }
+  $2 ~ /^\.iram/ { printf "  %-24s %7d bytes\n", $2, hex($3); total += hex($3) }
+  END { printf "  %-24s %7d bytes\n", "total", total }'
+
+echo
+echo "audio code in IRAM:"
+$OBJDUMP -t -C "$ELF" | awk -v audio="$AUDIO" '
+  function hex(s,   i, n) { n = 0; s = tolower(s); for(i = 1; i <= length(s); i++) n = n*16 + index("0123456789abcdef", substr(s, i, 1)) - 1; return n }
+  {
+    # address flags section size name... - the name may contain blanks
+    if( !match($0, /[ \t]\.iram[^ \t]*[ \t]+[0-9a-fA-F]+[ \t]+/) ) next
+    name = substr($0, RSTART + RLENGTH); split(substr($0, RSTART, RLENGTH), f, /[ \t]+/)
+    if( $0 !~ / F / || name !~ audio ) next
+    printf "  %7d  %s\n", hex(f[3]), name; total += hex(f[3]); count++
+  }
+  END { printf "  %7d  bytes in %d functions\n", total, count }' | sort -n
+
+echo
+echo "calls from audio code into flash:"
+$OBJDUMP -d -C "$ELF" 2>/dev/null | awk -v audio="$AUDIO" -v ranges="$RANGES" '
+  function hex(s,   i, n) { n = 0; s = tolower(s); for(i = 1; i <= length(s); i++) n = n*16 + index("0123456789abcdef", substr(s, i, 1)) - 1; return n }
+  function inIram(a,   i, r) { for(i = 1; i <= numRanges; i++) { split(range[i], r, ":"); if( a >= r[1] && a < r[2] ) return 1 } return 0 }
+  BEGIN { numRanges = split(ranges, range, " ") }
+  /^[0-9a-f]+ <.*>:$/ {
+    current = $0; sub(/^[0-9a-f]+ </, "", current); sub(/>:$/, "", current)
+    isAudio = (current ~ audio) && inIram(hex($1))
+    next
+  }
+  isAudio && match($0, /\tcall[0-9]*[ \t]+[0-9a-f]+ <[^>]*>/) {
+    call = substr($0, RSTART, RLENGTH); sub(/^\tcall[0-9]*[ \t]+/, "", call)
+    target = call; sub(/ .*/, "", target)
+    if( inIram(hex(target)) ) next
+    sub(/^[0-9a-f]+ </, "", call); sub(/>$/, "", call)
+    if( !seen[current " -> " call]++ ) { printf "  %s -> %s\n", current, call; count++ }
+  }
+  END { if( count == 0 ) print "  none" }'
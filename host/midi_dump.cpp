@@ -0,0 +1,105 @@
+/*
+  midi_dump - runs a recorded MIDI byte stream through the sketch's MIDI input parser
+
+  Reads raw MIDI bytes as they come over the wire (e.g. captured from a MIDI interface with
+  "cat /dev/snd/midiC1D0 > capture.bin", or a hex dump converted with "xxd -r -p") and prints one
+  line per message that rosic::MidiParser produces, with its timestamp in samples. The bytes are
+  timed as if they arrived back to back at 31250 baud (10 bits per byte), so the timestamps show
+  what the sketch would see for a dense stream: a message is stamped with the arrival of its first
+  byte, realtime bytes interleaved into other messages with their own.
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 midi_dump.cpp -o midi_dump
+
+  Usage:
+    midi_dump [-r samplerate] [file]
+
+    -r  sample rate of the timestamps (default 44100)
+    without a file, the bytes are read from stdin
+*/
+
+#include <unistd.h>
+
+#include "rosic_host.h"
+
+static const char* message_name(const rosic::MidiMessage &m) {
+  switch (m.getType()) {
+    case 0x80: return "note off";
+    case 0x90: return "note on";
+    case 0xA0: return "poly pressure";
+    case 0xB0: return "control change";
+    case 0xC0: return "program change";
+    case 0xD0: return "chan pressure";
+    case 0xE0: return "pitch bend";
+  }
+  switch (m.status) {
+    case 0xF0: return "sysex";
+    case 0xF1: return "time code";
+    case 0xF2: return "song position";
+    case 0xF3: return "song select";
+    case 0xF6: return "tune request";
+    case 0xF8: return "clock";
+    case 0xFA: return "start";
+    case 0xFB: return "continue";
+    case 0xFC: return "stop";
+    case 0xFE: return "active sensing";
+    case 0xFF: return "reset";
+  }
+  return "undefined";
+}
+
+static void print_usage() {
+  fprintf(stderr, "usage: midi_dump [-r samplerate] [file]\n");
+}
+
+int main(int argc, char **argv) {
+  double sampleRate = SAMPLE_RATE;
+  int opt;
+  while ((opt = getopt(argc, argv, "r:h")) != -1) {
+    switch (opt) {
+      case 'r': sampleRate = atof(optarg); break;
+      default:
+        print_usage();
+        return 1;
+    }
+  }
+  if (argc - optind > 1 || sampleRate <= 0.0) {
+    print_usage();
+    return 1;
+  }
+  FILE *in = stdin;
+  if (optind < argc && (in = fopen(argv[optind], "rb")) == NULL) {
+    fprintf(stderr, "can't read %s\n", argv[optind]);
+    return 1;
+  }
+
+  const double samplesPerByte = 10.0 * sampleRate / 31250.0;
+  rosic::MidiParser parser;
+  rosic::MidiMessage m;
+  long numBytes = 0, numMessages = 0;
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    double time = numBytes++ * samplesPerByte;
+    if (!parser.parse((uint8_t)c, time, m))
+      continue;
+    numMessages++;
+    printf("%12.1f  %-15s", m.time, message_name(m));
+    if (m.status < 0xF0)
+      printf("  ch %2d", m.getChannel());
+    if (m.status == 0xF0) {
+      printf("  %d bytes%s:", parser.getSysExLength(), parser.isSysExTruncated() ? " (truncated)" : "");
+      for (int i = 0; i < parser.getSysExLength(); i++)
+        printf(" %02X", parser.getSysExData()[i]);
+    } else {
+      if (m.length > 1)
+        printf("  %3d", m.data1);
+      if (m.length > 2)
+        printf("  %3d", m.data2);
+    }
+    printf("\n");
+  }
+  if (in != stdin)
+    fclose(in);
+  fprintf(stderr, "%ld bytes, %ld messages\n", numBytes, numMessages);
+  return 0;
+}
@@ -0,0 +1,259 @@
+/*
+  midi_parser_test - unit test of the MIDI input parser of the sketch (rosic_MidiParser.h)
+
+  Feeds fixed byte streams through rosic::MidiParser, the byte at position i arriving at sample
+  10*i, and checks the messages that come out - status, data, length and timestamp - and the data
+  of complete SysEx messages against the expected ones. The streams cover running status (also
+  cancelled by system common messages), realtime bytes inside channel messages and inside SysEx, a
+  SysEx that is ended by another status byte, a SysEx that is longer than the parser's buffer,
+  stray data bytes and the undefined status bytes 0xF4 and 0xF5. Then a stream of random messages
+  goes through the parser and MidiMessageQueue in small portions, as between the UART event task
+  and the audio task, and must come out complete and in order.
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 midi_parser_test.cpp -o midi_parser_test
+
+  Usage:
+    midi_parser_test
+
+  The exit code is 0 when the test passes.
+*/
+
+#include <vector>
+
+#include "rosic_host.h"
+
+using rosic::MidiMessage;
+using rosic::MidiMessageQueue;
+using rosic::MidiParser;
+
+static const double bytePeriod = 10.0; // arrival time of the byte at position i is bytePeriod*i
+
+struct Expected
+{
+  int     position;    // of the byte the message is stamped with
+  uint8_t status, data1, data2, length;
+  int     sysExLength; // for a SysEx (status 0xF0), -1 otherwise
+  bool    sysExTruncated;
+};
+
+struct TestCase
+{
+  const char            *name;
+  std::vector<uint8_t>  bytes;
+  std::vector<Expected> expected;
+};
+
+static Expected message(int position, uint8_t status, uint8_t data1 = 0, uint8_t data2 = 0,
+                        uint8_t length = 3) {
+  return Expected{position, status, data1, data2, length, -1, false};
+}
+
+static Expected realtime(int position, uint8_t status) {
+  return Expected{position, status, 0, 0, 1, -1, false};
+}
+
+static Expected sysEx(int position, int sysExLength, bool truncated = false) {
+  return Expected{position, 0xF0, 0, 0, 1, sysExLength, truncated};
+}
+
+/** The SysEx data bytes of the streams count up from 1, so they can be checked. */
+static std::vector<uint8_t> sysExBytes(int length) {
+  std::vector<uint8_t> bytes;
+  for (int i = 0; i < length; i++)
+    bytes.push_back((uint8_t)((i + 1) & 0x7F));
+  return bytes;
+}
+
+static std::vector<TestCase> makeTestCases() {
+  std::vector<TestCase> cases;
+
+  cases.push_back({ "running status",
+    { 0x90, 0x3C, 0x64,   0x3E, 0x64,   0x40, 0x00 },
+    { message(0, 0x90, 0x3C, 0x64), message(3, 0x90, 0x3E, 0x64), message(5, 0x90, 0x40, 0x00) } });
+
+  cases.push_back({ "running status with one data byte",
+    { 0xC0, 0x05,   0x06,   0xD1, 0x40,   0x41 },
+    { message(0, 0xC0, 0x05, 0, 2), message(2, 0xC0, 0x06, 0, 2), message(3, 0xD1, 0x40, 0, 2),
+      message(5, 0xD1, 0x41, 0, 2) } });
+
+  cases.push_back({ "running status kept by a realtime byte",
+    { 0x90, 0x3C, 0x64,   0xF8,   0x3E, 0x64 },
+    { message(0, 0x90, 0x3C, 0x64), realtime(3, 0xF8), message(4, 0x90, 0x3E, 0x64) } });
+
+  cases.push_back({ "running status cancelled by song select",
+    { 0x90, 0x3C, 0x64,   0xF3, 0x05,   0x3E, 0x64,   0x90, 0x40, 0x00 },
+    { message(0, 0x90, 0x3C, 0x64), message(3, 0xF3, 0x05, 0, 2), message(7, 0x90, 0x40, 0x00) } });
+
+  cases.push_back({ "running status cancelled by song position",
+    { 0xB0, 0x07, 0x7F,   0xF2, 0x10, 0x20,   0x07, 0x00 },
+    { message(0, 0xB0, 0x07, 0x7F), message(3, 0xF2, 0x10, 0x20) } });
+
+  cases.push_back({ "running status cancelled by tune request",
+    { 0x90, 0x3C, 0x64,   0xF6,   0x3E, 0x64 },
+    { message(0, 0x90, 0x3C, 0x64), message(3, 0xF6, 0, 0, 1) } });
+
+  cases.push_back({ "realtime bytes inside a channel message",
+    { 0x90, 0xF8, 0x3C, 0xFA, 0x64,   0x3E, 0xFC, 0x00 },
+    { realtime(1, 0xF8), realtime(3, 0xFA), message(0, 0x90, 0x3C, 0x64), realtime(6, 0xFC),
+      message(5, 0x90, 0x3E, 0x00) } });
+
+  cases.push_back({ "realtime bytes inside a pitch bend under running status",
+    { 0xE0, 0x00, 0x40,   0x7F, 0xF8, 0x7F },
+    { message(0, 0xE0, 0x00, 0x40), realtime(4, 0xF8), message(3, 0xE0, 0x7F, 0x7F) } });
+
+  cases.push_back({ "realtime bytes inside a SysEx",
+    { 0xF0, 0x01, 0xF8, 0x02, 0x03, 0xFE, 0xF7 },
+    { realtime(2, 0xF8), realtime(5, 0xFE), sysEx(0, 3) } });
+
+  cases.push_back({ "SysEx ended by another status byte",
+    { 0xF0, 0x01, 0x02,   0x90, 0x3C, 0x64,   0xF7,   0x3E, 0x64 },
+    { message(3, 0x90, 0x3C, 0x64), message(7, 0x90, 0x3E, 0x64) } });
+
+  cases.push_back({ "SysEx ended by a system common message",
+    { 0xF0, 0x01,   0xF3, 0x02,   0xF7 },
+    { message(2, 0xF3, 0x02, 0, 2) } });
+
+  cases.push_back({ "SysEx after a SysEx",
+    { 0xF0, 0x01, 0x02, 0xF7,   0xF0, 0x01, 0xF7 },
+    { sysEx(0, 2), sysEx(4, 1) } });
+
+  {
+    int length = MidiParser::maxSysExLength + 10;
+    TestCase c = { "truncated SysEx", { 0xF0 }, { sysEx(0, MidiParser::maxSysExLength, true),
+                                                  message(length + 2, 0x80, 0x3C, 0x00) } };
+    std::vector<uint8_t> data = sysExBytes(length);
+    c.bytes.insert(c.bytes.end(), data.begin(), data.end());
+    c.bytes.insert(c.bytes.end(), { 0xF7, 0x80, 0x3C, 0x00 });
+    cases.push_back(c);
+  }
+
+  {
+    int length = MidiParser::maxSysExLength;
+    TestCase c = { "SysEx that just fits", { 0xF0 }, { sysEx(0, length) } };
+    std::vector<uint8_t> data = sysExBytes(length);
+    c.bytes.insert(c.bytes.end(), data.begin(), data.end());
+    c.bytes.push_back(0xF7);
+    cases.push_back(c);
+  }
+
+  cases.push_back({ "stray data bytes, also after a SysEx",
+    { 0x3C, 0x64,   0x90, 0x3C, 0x64,   0xF0, 0x01, 0xF7,   0x3E, 0x64,   0x90, 0x40, 0x00 },
+    { message(2, 0x90, 0x3C, 0x64), sysEx(5, 1), message(10, 0x90, 0x40, 0x00) } });
+
+  cases.push_back({ "undefined F4 and F5",
+    { 0x90, 0x3C, 0x64,   0xF4, 0x3E, 0x64,   0xF5, 0x40,   0xB0, 0x07, 0x7F },
+    { message(0, 0x90, 0x3C, 0x64), message(8, 0xB0, 0x07, 0x7F) } });
+
+  cases.push_back({ "undefined F4 ends a SysEx",
+    { 0xF0, 0x01, 0xF4, 0x02, 0xF7,   0xF8 },
+    { realtime(5, 0xF8) } });
+
+  return cases;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+static bool sameMessage(const MidiMessage &m, const Expected &e, const MidiParser &parser) {
+  if (m.time != bytePeriod * e.position || m.status != e.status || m.data1 != e.data1
+      || m.data2 != e.data2 || m.length != e.length)
+    return false;
+  if (e.status != 0xF0)
+    return true;
+  if (parser.getSysExLength() != e.sysExLength || parser.isSysExTruncated() != e.sysExTruncated)
+    return false;
+  std::vector<uint8_t> data = sysExBytes(e.sysExLength);
+  return memcmp(parser.getSysExData(), data.data(), data.size()) == 0;
+}
+
+static void printMessage(const char *what, double time, uint8_t status, uint8_t data1,
+                         uint8_t data2, int length) {
+  fprintf(stderr, "    %s: %6.0f  %02X %02X %02X (%d bytes)\n", what, time, status, data1, data2,
+          length);
+}
+
+static bool runTestCase(const TestCase &c) {
+  MidiParser parser;
+  MidiMessage m;
+  size_t next = 0;
+  bool ok = true;
+  for (size_t i = 0; i < c.bytes.size(); i++) {
+    if (!parser.parse(c.bytes[i], bytePeriod * i, m))
+      continue;
+    if (next >= c.expected.size()) {
+      fprintf(stderr, "  %s: unexpected message at byte %zu\n", c.name, i);
+      printMessage("got", m.time, m.status, m.data1, m.data2, m.length);
+      ok = false;
+      continue;
+    }
+    const Expected &e = c.expected[next++];
+    if (!sameMessage(m, e, parser)) {
+      fprintf(stderr, "  %s: wrong message at byte %zu\n", c.name, i);
+      printMessage("got     ", m.time, m.status, m.data1, m.data2, m.length);
+      printMessage("expected", bytePeriod * e.position, e.status, e.data1, e.data2, e.length);
+      if (e.status == 0xF0)
+        fprintf(stderr, "    SysEx: %d bytes%s, expected %d%s\n", parser.getSysExLength(),
+                parser.isSysExTruncated() ? " (truncated)" : "", e.sysExLength,
+                e.sysExTruncated ? " (truncated)" : "");
+      ok = false;
+    }
+  }
+  if (next < c.expected.size()) {
+    fprintf(stderr, "  %s: %zu of %zu messages missing\n", c.name, c.expected.size() - next,
+            c.expected.size());
+    ok = false;
+  }
+  printf("%-56s %s\n", c.name, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+//-------------------------------------------------------------------------------------------------
+// the queue between the UART event task and the audio task:
+
+static uint32_t testRandomState = 12345;
+static int testRandom(int howBig) {
+  testRandomState = 1664525 * testRandomState + 1013904223;
+  return (int)((testRandomState >> 8) % (uint32_t)howBig);
+}
+
+/** Parses random channel messages in portions of up to a queue's worth of messages, reads them
+back from the queue in between and compares them with what was sent. */
+static bool testQueue(int numMessages) {
+  MidiParser parser;
+  MidiMessageQueue queue;
+  std::vector<uint32_t> sent, received;
+  MidiMessage m;
+  double time = 0.0;
+  while ((int)sent.size() < numMessages) {
+    int portion = 1 + testRandom(MidiMessageQueue::queueSize);
+    for (int k = 0; k < portion && (int)sent.size() < numMessages; k++) {
+      uint8_t status = (uint8_t)(0x80 + 16 * testRandom(7) + testRandom(16));
+      uint8_t data1 = (uint8_t)testRandom(128), data2 = (uint8_t)testRandom(128);
+      int length = rosic::MidiOutput::getMessageLength(status);
+      sent.push_back(status | (data1 << 8) | (length > 2 ? data2 << 16 : 0));
+      uint8_t bytes[3] = { status, data1, data2 };
+      for (int b = 0; b < length; b++, time += bytePeriod)
+        if (parser.parse(bytes[b], time, m) && !queue.write(m))
+          fprintf(stderr, "  queue: message dropped\n");
+    }
+    while (queue.read(m))
+      received.push_back(m.status | (m.data1 << 8) | (m.data2 << 16));
+  }
+  bool ok = received == sent && queue.getNumDropped() == 0;
+  printf("%-56s %s\n", "queue", ok ? "ok" : "FAILED");
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  if (argc > 1) {
+    fprintf(stderr, "usage: midi_parser_test\n");
+    return 1;
+  }
+
+  bool ok = true;
+  for (const TestCase &c : makeTestCases())
+    ok = runTestCase(c) && ok;
+  ok = testQueue(100000) && ok;
+  printf(ok ? "passed\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,596 @@
+/*
+  midi_render - streaming MIDI to PCM renderer for pipelines
+
+  Plays MIDI through the sketch's synth and writes the audio as raw interleaved stereo PCM to
+  stdout, e.g. into sox, ffmpeg or aplay. The input is a Standard MIDI File (format 0 or 1) or a
+  stream of raw MIDI bytes, read from a file or from stdin. The MIDI handling is that of the sketch
+  (midi_handler.ino and presets.ino), the voice and master chain are the same as in the audio task
+  of Open303.ino, and like there, the events take effect at the start of the block in which they
+  are due - so the block size is also the timing resolution.
+
+  Memory stays bounded for inputs of any length: the tracks of a MIDI file are merged while they
+  are read, each through a small buffer of its own (a file from stdin is spooled to a temporary
+  file for that), and raw bytes are parsed as they come.
+
+  Raw MIDI has no timing of its own: in real time mode, the bytes take effect when they arrive
+  (e.g. from "amidi -d"), otherwise they are timed as if they came back to back over a MIDI cable
+  (31250 baud).
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 midi_render.cpp -o midi_render
+
+  Usage:
+    midi_render [-b blocksize] [-r] [-t tail] [-f format] [-d drumbank] [-w wavfile]
+                [-s scale.scl] [-k mapping.kbm] [-u wavebank] [file]
+
+    -b  block size in samples, 1...128 (default 32, as in the sketch)
+    -r  real time: the output is paced by the wall clock, raw MIDI takes effect as it arrives
+    -t  seconds rendered after the last event (default 2)
+    -f  sample format: s16 (default, signed 16 bit little endian) or f32 (32 bit float)
+    -d  drum sample bank (see rosic_SampleBank.h), without it the synthesized drums play
+    -w  also record the output (16 bit) to a WAV file through the sketch's recorder, with the
+        writer in a thread of its own like the SD card writer task (see rosic_AudioRecorder.h)
+    -s  tune the synth to a Scala scale (see rosic_TuningTable.h)
+    -k  Scala keyboard mapping for the scale
+    -u  bank of user waveforms (see rosic_WaveBank.h, built by wave_bank), selected by
+        CC_303_USER_WAVE as on the device
+
+  The render speed is reported on stderr as a multiple of real time. Examples:
+
+    midi_render song.mid | sox -t raw -r 44100 -e signed -b 16 -c 2 - song.flac
+    amidi -p hw:1 -d | midi_render -r | aplay -f cd
+    midi_render -w song.wav song.mid > /dev/null
+*/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "rosic_host.h"
+
+// sketch configuration, as in Open303.ino and AcidBanger.ino:
+#define SYNTH1_MIDI_CHAN        1
+#define DRUM_MIDI_CHAN          10
+#define DRUMKIT_SIZE            12
+#define WAVES_PARTITION         "waves" // handles CC_303_USER_WAVE, the bank itself comes from -u
+
+// the sketch globals (see Open303.ino):
+float bpm = 130.0f;
+
+rosic::Open303 Synth;
+rosic::WaveShaper Overdrive, Distortion;
+rosic::StereoPanner SynthPan, DrumPan;
+rosic::Compressor Comp;
+rosic::SampleBank DrumBank;
+rosic::WaveBank Waves;
+rosic::DrumSampler Drums;
+rosic::DrumSynth SynthDrums;
+rosic::ClockTracker MidiClock;
+rosic::Transport SampleClock;
+rosic::PresetBank Presets;
+rosic::PresetMorpher Morph;
+rosic::AudioRecorder Recorder;
+
+inline double sample_time_now() {
+  return (double)SampleClock.getSampleTime();
+}
+
+// prototypes of the sketch functions that are used before their definition:
+void presetsInit();
+void selectProgram(uint8_t number);
+void setMorphTarget(uint8_t number);
+void storePreset(uint8_t number);
+
+#include "midi_handler.ino"
+#include "presets.ino"
+
+//-------------------------------------------------------------------------------------------------
+// Standard MIDI File input:
+
+/** Reads one track of a MIDI file through a small buffer of its own, so all tracks can be read
+side by side from the same file. */
+struct TrackReader
+{
+  int      fd;
+  off_t    pos, end;       // file position of the buffer end and of the track end
+  uint8_t  buf[256];
+  int      bufPos, bufLen;
+  uint64_t tick;           // absolute tick of the next event
+  uint8_t  runningStatus;
+  bool     done;
+
+  int nextByte() {
+    if (bufPos == bufLen) {
+      if (pos >= end)
+        return -1;
+      size_t n = (size_t)(end - pos) < sizeof(buf) ? (size_t)(end - pos) : sizeof(buf);
+      ssize_t r = pread(fd, buf, n, pos);
+      if (r <= 0)
+        return -1;
+      pos   += r;
+      bufPos = 0;
+      bufLen = (int)r;
+    }
+    return buf[bufPos++];
+  }
+
+  bool readVarLen(uint32_t &value) {
+    value = 0;
+    for (int i = 0; i < 4; i++) {
+      int c = nextByte();
+      if (c < 0)
+        return false;
+      value = (value << 7) | (c & 0x7F);
+      if (!(c & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool skip(uint32_t numBytes) {
+    while (numBytes-- > 0) {
+      if (nextByte() < 0)
+        return false;
+    }
+    return true;
+  }
+
+  /** Reads the delta time of the next event. */
+  void readDelta() {
+    uint32_t delta;
+    if (done || !readVarLen(delta))
+      done = true;
+    else
+      tick += delta;
+  }
+};
+
+/** Merges the tracks of a MIDI file into one stream of timed messages. */
+class MidiFileReader
+{
+public:
+  bool open(int fd, double sampleRate) {
+    uint8_t h[14];
+    if (pread(fd, h, 14, 0) != 14 || memcmp(h, "MThd", 4) != 0)
+      return false;
+    uint32_t headerLength = read_be(h + 4, 4);
+    int      numTracks    = (int)read_be(h + 10, 2);
+    int16_t  division     = (int16_t)read_be(h + 12, 2);
+    if (division > 0) {
+      ticksPerQuarter = division;
+      samplesPerTick  = sampleRate * 0.5 / division;  // 120 BPM until a tempo event comes
+      smpte           = false;
+    } else {
+      int fps         = -(division >> 8);
+      int perFrame    = division & 0xFF;
+      if (fps <= 0 || perFrame <= 0)
+        return false;
+      samplesPerTick  = sampleRate / ((fps == 29 ? 29.97 : fps) * perFrame);
+      smpte           = true;
+    }
+    this->sampleRate = sampleRate;
+
+    off_t pos = 8 + headerLength;
+    for (int t = 0; t < numTracks; t++) {
+      uint8_t c[8];
+      if (pread(fd, c, 8, pos) != 8)
+        break;
+      uint32_t length = read_be(c + 4, 4);
+      if (memcmp(c, "MTrk", 4) == 0) {
+        TrackReader tr;
+        tr.fd = fd;
+        tr.pos = pos + 8;
+        tr.end = pos + 8 + length;
+        tr.bufPos = tr.bufLen = 0;
+        tr.tick = 0;
+        tr.runningStatus = 0;
+        tr.done = false;
+        tracks.push_back(tr);
+        tracks.back().readDelta();
+      }
+      pos += 8 + length;
+    }
+    return !tracks.empty();
+  }
+
+  /** Returns the next channel or realtime message with its time in samples. */
+  bool next(rosic::MidiMessage &m) {
+    while (true) {
+      TrackReader *t = NULL;
+      for (size_t i = 0; i < tracks.size(); i++) {
+        if (!tracks[i].done && (t == NULL || tracks[i].tick < t->tick))
+          t = &tracks[i];
+      }
+      if (t == NULL)
+        return false;
+      currentTime += (double)(t->tick - currentTick) * samplesPerTick;
+      currentTick  = t->tick;
+      if (readEvent(*t, m)) {
+        m.time = currentTime;
+        t->readDelta();
+        return true;
+      }
+      t->readDelta();
+    }
+  }
+
+protected:
+  static uint32_t read_be(const uint8_t *p, int numBytes) {
+    uint32_t v = 0;
+    for (int i = 0; i < numBytes; i++)
+      v = (v << 8) | p[i];
+    return v;
+  }
+
+  /** Reads an event, returns true for a message that goes to the synth (meta events and SysEx
+  are consumed here). */
+  bool readEvent(TrackReader &t, rosic::MidiMessage &m) {
+    int c = t.nextByte();
+    if (c < 0) {
+      t.done = true;
+      return false;
+    }
+    uint32_t length;
+    if (c == 0xFF) {                     // meta event
+      int type = t.nextByte();
+      if (type < 0 || !t.readVarLen(length)) {
+        t.done = true;
+        return false;
+      }
+      if (type == 0x2F) {
+        t.done = true;
+      } else if (type == 0x51 && length == 3 && !smpte) {
+        uint32_t usPerQuarter = 0;
+        for (int i = 0; i < 3; i++)
+          usPerQuarter = (usPerQuarter << 8) | (t.nextByte() & 0xFF);
+        samplesPerTick = sampleRate * usPerQuarter * 1e-6 / ticksPerQuarter;
+      } else if (!t.skip(length)) {
+        t.done = true;
+      }
+      return false;
+    }
+    if (c == 0xF0 || c == 0xF7) {        // SysEx
+      if (!t.readVarLen(length) || !t.skip(length))
+        t.done = true;
+      t.runningStatus = 0;
+      return false;
+    }
+
+    int status = c, data1;
+    if (c & 0x80) {
+      t.runningStatus = (uint8_t)c;
+      data1 = t.nextByte();
+    } else {
+      status = t.runningStatus;
+      data1  = c;
+    }
+    if (status < 0x80 || data1 < 0) {
+      t.done = true;                     // corrupt track
+      return false;
+    }
+    int length2 = rosic::MidiOutput::getMessageLength((uint8_t)status);
+    int data2   = length2 > 2 ? t.nextByte() : 0;
+    if (data2 < 0) {
+      t.done = true;
+      return false;
+    }
+    m.status = (uint8_t)status;
+    m.data1  = (uint8_t)data1;
+    m.data2  = (uint8_t)data2;
+    m.length = (uint8_t)length2;
+    return true;
+  }
+
+  std::vector<TrackReader> tracks;
+  uint64_t currentTick     = 0;
+  double   currentTime     = 0.0;
+  double   samplesPerTick  = 1.0;
+  double   sampleRate      = SAMPLE_RATE;
+  int      ticksPerQuarter = 96;
+  bool     smpte           = false;
+};
+
+//-------------------------------------------------------------------------------------------------
+// rendering:
+
+struct RenderSettings
+{
+  int         blockSize = 32;
+  bool        realTime  = false;
+  float       tail      = 2.0f;
+  bool        floatOut  = false;
+  const char* drumBank  = NULL;
+  const char* wavFile   = NULL;
+  const char* scale     = NULL;
+  const char* mapping   = NULL;
+  const char* waveBank  = NULL;
+  const char* input     = NULL;
+};
+
+/** The voice and master chain of audio_task1() for one block, written to stdout. Returns false
+when the output is closed. */
+static bool render_block(const RenderSettings &settings, float *synth_buf, float *drum_buf,
+                         float *mix_buf, int16_t *out_buf) {
+  int n = settings.blockSize;
+  Morph.update();
+  Synth.processBlock(synth_buf, n);
+  Overdrive.processBlock(synth_buf, n);
+  Distortion.processBlock(synth_buf, n);
+  memset(drum_buf, 0, n * sizeof(float));
+  Drums.processBlock(drum_buf, n);
+  SynthDrums.processBlock(drum_buf, n);
+  memset(mix_buf, 0, 2 * n * sizeof(float));
+  SynthPan.processBlock(synth_buf, mix_buf, n);
+  DrumPan.processBlock(drum_buf, mix_buf, n);
+  size_t written;
+  if (settings.floatOut) {
+    Comp.processBlock(mix_buf);
+    written = fwrite(mix_buf, sizeof(float), 2 * n, stdout);
+    if (settings.wavFile != NULL) {
+      for (int i = 0; i < 2 * n; i++)
+        out_buf[i] = (int16_t)rosic::clip(32767.0f * mix_buf[i], -32768.0f, 32767.0f);
+    }
+  } else {
+    Comp.processBlock(mix_buf, out_buf);
+    written = fwrite(out_buf, sizeof(int16_t), 2 * n, stdout);
+  }
+  Recorder.write(out_buf, n);
+  SampleClock.advance(n);
+  return written == (size_t)(2 * n);
+}
+
+static double now_seconds() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/** Waits until the wall clock has reached the given time. */
+static void wait_until(double seconds) {
+  struct timespec ts;
+  ts.tv_sec  = (time_t)seconds;
+  ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1e9);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {}
+}
+
+/** Copies a stream to an unnamed temporary file, such that it can be read at random positions. */
+static int spool(int fd, const uint8_t *head, int headLength) {
+  FILE *tmp = tmpfile();
+  if (tmp == NULL)
+    return -1;
+  uint8_t buf[4096];
+  fwrite(head, 1, headLength, tmp);
+  ssize_t n;
+  while ((n = read(fd, buf, sizeof(buf))) > 0)
+    fwrite(buf, 1, n, tmp);
+  if (fflush(tmp) != 0)
+    return -1;
+  return dup(fileno(tmp));  // the FILE is never closed, the file lives until the process ends
+}
+
+/** Reads a whole text file into a string, returns false when it can't be read. */
+static bool read_text(const char *path, std::string &text) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL)
+    return false;
+  char buf[4096];
+  size_t n;
+  text.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    text.append(buf, n);
+  fclose(f);
+  return true;
+}
+
+static void print_usage() {
+  fprintf(stderr,
+    "usage: midi_render [-b blocksize] [-r] [-t tail] [-f s16|f32] [-d drumbank] [-w wavfile]\n"
+    "                   [-s scale.scl] [-k mapping.kbm] [-u wavebank] [file]\n");
+}
+
+int main(int argc, char **argv) {
+  RenderSettings settings;
+  int opt;
+  while ((opt = getopt(argc, argv, "b:rt:f:d:w:s:k:u:h")) != -1) {
+    switch (opt) {
+      case 'b': settings.blockSize = atoi(optarg);               break;
+      case 'r': settings.realTime  = true;                       break;
+      case 't': settings.tail      = (float)atof(optarg);        break;
+      case 'f': settings.floatOut  = strcmp(optarg, "f32") == 0;
+                if (!settings.floatOut && strcmp(optarg, "s16") != 0) {
+                  print_usage();
+                  return 1;
+                }
+                break;
+      case 'd': settings.drumBank  = optarg;                     break;
+      case 'w': settings.wavFile   = optarg;                     break;
+      case 's': settings.scale     = optarg;                     break;
+      case 'k': settings.mapping   = optarg;                     break;
+      case 'u': settings.waveBank  = optarg;                     break;
+      default:
+        print_usage();
+        return 1;
+    }
+  }
+  if (argc - optind > 1 || settings.blockSize < 1 || settings.blockSize > rosic::Compressor::maxBlockSize
+      || settings.tail < 0.0f) {
+    print_usage();
+    return 1;
+  }
+  settings.input = optind < argc ? argv[optind] : NULL;
+  int fd = settings.input ? open(settings.input, O_RDONLY) : STDIN_FILENO;
+  if (fd < 0) {
+    fprintf(stderr, "can't read %s\n", settings.input);
+    return 1;
+  }
+  signal(SIGPIPE, SIG_IGN); // a closed pipe shows up as a failed write
+
+  // what setup() does:
+  SampleClock.setTempo(bpm);
+  Overdrive.setMode(rosic::WaveShaper::TANH);
+  Overdrive.setBypass(true);
+  Distortion.setMode(rosic::WaveShaper::HARDCLIP);
+  Distortion.setBypass(true);
+  Comp.setBlockSize(settings.blockSize);
+  if (settings.drumBank != NULL) {
+    if (!DrumBank.open(settings.drumBank)) {
+      fprintf(stderr, "can't open drum bank %s\n", settings.drumBank);
+      return 1;
+    }
+    Drums.setSampleBank(&DrumBank);
+  }
+  if (settings.waveBank != NULL && !Waves.open(settings.waveBank)) {
+    fprintf(stderr, "can't open wave bank %s\n", settings.waveBank);
+    return 1;
+  }
+  presetsInit();
+
+  std::string text;
+  if (settings.scale != NULL
+      && !(read_text(settings.scale, text) && Synth.tuningTable.setScale(text.c_str()))) {
+    fprintf(stderr, "can't load the scale %s\n", settings.scale);
+    return 1;
+  }
+  if (settings.mapping != NULL
+      && !(read_text(settings.mapping, text) && Synth.tuningTable.setKeyboardMapping(text.c_str()))) {
+    fprintf(stderr, "can't load the keyboard mapping %s\n", settings.mapping);
+    return 1;
+  }
+
+  // the recorder's writer, polling like the writer task on the device:
+  std::atomic<bool> rendering(true);
+  std::thread writer;
+  if (settings.wavFile != NULL) {
+    Recorder.setSampleRate(SAMPLE_RATE);
+    if (!Recorder.start(settings.wavFile)) {
+      fprintf(stderr, "can't write %s\n", settings.wavFile);
+      return 1;
+    }
+    writer = std::thread([&rendering]() {
+      while (rendering) {
+        if (Recorder.service() == 0)
+          std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+    });
+  }
+
+  // a MIDI file starts with "MThd", anything else is raw MIDI:
+  uint8_t head[4];
+  int headLength = 0;
+  while (headLength < 4) {
+    ssize_t n = read(fd, head + headLength, 4 - headLength);
+    if (n <= 0)
+      break;
+    headLength += (int)n;
+  }
+  bool isFile = headLength == 4 && memcmp(head, "MThd", 4) == 0;
+  MidiFileReader file;
+  if (isFile) {
+    if (lseek(fd, 0, SEEK_SET) != 0)
+      fd = spool(fd, head, headLength);
+    if (fd < 0 || !file.open(fd, SAMPLE_RATE)) {
+      fprintf(stderr, "can't read the MIDI file\n");
+      return 1;
+    }
+  }
+  rosic::MidiParser parser;
+  FILE *raw = isFile ? NULL : fdopen(fd, "rb");
+  int headPos = 0;  // the bytes of the raw stream that were read for the detection come first
+  double nextByteTime = 0.0;
+  const double samplesPerByte = 10.0 * SAMPLE_RATE / 31250.0;
+
+  float   synth_buf[rosic::Compressor::maxBlockSize], drum_buf[rosic::Compressor::maxBlockSize];
+  float   mix_buf[2 * rosic::Compressor::maxBlockSize];
+  int16_t out_buf[2 * rosic::Compressor::maxBlockSize];
+  rosic::MidiMessage pending;
+  bool   havePending = false, inputDone = false;
+  double endTime = 0.0;    // in samples, set when the input is done
+  double blockTime = 0.0;
+  double start = now_seconds();
+  struct pollfd pfd = { fd, POLLIN, 0 };
+
+  while (true) {
+    double blockEnd = blockTime + settings.blockSize;
+    if (isFile) {
+      // the events that are due in this block:
+      while (!inputDone) {
+        if (!havePending && !(havePending = file.next(pending))) {
+          inputDone = true;
+          break;
+        }
+        if (pending.time >= blockEnd)
+          break;
+        handleMidiMessage(pending);
+        havePending = false;
+      }
+    } else if (settings.realTime) {
+      // the bytes that have arrived, they take effect now:
+      while (!inputDone && headPos < headLength)
+        if (parser.parse(head[headPos++], blockTime, pending))
+          handleMidiMessage(pending);
+      while (!inputDone && poll(&pfd, 1, 0) > 0) {
+        uint8_t buf[256];
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+          inputDone = true;
+          break;
+        }
+        for (ssize_t i = 0; i < n; i++)
+          if (parser.parse(buf[i], blockTime, pending))
+            handleMidiMessage(pending);
+      }
+    } else {
+      // the bytes that would have arrived over the cable in this block:
+      while (!inputDone && nextByteTime < blockEnd) {
+        int c = headPos < headLength ? head[headPos++] : fgetc(raw);
+        if (c == EOF) {
+          inputDone = true;
+          break;
+        }
+        if (parser.parse((uint8_t)c, nextByteTime, pending))
+          handleMidiMessage(pending);
+        nextByteTime += samplesPerByte;
+      }
+    }
+    if (inputDone && endTime == 0.0)
+      endTime = blockTime + settings.tail * SAMPLE_RATE;
+    if (inputDone && blockTime >= endTime)
+      break;
+
+    userWaveService(); // CC_303_USER_WAVE, done by loop() on the device
+    if (!render_block(settings, synth_buf, drum_buf, mix_buf, out_buf)) {
+      fprintf(stderr, "output closed\n");
+      break;
+    }
+    blockTime = blockEnd;
+    if (settings.realTime) {
+      fflush(stdout);
+      wait_until(start + blockTime / SAMPLE_RATE);
+    }
+  }
+  fflush(stdout);
+  if (writer.joinable()) {
+    rendering = false;
+    writer.join();
+    Recorder.close();
+    fprintf(stderr, "%s: %u frames, %u overflows (%u frames dropped), max fill %u of %d bytes%s\n",
+            settings.wavFile, (unsigned)Recorder.getNumFramesRecorded(),
+            (unsigned)Recorder.getNumOverflows(), (unsigned)Recorder.getNumDroppedFrames(),
+            (unsigned)Recorder.getMaxFill(), Recorder.getBufferSize(),
+            Recorder.hasError() ? ", write error" : "");
+  }
+
+  double elapsed = now_seconds() - start;
+  double audio   = blockTime / SAMPLE_RATE;
+  fprintf(stderr, "%.1f s of audio in %.1f s, %.1fx realtime\n", audio, elapsed,
+          elapsed > 0.0 ? audio / elapsed : 0.0);
+  return 0;
+}
@@ -0,0 +1,160 @@
+/*
+  note_stack_test - stress test of the note handling of Open303 (rosic_NoteStack.h)
+
+  Runs millions of random note events (note ons, note offs, all notes off) through the synth, with
+  some audio rendered in between, and counts the heap allocations while doing so - there must be
+  none. Then checks NoteStack against a straightforward reference model (a list of the held notes
+  in the order in which they were pressed) in all note priority modes.
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 note_stack_test.cpp -o note_stack_test
+
+  Usage:
+    note_stack_test [numEvents]
+
+    numEvents  number of note events for the allocation test (default 3000000), the reference
+               test runs a tenth of them per priority mode
+  The exit code is 0 when all tests pass.
+*/
+
+#include <new>
+#include <vector>
+
+#include "rosic_host.h"
+
+//-------------------------------------------------------------------------------------------------
+// heap traffic:
+
+static volatile bool     countAllocations = false;
+static volatile uint64_t numAllocations   = 0;
+
+static void* countedAlloc(size_t size) {
+  if (countAllocations)
+    numAllocations++;
+  void *p = malloc(size > 0 ? size : 1);
+  if (p == NULL)
+    throw std::bad_alloc();
+  return p;
+}
+void* operator new(size_t size)             { return countedAlloc(size); }
+void* operator new[](size_t size)           { return countedAlloc(size); }
+void  operator delete(void *p) noexcept     { free(p); }
+void  operator delete[](void *p) noexcept   { free(p); }
+void  operator delete(void *p, size_t) noexcept   { free(p); }
+void  operator delete[](void *p, size_t) noexcept { free(p); }
+
+static uint32_t testRandomState = 12345;
+static int testRandom(int howBig) {
+  testRandomState = 1664525 * testRandomState + 1013904223;
+  return (int)((testRandomState >> 8) % (uint32_t)howBig);
+}
+
+static rosic::Open303 Synth;
+
+/** Plays random notes - chords, clusters and releases in any order - and counts the allocations. */
+static bool testAllocations(long numEvents) {
+  float buffer[DMA_BUF_LEN];
+  numAllocations   = 0;
+  countAllocations = true;
+  for (long i = 0; i < numEvents; i++) {
+    int r = testRandom(1000);
+    if (r == 0)
+      Synth.allNotesOff();
+    else if (r < 550)
+      Synth.noteOn(24 + testRandom(48), 1 + testRandom(127), 0.0f);
+    else
+      Synth.noteOff(24 + testRandom(48), 0.0f);
+    if ((i & 15) == 0)
+      Synth.processBlock(buffer, DMA_BUF_LEN);
+    if ((i & 0xFFFFF) == 0)
+      Synth.setNotePriority(testRandom(rosic::NoteStack::NUM_PRIORITIES));
+  }
+  countAllocations = false;
+  printf("%ld note events, %llu heap allocations\n", numEvents, (unsigned long long)numAllocations);
+  return numAllocations == 0;
+}
+
+//-------------------------------------------------------------------------------------------------
+// reference model:
+
+struct HeldNote
+{
+  int key, velocity;
+};
+
+/** The held notes, the most recent first - what std::list did in Open303 before. */
+static int referenceKey(const std::vector<HeldNote> &held, int priority) {
+  if (held.empty())
+    return -1;
+  int key = held[0].key;
+  for (const HeldNote &n : held) {
+    if ((priority == rosic::NoteStack::LOW_NOTE && n.key < key)
+        || (priority == rosic::NoteStack::HIGH_NOTE && n.key > key))
+      key = n.key;
+  }
+  return key;
+}
+
+static bool testAgainstReference(long numEvents, int priority) {
+  static const char *names[] = { "last", "low", "high" };
+  rosic::NoteStack stack;
+  stack.setPriority(priority);
+  std::vector<HeldNote> held;
+  long numMismatches = 0;
+  for (long i = 0; i < numEvents; i++) {
+    int r   = testRandom(1000);
+    int key = testRandom(rosic::NoteStack::numKeys);
+    if (r == 0) {
+      stack.clear();
+      held.clear();
+    } else if (r < 520) {
+      int velocity = 1 + testRandom(127);
+      stack.push(key, velocity);
+      for (size_t k = 0; k < held.size(); k++) {
+        if (held[k].key == key) {
+          held.erase(held.begin() + k);
+          break;
+        }
+      }
+      held.insert(held.begin(), HeldNote{key, velocity});
+    } else {
+      stack.remove(key);
+      for (size_t k = 0; k < held.size(); k++) {
+        if (held[k].key == key) {
+          held.erase(held.begin() + k);
+          break;
+        }
+      }
+    }
+
+    int expected = referenceKey(held, priority);
+    int expectedVelocity = 0;
+    for (const HeldNote &n : held) {
+      if (n.key == expected)
+        expectedVelocity = n.velocity;
+    }
+    if (stack.getKey() != expected || stack.getVelocity() != expectedVelocity
+        || stack.getNumNotes() != (int)held.size() || !stack.contains(key) != (r == 0 || r >= 520)) {
+      if (numMismatches++ == 0)
+        fprintf(stderr, "%s note priority: event %ld gives key %d, expected %d\n", names[priority], i,
+                stack.getKey(), expected);
+    }
+  }
+  printf("%ld events with %s note priority, %ld mismatches\n", numEvents, names[priority],
+         numMismatches);
+  return numMismatches == 0;
+}
+
+int main(int argc, char **argv) {
+  long numEvents = argc > 1 ? atol(argv[1]) : 3000000;
+  if (argc > 2 || numEvents <= 0) {
+    fprintf(stderr, "usage: note_stack_test [numEvents]\n");
+    return 1;
+  }
+
+  bool ok = testAllocations(numEvents);
+  for (int p = 0; p < rosic::NoteStack::NUM_PRIORITIES; p++)
+    ok = testAgainstReference(numEvents / 10, p) && ok;
+  printf(ok ? "passed\n" : "FAILED\n");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#ifndef rosic_host_h
+#define rosic_host_h
+
+/*
+  Host build environment for the Open303 sources.
+
+  The sketch in ../Open303 is compiled by the Arduino builder, which concatenates the .ino files and
+  provides the Arduino API. This header does the same for the host tools in this directory: it
+  stands in for the few Arduino functions and types the sketch code uses and pulls in all rosic
+  sources as one translation unit, so a tool builds with a single compiler call, e.g.
+
+    g++ -O2 -std=gnu++17 -I../Open303 acid_render.cpp -o acid_render -pthread
+
+  When a rosic_*.ino file is added to the sketch, it has to be added to the list below.
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+// sketch configuration (see Open303.ino):
+#ifndef SAMPLE_RATE
+#define SAMPLE_RATE     44100
+#endif
+#ifndef DMA_BUF_LEN
+#define DMA_BUF_LEN     32
+#endif
+
+// Arduino API:
+#define PI 3.1415926535897932384626433832795
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define INPUT_PULLDOWN  3
+
+typedef uint8_t byte;
+typedef bool    boolean;
+
+// no debug output on the host, the tools report on their own:
+#define DEB(...)
+#define DEBF(...)
+#define DEBUG(...)
+
+/** The host has no pins - buttons read as released (they are pulled up). */
+inline void pinMode(int pin, int mode) {}
+inline int  digitalRead(int pin) { return HIGH; }
+inline void digitalWrite(int pin, int value) {}
+
+/** Time is defined by the rendered samples on the host, the wall clock is of no use to the sketch
+code (and would make renderings unrepeatable). */
+inline unsigned long millis() { return 0; }
+inline unsigned long micros() { return 0; }
+
+/** Arduino's random numbers, from a seedable generator such that renderings are repeatable. */
+static uint32_t hostRandomState = 1;
+inline void randomSeed(unsigned long seed) { hostRandomState = (uint32_t) seed; }
+inline long random(long howBig)
+{
+  if( howBig <= 0 )
+    return 0;
+  hostRandomState = 1664525*hostRandomState + 1013904223;
+  return (long) ((hostRandomState >> 8) % (uint32_t) howBig);
+}
+inline long random(long howSmall, long howBig)
+{
+  if( howSmall >= howBig )
+    return howSmall;
+  return howSmall + random(howBig - howSmall);
+}
+inline long random(int howSmall, int howBig) // exact match, rosic::random(float, float) is visible too
+{
+  return random((long) howSmall, (long) howBig);
+}
+
+/** Arduino's Preferences (the NVS) - the host has no persistent storage, nothing is found and
+nothing is stored. */
+class Preferences
+{
+public:
+  bool   begin(const char *name, bool readOnly = false) { return false; }
+  void   end() {}
+  size_t getBytesLength(const char *key) { return 0; }
+  size_t getBytes(const char *key, void *buf, size_t maxLen) { return 0; }
+  size_t putBytes(const char *key, const void *value, size_t len) { return 0; }
+};
+
+// the rosic sources:
+#include "GlobalFunctions.ino"
+#include "rosic_AcidPattern.ino"
+#include "rosic_AcidSequencer.ino"
+#include "rosic_AnalogEnvelope.ino"
+#include "rosic_AudioRecorder.ino"
+#include "rosic_BiquadCascade.ino"
+#include "rosic_BiquadFilter.ino"
+#include "rosic_BlendOscillator.ino"
+#include "rosic_ClockTracker.ino"
+#include "rosic_Complex.ino"
+#include "rosic_Compressor.ino"
+#include "rosic_DecayEnvelope.ino"
+#include "rosic_DrumSampler.ino"
+#include "rosic_DrumSynth.ino"
+#include "rosic_EllipticQuarterBandFilter.ino"
+#include "rosic_FourierTransformerRadix2.ino"
+#include "rosic_FunctionTemplates.ino"
+#include "rosic_LeakyIntegrator.ino"
+#include "rosic_MidiNoteEvent.ino"
+#include "rosic_MidiOutput.ino"
+#include "rosic_MidiParser.ino"
+#include "rosic_MipMappedWaveTable.ino"
+#include "rosic_NoteStack.ino"
+#include "rosic_NumberManipulations.ino"
+#include "rosic_OnePoleFilter.ino"
+#include "rosic_Open303.ino"
+#include "rosic_Open303Preset.ino"
+#include "rosic_PresetBank.ino"
+#include "rosic_PresetMorpher.ino"
+#include "rosic_RealFunctions.ino"
+#include "rosic_SampleBank.ino"
+#include "rosic_StereoPanner.ino"
+#include "rosic_TeeBeeFilter.ino"
+#include "rosic_TuningTable.ino"
+#include "rosic_Transport.ino"
+#include "rosic_WaveBank.ino"
+#include "rosic_WaveShaper.ino"
+
+#endif // rosic_host_h
@@ -0,0 +1,151 @@
+#ifndef wav_file_h
+#define wav_file_h
+
+/*
+  WAV input for the bank builders (drum_bank, wave_bank): reads PCM with 8, 16, 24 or 32 bit and
+  32 or 64 bit float (also as WAVE_FORMAT_EXTENSIBLE) into float frames, and collects the WAV files
+  of folders in the order of their names.
+*/
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/** The contents of a WAV file, the samples as float (-1...+1) with the channels interleaved. */
+struct WavData
+{
+  std::vector<float> samples;
+  int                numChannels = 0;
+  int                sampleRate  = 0;
+
+  int numFrames() const { return numChannels > 0 ? (int)(samples.size() / numChannels) : 0; }
+};
+
+static uint32_t wav_get_le(const uint8_t *p, int numBytes) {
+  uint32_t value = 0;
+  for (int i = 0; i < numBytes; i++)
+    value |= (uint32_t)p[i] << (8 * i);
+  return value;
+}
+
+/** Converts one sample of the data chunk to float. */
+static float wav_get_sample(const uint8_t *p, int format, int bits) {
+  if (format == 3) {
+    if (bits == 32) {
+      float f;
+      memcpy(&f, p, 4);
+      return f;
+    }
+    double d;
+    memcpy(&d, p, 8);
+    return (float)d;
+  }
+  switch (bits) {
+    case 8:  return ((int)p[0] - 128) * (1.0f / 128.0f); // 8 bit WAV is unsigned
+    case 16: return (int16_t)wav_get_le(p, 2) * (1.0f / 32768.0f);
+    case 24: return ((int32_t)(wav_get_le(p, 3) << 8) >> 8) * (1.0f / 8388608.0f);
+    default: return (int32_t)wav_get_le(p, 4) * (1.0f / 2147483648.0f);
+  }
+}
+
+/** Reads a WAV file, returns false (with a message) when it can't. */
+static bool read_wav(const char *path, WavData &wav) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    fprintf(stderr, "can't read %s\n", path);
+    return false;
+  }
+  std::vector<uint8_t> file;
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    file.insert(file.end(), buf, buf + n);
+  fclose(f);
+
+  const uint8_t *p = file.data();
+  size_t size = file.size();
+  if (size < 12 || memcmp(p, "RIFF", 4) != 0 || memcmp(p + 8, "WAVE", 4) != 0) {
+    fprintf(stderr, "%s is not a WAV file\n", path);
+    return false;
+  }
+  int format = 0, channels = 0, bits = 0, rate = 0;
+  const uint8_t *data = NULL;
+  uint32_t dataSize = 0;
+  for (size_t pos = 12; pos + 8 <= size; ) {
+    uint32_t chunkSize = wav_get_le(p + pos + 4, 4);
+    const uint8_t *chunk = p + pos + 8;
+    uint32_t available = (uint32_t)std::min<size_t>(chunkSize, size - pos - 8);
+    if (memcmp(p + pos, "fmt ", 4) == 0 && available >= 16) {
+      format   = wav_get_le(chunk, 2);
+      channels = wav_get_le(chunk + 2, 2);
+      rate     = wav_get_le(chunk + 4, 4);
+      bits     = wav_get_le(chunk + 14, 2);
+      if (format == 0xFFFE && available >= 26) // WAVE_FORMAT_EXTENSIBLE, the subformat follows
+        format = wav_get_le(chunk + 24, 2);
+    } else if (memcmp(p + pos, "data", 4) == 0) {
+      data     = chunk;
+      dataSize = available;                    // a truncated file keeps what it has
+    }
+    pos += 8 + (size_t)chunkSize + (chunkSize & 1);
+  }
+
+  bool pcm  = format == 1 && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+  bool ieee = format == 3 && (bits == 32 || bits == 64);
+  if (!(pcm || ieee) || channels < 1 || rate <= 0 || data == NULL) {
+    fprintf(stderr, "%s: unsupported format (%d, %d bit)\n", path, format, bits);
+    return false;
+  }
+  int sampleSize = bits / 8;
+  size_t numSamples = dataSize / (channels * sampleSize) * channels;
+  wav.samples.resize(numSamples);
+  for (size_t i = 0; i < numSamples; i++)
+    wav.samples[i] = wav_get_sample(data + i * sampleSize, format, bits);
+  wav.numChannels = channels;
+  wav.sampleRate  = rate;
+  return true;
+}
+
+static bool has_wav_extension(const std::string &name) {
+  if (name.size() < 4)
+    return false;
+  std::string ext = name.substr(name.size() - 4);
+  for (char &c : ext)
+    c = (char)tolower((unsigned char)c);
+  return ext == ".wav";
+}
+
+/** Adds the WAV files of a folder (not recursively) in the order of their names, or the path
+itself when it is not a folder. Returns false (with a message) for a folder without WAV files. */
+static bool add_wav_files(const char *path, std::vector<std::string> &files) {
+  DIR *dir = opendir(path);
+  if (dir == NULL) {
+    files.push_back(path);
+    return true;
+  }
+  std::vector<std::string> names;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] != '.' && has_wav_extension(entry->d_name))
+      names.push_back(entry->d_name);
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+  if (names.empty()) {
+    fprintf(stderr, "no WAV files in %s\n", path);
+    return false;
+  }
+  for (const std::string &name : names)
+    files.push_back(std::string(path) + "/" + name);
+  return true;
+}
+
+/** Appends a value in little endian to a byte buffer. */
+static void put_le(std::vector<uint8_t> &out, uint32_t value, int numBytes) {
+  for (int i = 0; i < numBytes; i++)
+    out.push_back((uint8_t)(value >> (8 * i)));
+}
+
+#endif // wav_file_h
@@ -0,0 +1,150 @@
+/*
+  wave_bank - builds a bank of user waveforms for the oscillator from single cycle WAV files
+
+  Each WAV file is one cycle of a waveform, of any length (like the 600 samples of the AKWF
+  collection). It is resampled to the wavetable length and band limited per octave exactly as
+  MipMappedWaveTable::setWaveform does it, and the resulting mip-map is stored in 16 bit with a
+  scale factor per waveform (see rosic_WaveBank.h). The sketch maps the bank from a data partition
+  and switches to a waveform by copying its mip-map - there is no FFT on the device.
+
+  Folders are scanned for *.wav files (not recursively), in the order of their names. Of a stereo
+  file, only the first channel is used. PCM with 8, 16, 24 or 32 bit and 32 or 64 bit float are
+  read.
+
+  Build:
+    g++ -O2 -std=gnu++17 -I../Open303 wave_bank.cpp -o wave_bank
+
+  Usage:
+    wave_bank -o waves.bin folder|file.wav...
+
+  The bank goes into a data partition labeled "waves" (see partitions.csv), e.g.:
+
+    wave_bank -o waves.bin AKWF/AKWF_bw_saw AKWF/AKWF_bw_square
+    esptool.py write_flash 0x3B0000 waves.bin
+*/
+
+#include <unistd.h>
+
+#include "rosic_host.h"
+#include "wav_file.h"
+
+using rosic::MipMappedWaveTable;
+using rosic::WaveBank;
+
+//-------------------------------------------------------------------------------------------------
+// input files:
+
+/** Reads one cycle from the first channel of a WAV file. */
+static bool read_cycle(const char *path, std::vector<float> &cycle) {
+  WavData wav;
+  if (!read_wav(path, wav))
+    return false;
+  if (wav.numFrames() < 2) {
+    fprintf(stderr, "%s: a cycle needs at least 2 samples\n", path);
+    return false;
+  }
+  cycle.resize(wav.numFrames());
+  for (int i = 0; i < wav.numFrames(); i++)
+    cycle[i] = wav.samples[i * wav.numChannels];
+  return true;
+}
+
+/** The name of a waveform: the file name without folder and extension, cut to fit the bank. */
+static std::string wave_name(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+  if (has_wav_extension(name))
+    name.resize(name.size() - 4);
+  if (name.size() > (size_t)WaveBank::nameLength - 1)
+    name.resize(WaveBank::nameLength - 1);
+  return name;
+}
+
+//-------------------------------------------------------------------------------------------------
+// bank output:
+
+static void print_usage() {
+  fprintf(stderr, "usage: wave_bank -o waves.bin folder|file.wav...\n");
+}
+
+int main(int argc, char **argv) {
+  const char *output = NULL;
+  int opt;
+  while ((opt = getopt(argc, argv, "o:h")) != -1) {
+    switch (opt) {
+      case 'o': output = optarg; break;
+      default:
+        print_usage();
+        return 1;
+    }
+  }
+  if (output == NULL || optind >= argc) {
+    print_usage();
+    return 1;
+  }
+
+  std::vector<std::string> files;
+  for (int i = optind; i < argc; i++) {
+    if (!add_wav_files(argv[i], files))
+      return 1;
+  }
+  if (files.size() > 65535) {
+    fprintf(stderr, "too many waveforms (%zu)\n", files.size());
+    return 1;
+  }
+
+  const int mipMapSize  = MipMappedWaveTable::getMipMapSize();
+  const int headerSize  = 16;
+  const int entrySize   = WaveBank::nameLength + 8;
+  uint32_t  dataOffset  = headerSize + entrySize * (uint32_t)files.size();
+
+  std::vector<uint8_t> header, entries, data;
+  header.insert(header.end(), {'O', '3', 'W', 'T'});
+  put_le(header, 1, 2);                                     // version
+  put_le(header, (uint32_t)files.size(), 2);
+  put_le(header, MipMappedWaveTable::getTableLength(), 2);
+  put_le(header, MipMappedWaveTable::getNumTables(), 2);
+  put_le(header, 0, 4);                                     // reserved
+
+  // the same wavetable object as on the device, the mip-map is read back from it:
+  static MipMappedWaveTable table;
+  std::vector<float> cycle, mipMap(mipMapSize);
+  for (const std::string &file : files) {
+    if (!read_cycle(file.c_str(), cycle))
+      return 1;
+    table.setWaveform(cycle.data(), (int)cycle.size());
+    table.getMipMap(mipMap.data());
+
+    float peak = 0.0f;
+    for (float v : mipMap)
+      peak = std::max(peak, fabsf(v));
+    float scale = peak > 0.0f ? peak / 32767.0f : 1.0f;
+    for (float v : mipMap)
+      put_le(data, (uint16_t)(int16_t)lrintf(v / scale), 2);
+
+    std::string name = wave_name(file);
+    char nameField[WaveBank::nameLength] = {0};
+    memcpy(nameField, name.data(), name.size());
+    entries.insert(entries.end(), nameField, nameField + WaveBank::nameLength);
+    uint32_t scaleBits;
+    memcpy(&scaleBits, &scale, 4);
+    put_le(entries, scaleBits, 4);
+    put_le(entries, dataOffset, 4);
+    dataOffset += mipMapSize * 2;
+
+    printf("%3zu  %-23s  %5zu samples, peak %.3f\n", entries.size() / entrySize - 1,
+           name.c_str(), cycle.size(), peak);
+  }
+
+  FILE *out = fopen(output, "wb");
+  if (out == NULL
+      || fwrite(header.data(), 1, header.size(), out) != header.size()
+      || fwrite(entries.data(), 1, entries.size(), out) != entries.size()
+      || fwrite(data.data(), 1, data.size(), out) != data.size()
+      || fclose(out) != 0) {
+    fprintf(stderr, "can't write %s\n", output);
+    return 1;
+  }
+  printf("%zu waveforms, %u bytes\n", files.size(), (unsigned)dataOffset);
+  return 0;
+}